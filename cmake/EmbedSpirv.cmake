@@ -0,0 +1,47 @@
+# Генерирует C++ файл с таблицей EMBEDDED_SHADERS (см. inc/EmbeddedShaders.h).
+# Вызывается из add_custom_command: cmake -DOUTPUT=<file.cpp> -DINPUTS=<a.spv,b.spv> -P EmbedSpirv.cmake
+# Код хранится как uint32_t, поэтому массивы выровнены по 4 байта без приведения типов.
+
+string(REPLACE "," ";" INPUTS "${INPUTS}")
+
+set(ARRAYS "")
+set(TABLE "")
+set(INDEX 0)
+
+foreach(INPUT ${INPUTS})
+    get_filename_component(NAME ${INPUT} NAME)
+    file(READ ${INPUT} HEX HEX)
+    string(LENGTH "${HEX}" HEX_LENGTH)
+    math(EXPR BYTES "${HEX_LENGTH} / 2")
+    math(EXPR REMAINDER "${BYTES} % 4")
+    if (BYTES EQUAL 0 OR NOT REMAINDER EQUAL 0)
+        message(FATAL_ERROR "${INPUT} is not a SPIR-V module (size ${BYTES})")
+    endif()
+
+    # SPIR-V - поток 32-битных little-endian слов: переставляем байты каждого слова
+    string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1u," WORDS "${HEX}")
+    # по 8 слов в строке, иначе строка растягивается на весь шейдер
+    # (регулярки CMake не знают {n}, поэтому шаблон из 8 слов собирается повтором)
+    string(REPEAT "0x[0-9a-f]+u," 8 EIGHT_WORDS)
+    string(REGEX REPLACE "(${EIGHT_WORDS})" "\\1\n    " WORDS "${WORDS}")
+
+    string(APPEND ARRAYS "alignas(4) const uint32_t SHADER_${INDEX}[] = {\n    ${WORDS}\n};\n\n")
+    string(APPEND TABLE "    {\"${NAME}\", SHADER_${INDEX}, ${BYTES}},\n")
+    math(EXPR INDEX "${INDEX} + 1")
+endforeach()
+
+if (INDEX EQUAL 0)
+    # массив нулевой длины в C++ недопустим
+    set(TABLE "    {nullptr, nullptr, 0},\n")
+endif()
+
+file(WRITE ${OUTPUT}
+    "// Сгенерировано cmake/EmbedSpirv.cmake, не редактировать\n\n"
+    "#include \"EmbeddedShaders.h\"\n\n"
+    "namespace {\n\n"
+    "${ARRAYS}"
+    "} // namespace\n\n"
+    "const EmbeddedShader EMBEDDED_SHADERS[] = {\n"
+    "${TABLE}"
+    "};\n\n"
+    "const size_t EMBEDDED_SHADER_COUNT = ${INDEX};\n")
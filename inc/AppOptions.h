@@ -0,0 +1,117 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_APPOPTIONS_H
+#define VULKAN_LEARN_APPOPTIONS_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "TransformSystem.h"
+#include "VertexFormat.h"
+
+// параметры запуска, разбираются из командной строки в main()
+struct AppOptions {
+    // рендер без окна и swap chain - в собственные VkImage (render node без дисплея, CI на lavapipe)
+    bool headless = false;
+
+    // сколько кадров отрисовать; 0 - пока не закроют окно (в headless режиме обязательно > 0)
+    uint32_t frameCount = 0;
+
+    // бенчмарк: прогрев, затем замер frameCount кадров или benchmarkSeconds секунд, отчет в JSON
+    bool benchmark = false;
+    uint32_t warmupFrames = 100;
+    double benchmarkSeconds = 0.0;      // 0 - ограничение по количеству кадров
+    std::string benchmarkOutput;        // пусто - в stdout
+
+    // GPU timestamps вокруг render pass и draw; pipelineStatistics добавляет счетчики вызовов шейдеров
+    bool gpuTiming = false;
+    bool pipelineStatistics = false;
+
+    // сколько объектов в списке отрисовки (нагрузка на запись командных буферов)
+    uint32_t objectCount = 1;
+
+    // все объекты одним vkCmdDrawIndexed: transform и цвет каждой копии из instance буфера (binding 1)
+    bool instanced = false;
+    // переписывать instance буфер каждый кадр (иначе он пишется только при изменении)
+    bool animateInstances = false;
+    // каждый кадр двигать N строк сетки (узлы-группы графа сцены): пересчитываются и копируются только их объекты
+    uint32_t animateRows = 0;
+    // время анимации стоит на нуле: сцена не вращается, статичные объекты не стоят кадру ни одной матрицы
+    bool staticScene = false;
+
+    // model матрица и индекс материала каждого draw через vkCmdPushConstants вместо dynamic offset в кольце uniform буферов
+    bool pushConstants = false;
+
+    // compute шейдер отсекает объекты по frustum и пишет indirect команды, CPU не трогает объекты вообще (включает instanced)
+    bool gpuDriven = false;
+
+    // запись draw списка в secondary command buffers на N потоках; 0 - как раньше, в одном потоке в primary
+    uint32_t recordThreads = 0;
+
+    // синхронизация кадров: timeline семафор (VK_KHR_timeline_semaphore) вместо fence на каждый кадр в полете
+    bool timelineSync = false;
+
+    // загрузки в выделенную transfer очередь, отсечение (--gpu-driven) в async compute очередь (включает timelineSync)
+    bool asyncQueues = false;
+
+    // окно меняет размер каждые пару кадров, отчет о худшем времени кадра при пересоздании swap chain
+    bool resizeStress = false;
+
+    // вместо рендера: замер recordCommandBuffer() на 1...N потоках (N = recordThreads или число ядер)
+    bool recordScaling = false;
+
+    // шаги инициализации по очереди в одном потоке, а не графом зависимостей на пуле (для сравнения времени запуска)
+    bool serialInit = false;
+    // время каждого шага инициализации в stderr
+    bool startupReport = false;
+
+    // меш в формате .vmesh (tools/meshconv); пусто - встроенный квадрат
+    std::string meshPath;
+
+    // раскладка вершинного буфера: float32, half или snorm16 (позиция) + RGBA8 цвет у сжатых
+    VertexFormat vertexFormat = VertexFormat::Float32;
+    // позиции и цвет в отдельных потоках (binding 0 и 1), а не чередуются в одном
+    bool splitVertexStreams = false;
+    // вместо рендера: размер, скорость кодирования и ошибка всех форматов вершин (только CPU)
+    bool vertexFormatReport = false;
+
+    // меш режется на кластеры до 64 вершин / 124 треугольников, невидимые кластеры (frustum и конус нормалей)
+    // не рисуются: на CPU перед записью команд или в compute отсечении (--gpu-driven)
+    bool meshlets = false;
+
+    // отсечение объектов по frustum на CPU: трансформы в SoA, матрицы и проверка сфер пакетами по 8 на всех ядрах;
+    // рисуются только видимые (не с instanced)
+    bool cpuCulling = false;
+    // ядро для --cpu-culling и бенчмарка; не задано - лучшее из поддерживаемых процессором
+    std::optional<TransformKernel> transformKernel;
+    // вместо рендера: скалярный путь glm против SSE/AVX2 на 10k, 100k и 1M объектов (только CPU)
+    bool transformBenchmark = false;
+
+    // напечатать скомпилированный граф кадра: порядок проходов, барьеры, память временных images
+    bool renderGraphDump = false;
+    // вместо рендера: граф кадра и пример с отложенным освещением и bloom - сколько памяти экономит наложение (JSON)
+    bool renderGraphReport = false;
+
+    // потоки фоновой компиляции графических pipeline; 0 - компиляция сразу при запросе, как раньше
+    uint32_t pipelineThreads = 2;
+
+    // файл VkPipelineCache между запусками; пусто - кэш не читается и не сохраняется
+    std::string pipelineCachePath = "pipeline_cache.bin";
+
+    // где лежат .spv; по умолчанию - папка, куда их складывает сборка (без glslc - как раньше, ../shaders)
+#ifdef VULKAN_LEARN_SHADER_DIR
+    std::string shaderDir = VULKAN_LEARN_SHADER_DIR;
+#else
+    std::string shaderDir = "../shaders";
+#endif
+
+    bool showHelp = false;
+};
+
+AppOptions parseAppOptions(int argc, char** argv);
+void printUsage(const char* programName);
+
+#endif //VULKAN_LEARN_APPOPTIONS_H
@@ -0,0 +1,37 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_DELETIONQUEUE_H
+#define VULKAN_LEARN_DELETIONQUEUE_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+// Отложенное удаление ресурсов, которые еще могут читать кадры в полете.
+// Ресурс ставится в очередь с номером последнего отправленного кадра и удаляется,
+// когда CPU дождался завершения этого кадра - без vkDeviceWaitIdle посреди рендера.
+class DeletionQueue {
+public:
+    // deleter вызовется, когда кадр frameNumber (и все до него) завершится на GPU
+    void push(uint64_t frameNumber, std::function<void()> deleter);
+
+    // удалить все, что ждало кадров <= completedFrame
+    void collect(uint64_t completedFrame);
+
+    // удалить все сразу: только когда устройство простаивает (cleanup)
+    void flush();
+
+    size_t pending() const { return entries.size(); }
+
+private:
+    struct Entry {
+        uint64_t frameNumber;
+        std::function<void()> deleter;
+    };
+
+    std::deque<Entry> entries; // номера кадров не убывают - удаляем с начала
+};
+
+#endif //VULKAN_LEARN_DELETIONQUEUE_H
@@ -0,0 +1,94 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_DEVICEALLOCATOR_H
+#define VULKAN_LEARN_DEVICEALLOCATOR_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "DeviceCaps.h"
+
+struct DeviceMemoryBlock;
+
+// Буферы и linear images против optimal images: на одной странице bufferImageGranularity их смешивать нельзя
+enum class ResourceKind : uint32_t {
+    Linear,
+    Optimal
+};
+
+// участок большого блока VkDeviceMemory, выданный под один ресурс
+struct DeviceAllocation {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    void* mapped = nullptr;              // для HOST_VISIBLE памяти блок отображен постоянно, здесь уже смещенный указатель
+    uint32_t memoryType = 0;
+    DeviceMemoryBlock* block = nullptr;
+};
+
+struct AllocatorStats {
+    VkDeviceSize bytesUsed = 0;      // сумма выданных участков
+    VkDeviceSize bytesReserved = 0;  // сумма блоков VkDeviceMemory
+    uint32_t allocationCount = 0;    // живых участков
+    uint32_t blockCount = 0;         // живых vkAllocateMemory
+    uint32_t maxMemoryAllocationCount = 0;
+};
+
+// Резервирует большие блоки на каждый тип памяти и раздает из них участки (best-fit по списку свободных
+// участков, соседние свободные сливаются при освобождении). Потокобезопасен.
+class DeviceAllocator {
+public:
+    static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+    // определены в .cpp: DeviceMemoryBlock там полный тип
+    DeviceAllocator();
+    ~DeviceAllocator();
+
+    void init(VkDevice device, const DeviceCaps& caps, VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE);
+    void destroy();
+
+    DeviceAllocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind);
+    void free(DeviceAllocation& allocation);
+
+    // для HOST_VISIBLE без HOST_COHERENT: сделать записи CPU видимыми GPU (для coherent памяти ничего не делает)
+    void flush(const DeviceAllocation& allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+    const VkPhysicalDeviceMemoryProperties& memoryProperties() const;
+
+    AllocatorStats stats() const;
+    void printStats(std::ostream& out) const;
+
+private:
+    struct Pool {
+        uint32_t key = 0;
+        uint32_t memoryType = 0;
+        std::vector<std::unique_ptr<DeviceMemoryBlock>> blocks;
+    };
+
+    Pool& poolFor(uint32_t memoryType, ResourceKind kind);
+    DeviceMemoryBlock* createBlock(Pool& pool, VkDeviceSize size);
+    void destroyBlock(DeviceMemoryBlock* block);
+    VkDeviceSize preferredBlockSize(uint32_t memoryType) const;
+
+    VkDevice device = VK_NULL_HANDLE;
+    VkPhysicalDeviceMemoryProperties memProperties{};
+    VkDeviceSize bufferImageGranularity = 1;
+    VkDeviceSize nonCoherentAtomSize = 1;
+    VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE;
+    uint32_t maxMemoryAllocationCount = 0;
+
+    // ключ - тип памяти * 2 + вид ресурса (если bufferImageGranularity > 1, иначе вид не различается)
+    std::map<uint32_t, Pool> pools;
+    AllocatorStats current;
+    mutable std::mutex mutex;
+};
+
+#endif //VULKAN_LEARN_DEVICEALLOCATOR_H
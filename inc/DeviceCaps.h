@@ -0,0 +1,27 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_DEVICECAPS_H
+#define VULKAN_LEARN_DEVICECAPS_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+// Снимок возможностей выбранного физического устройства: запрашивается один раз после
+// pickPhysicalDevice(), дальше свойства, лимиты, семейства очередей и расширения читаются отсюда.
+// Эти данные не меняются за время жизни процесса, повторные запросы к драйверу не нужны.
+struct DeviceCaps {
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkPhysicalDeviceProperties properties{};
+    VkPhysicalDeviceFeatures features{};
+    VkPhysicalDeviceMemoryProperties memoryProperties{};
+    std::vector<VkQueueFamilyProperties> queueFamilies;
+    std::vector<VkExtensionProperties> extensions;
+
+    static DeviceCaps query(VkPhysicalDevice physicalDevice);
+
+    bool hasExtension(const char* name) const;
+};
+
+#endif //VULKAN_LEARN_DEVICECAPS_H
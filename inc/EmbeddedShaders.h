@@ -0,0 +1,21 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_EMBEDDEDSHADERS_H
+#define VULKAN_LEARN_EMBEDDEDSHADERS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// SPIR-V, вшитый в бинарник при сборке с -DEMBED_SHADERS=ON (таблицу генерирует cmake/EmbedSpirv.cmake)
+struct EmbeddedShader {
+    const char* name;     // имя файла .spv, как его запрашивает ShaderLibrary
+    const uint32_t* code;
+    size_t size;          // в байтах
+};
+
+extern const EmbeddedShader EMBEDDED_SHADERS[];
+extern const size_t EMBEDDED_SHADER_COUNT;
+
+#endif //VULKAN_LEARN_EMBEDDEDSHADERS_H
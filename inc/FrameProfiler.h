@@ -0,0 +1,89 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_FRAMEPROFILER_H
+#define VULKAN_LEARN_FRAMEPROFILER_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "GpuProfiler.h"
+
+// фазы drawFrame(), время которых меряется отдельно
+enum class FramePhase : uint32_t {
+    FenceWait,
+    Acquire,
+    UpdateUniforms,
+    Record,
+    Submit,
+    Present,
+    Count
+};
+
+const char* framePhaseName(FramePhase phase);
+
+// сводка по набору замеров, все значения в миллисекундах
+struct TimingStats {
+    size_t count = 0;
+    double min = 0.0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+TimingStats computeTimingStats(std::vector<double> samples);
+void writeTimingStatsJson(std::ostream& out, const TimingStats& stats);
+std::string jsonEscape(const std::string& text);
+
+// CPU таймер кадра: drawFrame() отмечает начало/конец каждой фазы,
+// замеры копятся только пока включена запись (после прогрева)
+class FrameProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void setRecording(bool enabled);
+    bool isRecording() const;
+    void reset();
+
+    void beginFrame();
+    void endFrame();
+    void beginPhase(FramePhase phase);
+    void endPhase(FramePhase phase);
+
+    // результаты GPU запросов (GpuProfiler) копятся рядом с CPU замерами
+    void addGpuFrame(const GpuFrameStats& stats);
+
+    size_t recordedFrames() const;
+    TimingStats frameStats() const;
+    TimingStats phaseStats(FramePhase phase) const;
+
+    // поля "frameMs", "phasesMs" и, если были GPU замеры, "gpuMs"/"pipelineStatistics"
+    // для внешнего JSON объекта; фазы без замеров не выводятся
+    void writeJson(std::ostream& out) const;
+
+private:
+    static double elapsedMs(Clock::time_point from, Clock::time_point to);
+
+    bool recording = false;
+    Clock::time_point frameStart;
+    std::array<Clock::time_point, static_cast<size_t>(FramePhase::Count)> phaseStart{};
+
+    std::vector<double> frameSamples;
+    std::array<std::vector<double>, static_cast<size_t>(FramePhase::Count)> phaseSamples;
+
+    std::vector<double> gpuRenderPassSamples;
+    std::vector<double> gpuDrawSamples;
+    size_t statisticsFrames = 0;
+    uint64_t vertexShaderInvocations = 0;
+    uint64_t clippingPrimitives = 0;
+    uint64_t fragmentShaderInvocations = 0;
+};
+
+#endif //VULKAN_LEARN_FRAMEPROFILER_H
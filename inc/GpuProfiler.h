@@ -0,0 +1,78 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_GPUPROFILER_H
+#define VULKAN_LEARN_GPUPROFILER_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+#include "DeviceCaps.h"
+
+// результаты GPU запросов одного кадра
+struct GpuFrameStats {
+    bool valid = false;
+    double renderPassMs = 0.0;       // от начала до конца render pass
+    std::vector<double> drawMs;      // по одному значению на каждый отмеренный draw
+
+    bool hasPipelineStatistics = false;
+    uint64_t vertexShaderInvocations = 0;
+    uint64_t clippingPrimitives = 0;
+    uint64_t fragmentShaderInvocations = 0;
+
+    double totalDrawMs() const;
+};
+
+// Пул запросов на каждый кадр в полете: timestamps вокруг render pass и каждого draw,
+// опционально pipeline statistics. Результаты читаются без ожидания GPU -
+// после того как fence кадра сигнален (drawFrame() все равно его ждет), они уже готовы.
+class GpuProfiler {
+public:
+    static constexpr uint32_t MAX_TIMED_DRAWS = 32; // draw сверх лимита не отмечаются timestamp'ами
+
+    void init(VkDevice device, const DeviceCaps& caps, uint32_t queueFamilyIndex,
+              uint32_t framesInFlight, bool pipelineStatistics);
+    void destroy();
+
+    bool isEnabled() const;
+
+    // запись команд (frame - индекс кадра в полете)
+    void beginFrame(VkCommandBuffer commandBuffer, uint32_t frame);      // вне render pass
+    void beginRenderPass(VkCommandBuffer commandBuffer, uint32_t frame); // перед vkCmdBeginRenderPass
+    void endRenderPass(VkCommandBuffer commandBuffer, uint32_t frame);   // после vkCmdEndRenderPass
+    void beginDraw(VkCommandBuffer commandBuffer, uint32_t frame);
+    void endDraw(VkCommandBuffer commandBuffer, uint32_t frame);
+    void beginStatistics(VkCommandBuffer commandBuffer, uint32_t frame); // внутри subpass
+    void endStatistics(VkCommandBuffer commandBuffer, uint32_t frame);
+
+    // вызывать после ожидания fence кадра; false если данных нет (первые кадры) или они не готовы
+    bool collect(uint32_t frame);
+    const GpuFrameStats& lastStats() const;
+
+private:
+    struct FrameQueries {
+        VkQueryPool timestampPool = VK_NULL_HANDLE;
+        VkQueryPool statisticsPool = VK_NULL_HANDLE;
+        uint32_t timedDraws = 0;
+        uint32_t openDraw = 0;
+        bool written = false;
+    };
+
+    static constexpr uint32_t RENDER_PASS_BEGIN = 0;
+    static constexpr uint32_t RENDER_PASS_END = 1;
+    static constexpr uint32_t FIRST_DRAW_QUERY = 2;
+    static constexpr uint32_t TIMESTAMP_QUERY_COUNT = FIRST_DRAW_QUERY + 2 * MAX_TIMED_DRAWS;
+
+    double ticksToMs(uint64_t begin, uint64_t end) const;
+
+    VkDevice device = VK_NULL_HANDLE;
+    std::vector<FrameQueries> frames;
+    double timestampPeriodNs = 1.0;
+    uint64_t timestampMask = ~0ull;
+    bool statisticsEnabled = false;
+    GpuFrameStats stats;
+};
+
+#endif //VULKAN_LEARN_GPUPROFILER_H
@@ -0,0 +1,78 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_INITGRAPH_H
+#define VULKAN_LEARN_INITGRAPH_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ThreadPool.h"
+
+// Шаги инициализации с зависимостями.
+// Задача запускается, когда завершились все ее зависимости: рабочие задачи - на потоках пула,
+// задачи mainThread (окно, surface, swap chain) - в потоке, который вызвал run().
+// Время каждого шага (вместе с последовательными step() до графа) попадает в отчет.
+class InitGraph {
+public:
+    using TaskId = uint32_t;
+    using Clock = std::chrono::steady_clock;
+
+    InitGraph();
+
+    // выполняется сразу в текущем потоке: шаги, от которых зависит все остальное (instance, device)
+    void step(const std::string& name, const std::function<void()>& fn);
+
+    // зависимости - только уже добавленные задачи, поэтому порядок добавления - допустимый порядок выполнения
+    TaskId add(const std::string& name, std::function<void()> fn, const std::vector<TaskId>& dependencies = {}, bool mainThread = false);
+
+    // pool == nullptr - все задачи по очереди в текущем потоке (для сравнения с параллельным запуском).
+    // После первого исключения новые задачи не запускаются; оно пробрасывается, когда запущенные завершатся
+    void run(ThreadPool* pool);
+
+    double totalMs() const;
+    void printReport(std::ostream& out) const;
+    void writeJson(std::ostream& out) const;
+
+private:
+    struct Task {
+        std::string name;
+        std::function<void()> fn;
+        std::vector<TaskId> dependents;
+        uint32_t pendingDependencies = 0;
+        bool mainThread = false;
+        bool done = false;
+        std::thread::id thread;
+        double startMs = 0.0;
+        double durationMs = 0.0;
+    };
+
+    void execute(TaskId id, ThreadPool* pool);
+    void dispatch(TaskId id, ThreadPool* pool); // под mutex
+
+    double sinceStartMs(Clock::time_point time) const;
+    std::string threadName(std::thread::id thread) const;
+
+    std::vector<Task> tasks;
+    Clock::time_point startTime;
+    Clock::time_point endTime;
+    std::thread::id mainThreadId;
+    std::vector<std::thread::id> workerIds; // порядок первого появления - номер потока в отчете
+
+    std::mutex mutex;
+    std::condition_variable progress;
+    std::vector<TaskId> mainReady;
+    uint32_t workersRunning = 0;
+    std::exception_ptr error;
+};
+
+#endif //VULKAN_LEARN_INITGRAPH_H
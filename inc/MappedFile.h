@@ -0,0 +1,41 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_MAPPEDFILE_H
+#define VULKAN_LEARN_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// Файл, отображенный в память только для чтения (mmap / CreateFileMapping).
+// Данные не копируются, а начало отображения выровнено по странице - значит и по 4 байта, как требует SPIR-V.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const void* data() const { return mapping; }
+    size_t size() const { return fileSize; }
+
+    // подсказка ОС: файл читается один раз подряд - страницы подгружаются с опережением
+    void adviseSequential() const;
+
+private:
+    void close();
+
+    const void* mapping = nullptr;
+    size_t fileSize = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+#endif //VULKAN_LEARN_MAPPEDFILE_H
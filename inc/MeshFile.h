@@ -0,0 +1,61 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_MESHFILE_H
+#define VULKAN_LEARN_MESHFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "MappedFile.h"
+
+// Формат .vmesh: заголовок, затем вершины и индексы ровно в том виде, в каком их читает GPU.
+// Диапазоны выровнены по VMESH_ALIGNMENT, так что после mmap они копируются в staging как есть,
+// без разбора и преобразования каждой вершины. Пишется офлайн конвертером (tools/meshconv.cpp).
+const uint32_t VMESH_MAGIC = 0x48534D56; // "VMSH"
+const uint32_t VMESH_VERSION = 1;
+const uint64_t VMESH_ALIGNMENT = 256;
+
+// раскладка вершины в файле
+enum VMeshVertexFormat : uint32_t {
+    VMESH_VERTEX_POSITION_COLOR = 1, // float3 position, float3 color (= Vertex)
+};
+
+struct VMeshHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertexFormat;   // VMeshVertexFormat
+    uint32_t vertexStride;   // байт на вершину
+    uint32_t indexSize;      // 2 или 4 байта
+    uint32_t reserved;
+    uint64_t vertexCount;
+    uint64_t indexCount;
+    uint64_t vertexOffset;   // от начала файла
+    uint64_t indexOffset;
+    float boundsCenter[3];   // сфера вокруг всех вершин - для отсечения и кадрирования без прохода по вершинам
+    float boundsRadius;
+};
+
+// Открытый .vmesh: проверяется только заголовок и то, что диапазоны лежат внутри файла
+class MeshFile {
+public:
+    explicit MeshFile(const std::string& path);
+
+    const VMeshHeader& header() const { return *fileHeader; }
+
+    const void* vertexData() const;
+    uint64_t vertexBytes() const { return fileHeader->vertexCount * fileHeader->vertexStride; }
+    const void* indexData() const;
+    uint64_t indexBytes() const { return fileHeader->indexCount * fileHeader->indexSize; }
+
+private:
+    MappedFile file;
+    const VMeshHeader* fileHeader = nullptr;
+};
+
+// запись .vmesh (для конвертера): vertices - vertexCount * vertexStride байт, indices - indexCount * indexSize байт
+void writeMeshFile(const std::string& path, VMeshHeader header, const void* vertices, const void* indices);
+
+#endif //VULKAN_LEARN_MESHFILE_H
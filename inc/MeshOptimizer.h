@@ -0,0 +1,43 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_MESHOPTIMIZER_H
+#define VULKAN_LEARN_MESHOPTIMIZER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Подготовка индексного списка треугольников к отрисовке: порядок треугольников под кэш вершин после
+// трансформации, порядок вершин под выборку из памяти и ширина индексов. Запускается конвертером
+// (tools/meshconv), метрики до/после показывает tools/meshstat
+
+// кэш после вершинного шейдера моделируется как FIFO на cacheSize вершин - так себя ведет большинство GPU
+const uint32_t DEFAULT_VERTEX_CACHE_SIZE = 16;
+
+struct VertexCacheStats {
+    uint32_t cacheSize = 0;
+    size_t shaded = 0;   // вызовы вершинного шейдера (промахи кэша)
+    double acmr = 0.0;   // промахов на треугольник: 3 - худший случай, ~0.5 - предел для регулярной сетки
+    double atvr = 0.0;   // промахов на использованную вершину: 1.0 - каждая вершина шейдится ровно один раз
+};
+
+VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+                                    uint32_t cacheSize = DEFAULT_VERTEX_CACHE_SIZE);
+
+// Tipsify (Sander, Nehab, Barczak 2007): обход веером вокруг вершин, которые еще в кэше.
+// Линейное время, переставляет только треугольники - вершины и сами треугольники не меняются
+void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount,
+                         uint32_t cacheSize = DEFAULT_VERTEX_CACHE_SIZE);
+
+// Вершины в порядке первого появления в индексах: соседние вызовы шейдера читают соседнюю память.
+// Вершины, на которые нет ссылок, отбрасываются; возвращает новое число вершин
+size_t optimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexStride, uint32_t* indices, size_t indexCount);
+
+// 2 байта, если все индексы помещаются в uint16, иначе 4
+inline uint32_t chooseIndexSize(size_t vertexCount)
+{
+    return vertexCount <= 65536 ? 2 : 4;
+}
+
+#endif //VULKAN_LEARN_MESHOPTIMIZER_H
@@ -0,0 +1,67 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_MESHLET_H
+#define VULKAN_LEARN_MESHLET_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "VertexFormat.h"
+
+// Кластеры (meshlets): непрерывные куски индексного буфера, не больше 64 уникальных вершин и 124 треугольников.
+// Индексы не переставляются - конвертер уже упорядочил треугольники под кэш вершин, так что соседние
+// треугольники лежат рядом и в пространстве. Каждый кластер рисуется своим draw и отсекается целиком
+const uint32_t MESHLET_MAX_VERTICES = 64;
+const uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+// std430, совпадает с shaders/cull.comp
+struct Meshlet {
+    glm::vec4 boundingSphere; // центр и радиус в пространстве вершинного буфера
+    glm::vec4 cone;           // ось нормалей (xyz) и cos половины угла конуса (w); w <= 0 - отсечение по нормалям невозможно
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t vertexCount;     // уникальных вершин
+    uint32_t pad;
+};
+
+// indexSize - 2 или 4 байта на индекс (как в .vmesh и VkIndexType). Индекс >= vertexCount - std::runtime_error
+std::vector<Meshlet> buildMeshlets(const void* indices, uint32_t indexSize, size_t indexCount,
+                                   const Vertex* vertices, size_t vertexCount);
+
+// непрерывный диапазон индексов, который рисуется одним vkCmdDrawIndexed
+struct MeshletDraw {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+};
+
+// Отсечение кластеров на CPU: границы в раскладке SoA, по 4 кластера за проход на SSE2.
+// Плоскости frustum и камера задаются в пространстве меша (через матрицу модели объекта),
+// тогда кластеры не нужно трансформировать. Кластер отбрасывается, если его сфера целиком вне frustum
+// или все его треугольники смотрят от камеры (конус нормалей)
+class MeshletCuller {
+public:
+    void init(const std::vector<Meshlet>& meshlets);
+
+    // Видимые кластеры дописываются в out; соседние видимые кластеры сливаются в один draw.
+    // Возвращает количество видимых кластеров
+    size_t cull(const glm::vec4 planes[6], const glm::vec3& camera, std::vector<MeshletDraw>& out, bool allowSimd = true) const;
+
+    size_t size() const { return firstIndex.size(); }
+
+private:
+    // видимость кластеров [begin, end) в visible[0 .. end - begin); begin кратен 4
+    void cullScalar(const glm::vec4 planes[6], const glm::vec3& camera, size_t begin, size_t end, uint8_t* visible) const;
+    void cullSse2(const glm::vec4 planes[6], const glm::vec3& camera, size_t begin, size_t end, uint8_t* visible) const;
+
+    // SoA массивы дополнены нулями до кратного 4, чтобы SIMD читал целые группы; результат хвоста не используется
+    std::vector<float> centerX, centerY, centerZ, radius;
+    std::vector<float> axisX, axisY, axisZ, coneCos, coneSin;
+    std::vector<uint32_t> firstIndex;
+    std::vector<uint32_t> indexCount;
+};
+
+#endif //VULKAN_LEARN_MESHLET_H
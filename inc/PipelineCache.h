@@ -0,0 +1,62 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_PIPELINECACHE_H
+#define VULKAN_LEARN_PIPELINECACHE_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "DeviceCaps.h"
+
+struct PipelineCacheStats {
+    size_t loadedBytes = 0;    // 0 - кэша на диске не было или он отброшен
+    std::string rejectReason;  // почему файл не подошел (другой GPU/драйвер, поврежден)
+    uint32_t pipelines = 0;
+    uint32_t hits = 0;         // известны только при VK_EXT_pipeline_creation_feedback
+    uint32_t misses = 0;
+    double compileMs = 0.0;    // время внутри vkCreate*Pipelines
+};
+
+// VkPipelineCache, который переживает перезапуск: читается с диска в init(), пишется в save().
+// Данные драйвера используются только если заголовок совпадает с текущим устройством
+// (vendorID, deviceID, pipelineCacheUUID), а файл целиком проходит проверку контрольной суммы.
+// create*Pipeline можно вызывать из нескольких потоков: VkPipelineCache синхронизирован драйвером, счетчики - mutex
+class PipelineCache {
+public:
+    // path пустой - кэш только в памяти, на диск не пишется
+    void init(VkDevice device, const DeviceCaps& caps, const std::string& path, bool creationFeedback);
+    void destroy();
+
+    // запись во временный файл и rename поверх старого: после падения остается либо старый, либо новый кэш
+    void save();
+
+    VkPipelineCache handle() const { return cache; }
+
+    // vkCreateGraphicsPipelines через кэш с замером времени и feedback о попадании
+    VkResult createGraphicsPipeline(const VkGraphicsPipelineCreateInfo& createInfo, VkPipeline& pipeline);
+    VkResult createComputePipeline(const VkComputePipelineCreateInfo& createInfo, VkPipeline& pipeline);
+
+    PipelineCacheStats stats() const;
+    void printStats(std::ostream& out) const;
+
+private:
+    template <typename CreateInfo, typename CreateFunction>
+    VkResult createPipeline(const CreateInfo& createInfo, VkPipeline& pipeline, CreateFunction create);
+    bool validate(const std::vector<char>& file, size_t& dataOffset, size_t& dataSize);
+
+    VkDevice device = VK_NULL_HANDLE;
+    VkPhysicalDeviceProperties deviceProperties{};
+    VkPipelineCache cache = VK_NULL_HANDLE;
+    std::string path;
+    bool creationFeedback = false;
+    PipelineCacheStats counters;
+    mutable std::mutex mutex; // только counters: компиляции идут параллельно
+};
+
+#endif //VULKAN_LEARN_PIPELINECACHE_H
@@ -0,0 +1,106 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_PIPELINECOMPILER_H
+#define VULKAN_LEARN_PIPELINECOMPILER_H
+
+#include <vulkan/vulkan.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "PipelineCache.h"
+#include "ThreadPool.h"
+
+using PipelineHandle = uint32_t;
+const PipelineHandle INVALID_PIPELINE_HANDLE = ~0u;
+
+enum class PipelineStatus {
+    Pending,
+    Ready,
+    Failed
+};
+
+// Копия состояния VkGraphicsPipelineCreateInfo со всеми массивами, на которые он ссылается:
+// задача компиляции выполняется позже, когда структуры вызывающего уже не существуют.
+// pNext и specialization constants не поддерживаются (в этом проекте их нет)
+struct GraphicsPipelineDesc {
+    explicit GraphicsPipelineDesc(const VkGraphicsPipelineCreateInfo& createInfo);
+
+    // create info, указывающий на данные этой копии; живет, пока жива копия
+    VkGraphicsPipelineCreateInfo createInfo();
+
+    std::vector<VkPipelineShaderStageCreateInfo> stages; // pName - строковые литералы, модули живут в ShaderLibrary
+    VkPipelineVertexInputStateCreateInfo vertexInput{};
+    std::vector<VkVertexInputBindingDescription> vertexBindings;
+    std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    VkPipelineViewportStateCreateInfo viewportState{};
+    std::vector<VkViewport> viewports;
+    std::vector<VkRect2D> scissors;
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    bool hasDepthStencil = false;
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    std::vector<VkDynamicState> dynamicStates;
+    VkGraphicsPipelineCreateInfo info{};
+};
+
+// Компиляция pipeline в фоне: compileGraphics() сразу возвращает handle, сам VkPipeline
+// появляется, когда его соберет поток пула. Все потоки пишут в один PipelineCache.
+// Кадр спрашивает get() и, пока pipeline не готов, рисует запасным или пропускает draw - не ждет.
+class PipelineCompiler {
+public:
+    // threadCount == 0 - компиляция прямо в compileGraphics(), как без компилятора
+    void init(VkDevice device, PipelineCache& cache, uint32_t threadCount);
+    // дожидается запущенных компиляций и удаляет все pipeline
+    void destroy();
+
+    PipelineHandle compileGraphics(const std::string& name, const VkGraphicsPipelineCreateInfo& createInfo);
+
+    PipelineStatus status(PipelineHandle handle) const;
+    // VK_NULL_HANDLE, пока pipeline компилируется; ошибка компиляции - исключение
+    VkPipeline get(PipelineHandle handle) const;
+    // блокирует: только там, где ожидание допустимо (перед замером бенчмарка)
+    VkPipeline wait(PipelineHandle handle);
+    void waitAll();
+
+    uint32_t pendingCount() const;
+    void printStats(std::ostream& out) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::string name;
+        std::unique_ptr<GraphicsPipelineDesc> desc; // освобождается после компиляции
+        PipelineStatus status = PipelineStatus::Pending;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkResult result = VK_SUCCESS;
+        Clock::time_point requested;
+        double readyMs = 0.0; // от запроса до готовности, вместе с ожиданием в очереди пула
+    };
+
+    void compile(PipelineHandle handle);
+
+    VkDevice device = VK_NULL_HANDLE;
+    PipelineCache* cache = nullptr;
+    std::unique_ptr<ThreadPool> pool;
+
+    std::deque<Entry> entries; // индекс - handle
+    mutable std::mutex mutex;
+    std::condition_variable compiled;
+    uint32_t pending = 0;
+};
+
+#endif //VULKAN_LEARN_PIPELINECOMPILER_H
@@ -0,0 +1,75 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_QUEUESCHEDULER_H
+#define VULKAN_LEARN_QUEUESCHEDULER_H
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "TimelineSemaphore.h"
+
+// на какой очереди выполняется работа
+enum class QueueKind {
+    Graphics,
+    Compute,  // async compute: семейство с COMPUTE, но без GRAPHICS
+    Transfer, // семейство только с TRANSFER (DMA движок)
+    Count
+};
+
+// ждать значения timeline другой очереди на указанных стадиях
+struct QueueWait {
+    QueueKind queue;
+    uint64_t value;
+    VkPipelineStageFlags stages;
+};
+
+struct QueueSubmit {
+    std::vector<VkCommandBuffer> commandBuffers;
+    std::vector<QueueWait> timelineWaits;            // значения 0 пропускаются
+    std::vector<VkSemaphore> waitSemaphores;         // binary (acquire swap chain)
+    std::vector<VkPipelineStageFlags> waitStages;
+    std::vector<VkSemaphore> signalSemaphores;       // binary (present)
+};
+
+// Раздает работу по очередям: загрузки - в transfer, отсечение - в async compute, отрисовку - в graphics.
+// У каждой очереди свой timeline семафор: значения одного семафора должны расти в порядке исполнения,
+// а очереди исполняются независимо. Если выделенного семейства нет, вид работы делит очередь
+// (и ее timeline) с graphics - остальной код об этом не знает.
+class QueueScheduler {
+public:
+    void init(VkDevice device, uint32_t graphicsFamily, std::optional<uint32_t> computeFamily,
+              std::optional<uint32_t> transferFamily);
+    void destroy();
+
+    // отправить батч; возвращает значение timeline очереди, которое он сигналит
+    uint64_t submit(QueueKind kind, const QueueSubmit& batch);
+
+    VkQueue queue(QueueKind kind) const { return lanes[lane(kind)].queue; }
+    uint32_t family(QueueKind kind) const { return lanes[lane(kind)].family; }
+    TimelineSemaphore& timeline(QueueKind kind) { return lanes[lane(kind)].timeline; }
+
+    // у вида работы своя очередь из другого семейства (нужна передача владения exclusive ресурсами)
+    bool isDedicated(QueueKind kind) const { return lane(kind) != static_cast<size_t>(QueueKind::Graphics); }
+
+    // семейства, между которыми делятся VK_SHARING_MODE_CONCURRENT буферы
+    std::vector<uint32_t> uniqueFamilies() const;
+
+private:
+    struct Lane {
+        VkQueue queue = VK_NULL_HANDLE;
+        uint32_t family = 0;
+        TimelineSemaphore timeline;
+        bool active = false;
+    };
+
+    size_t lane(QueueKind kind) const;
+
+    std::array<Lane, static_cast<size_t>(QueueKind::Count)> lanes;
+};
+
+#endif //VULKAN_LEARN_QUEUESCHEDULER_H
@@ -0,0 +1,240 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_RENDERGRAPH_H
+#define VULKAN_LEARN_RENDERGRAPH_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "DeviceAllocator.h"
+
+// Граф кадра. Проходы объявляют, какие ресурсы читают и пишут; compile() по этим объявлениям
+// выбирает порядок проходов, выбрасывает проходы, результат которых никто не читает, расставляет
+// барьеры (все барьеры перед проходом - один vkCmdPipelineBarrier) и раздает память временным images:
+// images, времена жизни которых не пересекаются, лежат в одной и той же памяти.
+//
+// Каждая запись создает новую версию ресурса и возвращает ее. Чтение версии - зависимость от прохода,
+// который ее записал; запись - зависимость от всех, кто читал прошлую версию. Поэтому порядок добавления
+// проходов не важен, важны только версии, которые они передают друг другу.
+//
+// Импортированные ресурсы (swap chain image, буферы кадра) граф не создает: их VkImage/VkBuffer
+// привязываются перед execute(), а состояние на входе и выходе кадра задается при импорте.
+// Их последние версии - результат кадра, проходы, от которых они зависят, не выбрасываются.
+class RenderGraph {
+public:
+    using PassId = uint32_t;
+    using ResourceId = uint32_t; // версия ресурса
+
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    enum class PassKind {
+        Raster,  // сам открывает render pass через beginRenderPass()
+        Compute
+    };
+
+    struct ImageDesc {
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkExtent2D extent{0, 0};
+    };
+
+    // layout, стадии и доступ, которыми ресурс последний раз использовали до кадра (или будут использовать после)
+    struct ResourceState {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags stages = 0;
+        VkAccessFlags access = 0;
+    };
+
+    struct Stats {
+        uint32_t passes = 0;          // выполняются
+        uint32_t culledPasses = 0;
+        uint32_t barrierBatches = 0;  // vkCmdPipelineBarrier за кадр
+        uint32_t barriers = 0;        // image/buffer барьеров в них
+        uint32_t transientImages = 0;
+        uint32_t heaps = 0;           // участков памяти под временные images
+        VkDeviceSize transientBytes = 0; // сколько заняли бы images каждый в своей памяти
+        VkDeviceSize aliasedBytes = 0;   // сколько заняли с наложением
+    };
+
+    explicit RenderGraph(std::string name) : name(std::move(name)) {}
+
+    ResourceId createImage(const std::string& name, const ImageDesc& desc);
+    ResourceId importImage(const std::string& name, const ImageDesc& desc, const ResourceState& initial, const ResourceState& final);
+    ResourceId importBuffer(const std::string& name, const ResourceState& initial);
+
+    PassId addPass(const std::string& name, PassKind kind, std::function<void(VkCommandBuffer)> execute);
+    // проход нужен сам по себе (пишет туда, чего граф не видит) - не выбрасывается
+    void keepAlive(PassId pass);
+
+    // attachments raster прохода, в порядке объявления. LOAD читает прошлую версию, CLEAR/DONT_CARE - нет
+    ResourceId colorAttachment(PassId pass, ResourceId image, VkAttachmentLoadOp load, VkClearColorValue clear = {});
+    ResourceId depthAttachment(PassId pass, ResourceId image, VkAttachmentLoadOp load, float clearDepth = 1.0f);
+    void sampleImage(PassId pass, ResourceId image, VkPipelineStageFlags stages);
+    ResourceId storageImage(PassId pass, ResourceId image, VkPipelineStageFlags stages);
+    void readBuffer(PassId pass, ResourceId buffer, VkPipelineStageFlags stages, VkAccessFlags access);
+    ResourceId writeBuffer(PassId pass, ResourceId buffer, VkPipelineStageFlags stages, VkAccessFlags access);
+
+    // порядок, отсечение, временные images и их память, барьеры, VkRenderPass на каждый raster проход
+    void compile(VkDevice device, DeviceAllocator& allocator);
+    void destroy();
+
+    // Каждый кадр: привязать импортированные ресурсы (любой их версией), затем execute() - барьеры и проходы по порядку
+    void bindImage(ResourceId image, VkImage handle, VkImageView view, VkExtent2D extent);
+    void bindBuffer(ResourceId buffer, VkBuffer handle);
+    void execute(VkCommandBuffer commandBuffer);
+
+    // для raster прохода, внутри его execute. Framebuffer под текущие привязки создается при первом обращении
+    void beginRenderPass(VkCommandBuffer commandBuffer, PassId pass, VkSubpassContents contents);
+    void endRenderPass(VkCommandBuffer commandBuffer);
+    VkRenderPass renderPass(PassId pass) const { return passes[pass].renderPass; }
+    VkFramebuffer framebuffer(PassId pass);
+
+    // framebuffers под старые привязки (пересоздание swap chain): вызывающий удалит их, когда кадры в полете завершатся
+    std::vector<VkFramebuffer> releaseFramebuffers();
+
+    Stats stats() const;
+    void dump(std::ostream& out) const;
+    void writeJson(std::ostream& out) const;
+
+private:
+    struct Resource {
+        std::string name;
+        bool image = true;
+        bool imported = false;
+        ImageDesc desc;
+        ResourceState initial;
+        ResourceState final;
+        ResourceId latest = NONE;
+        VkImageUsageFlags usage = 0;
+
+        VkImage handle = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+
+        // временные: позиции первого и последнего прохода в порядке выполнения, участок памяти
+        uint32_t firstUse = NONE;
+        uint32_t lastUse = 0;
+        VkMemoryRequirements requirements{};
+        uint32_t heap = NONE;
+        uint32_t aliasPrevious = NONE; // кто занимал ту же память до него (у первого в участке - последний, из прошлого кадра)
+    };
+
+    struct Version {
+        uint32_t resource = 0;
+        uint32_t number = 0;
+        PassId producer = NONE;
+        std::vector<PassId> readers;
+    };
+
+    struct Access {
+        ResourceId input = NONE;   // читаемая или перезаписываемая версия
+        ResourceId output = NONE;  // новая версия, если проход пишет
+        VkPipelineStageFlags stages = 0;
+        VkAccessFlags access = 0;
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        bool reads = false;
+    };
+
+    struct Attachment {
+        uint32_t resource = 0;
+        ResourceId output = NONE;
+        VkAttachmentLoadOp load = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        VkClearValue clear{};
+        bool depth = false;
+    };
+
+    struct Barrier {
+        uint32_t resource = 0;
+        VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkImageLayout newLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkAccessFlags srcAccess = 0;
+        VkAccessFlags dstAccess = 0;
+    };
+
+    // все барьеры перед проходом; memory* - глобальный барьер при смене хозяина памяти (aliasing).
+    // Только стадии без барьеров - зависимость по исполнению (запись после чтения)
+    struct BarrierBatch {
+        VkPipelineStageFlags srcStages = 0;
+        VkPipelineStageFlags dstStages = 0;
+        VkAccessFlags memorySrcAccess = 0;
+        VkAccessFlags memoryDstAccess = 0;
+        bool memoryBarrier = false;
+        std::vector<Barrier> barriers;
+
+        bool empty() const { return srcStages == 0; }
+    };
+
+    struct Pass {
+        std::string name;
+        PassKind kind = PassKind::Compute;
+        std::function<void(VkCommandBuffer)> execute;
+        std::vector<Access> accesses;
+        std::vector<Attachment> attachments;
+        bool keepAlive = false;
+        bool culled = false;
+        BarrierBatch barriers;
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        std::map<std::vector<VkImageView>, VkFramebuffer> framebuffers;
+    };
+
+    // участок памяти, общий для временных images с непересекающимися временами жизни
+    struct Heap {
+        DeviceAllocation memory;
+        VkMemoryRequirements requirements{};
+        std::vector<uint32_t> resources; // в порядке времени жизни
+    };
+
+    // состояние ресурса при обходе проходов в compile()
+    struct TrackedState {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags writeStages = 0;
+        VkAccessFlags writeAccess = 0;
+        VkPipelineStageFlags readStages = 0;
+        VkAccessFlags readAccess = 0;
+    };
+
+    ResourceId addResource(Resource resource);
+    ResourceId newVersion(uint32_t resource, PassId producer);
+    void read(PassId pass, ResourceId version, const Access& access);
+    ResourceId write(PassId pass, ResourceId version, Access access);
+
+    void cullPasses();
+    void sortPasses();
+    void computeLifetimes();
+    void createTransientImages();
+    void aliasMemory();
+    void buildBarriers();
+    void addBarrier(BarrierBatch& batch, uint32_t resource, TrackedState& state, const Access& access,
+                    const std::vector<TrackedState>& states, const std::vector<TrackedState>& previousFrame) const;
+    void createRenderPasses();
+    void recordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch);
+    VkFramebuffer currentFramebuffer(Pass& pass, VkExtent2D& extent);
+
+    void dumpBatch(std::ostream& out, const BarrierBatch& batch) const;
+
+    std::string name;
+    std::vector<Resource> resources;
+    std::vector<Version> versions;
+    std::vector<Pass> passes;
+    std::vector<PassId> order; // выполняемые проходы по порядку
+    std::vector<Heap> heaps;
+    BarrierBatch finalBarriers; // после последнего прохода: импортированные images в состояние на выходе из кадра
+
+    VkDevice device = VK_NULL_HANDLE;
+    DeviceAllocator* allocator = nullptr;
+
+    // переиспользуются каждый кадр, чтобы execute() не выделял память
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+    std::vector<VkBufferMemoryBarrier> bufferBarriers;
+    std::vector<VkImageView> attachmentViews;
+    std::vector<VkClearValue> clearValues;
+};
+
+#endif //VULKAN_LEARN_RENDERGRAPH_H
@@ -0,0 +1,54 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_SCENEGRAPH_H
+#define VULKAN_LEARN_SCENEGRAPH_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const uint32_t SCENE_NO_PARENT = UINT32_MAX;
+
+// Иерархия узлов в плоских массивах: у каждого узла номер родителя, local и world матрицы.
+// Родитель всегда добавляется раньше детей (массив отсортирован топологически), поэтому world
+// пересчитывается одним проходом вперед. setLocal() только помечает узел, update() пересчитывает
+// помеченные узлы и их поддеревья - если ничего не менялось, update() ничего не делает.
+// Если узлы добавлялись в прямом порядке обхода (потомки узла идут сразу за ним), поддерево - непрерывный
+// диапазон и обходятся только измененные диапазоны; иначе проход идет от первого помеченного узла до конца
+class SceneGraph {
+public:
+    uint32_t addNode(uint32_t parent, const glm::mat4& local);
+    void setLocal(uint32_t node, const glm::mat4& local);
+
+    size_t size() const { return parents.size(); }
+    uint32_t parent(uint32_t node) const { return parents[node]; }
+    const glm::mat4& local(uint32_t node) const { return locals[node]; }
+    const glm::mat4& world(uint32_t node) const { return worlds[node]; }
+
+    // пересчитать world помеченных узлов и всех их потомков; возвращает число пересчитанных узлов
+    size_t update();
+
+    // узлы, у которых world изменился в последнем update(), по возрастанию
+    const std::vector<uint32_t>& changedNodes() const { return changed; }
+
+    bool isPreorder() const { return preorder; }
+
+private:
+    void updateRanges();
+    void updateScan();
+
+    std::vector<uint32_t> parents;
+    std::vector<glm::mat4> locals;
+    std::vector<glm::mat4> worlds;
+    std::vector<uint32_t> subtreeEnd;  // за последним потомком; верно, пока preorder
+    std::vector<uint8_t> dirty;        // local изменен после последнего update()
+    std::vector<uint32_t> dirtyNodes;
+    std::vector<uint8_t> changedFlags; // только для прохода без preorder
+    std::vector<uint32_t> changed;
+    bool preorder = true;
+};
+
+#endif //VULKAN_LEARN_SCENEGRAPH_H
@@ -0,0 +1,47 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_SHADERLIBRARY_H
+#define VULKAN_LEARN_SHADERLIBRARY_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+struct ShaderLibraryStats {
+    uint32_t filesMapped = 0;
+    uint32_t embeddedUsed = 0;
+    uint32_t modulesCreated = 0;
+    uint32_t cacheHits = 0;   // запрос вернул уже созданный модуль (по имени или по одинаковому содержимому)
+};
+
+// Загрузка SPIR-V и кэш VkShaderModule.
+// Код берется из вшитой таблицы (если собрано с EMBED_SHADERS) или отображается из файла без копирования.
+// Модули живут до destroy() и ищутся по хэшу содержимого, так что одинаковый код не создается дважды -
+// ни для разных pipeline, ни при пересоздании swap chain.
+class ShaderLibrary {
+public:
+    void init(VkDevice device, const std::string& shaderDir);
+    void destroy();
+
+    // name - имя файла .spv внутри shaderDir (или во вшитой таблице)
+    VkShaderModule getModule(const std::string& name);
+
+    const ShaderLibraryStats& stats() const { return counters; }
+    void printStats(std::ostream& out) const;
+
+private:
+    VkShaderModule createModule(const std::string& name, const uint32_t* code, size_t size);
+
+    VkDevice device = VK_NULL_HANDLE;
+    std::string shaderDir;
+
+    std::unordered_map<std::string, VkShaderModule> modulesByName;
+    std::unordered_map<uint64_t, VkShaderModule> modulesByHash; // FNV-1a от кода (вместе с размером)
+    ShaderLibraryStats counters;
+};
+
+#endif //VULKAN_LEARN_SHADERLIBRARY_H
@@ -0,0 +1,46 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_THREADPOOL_H
+#define VULKAN_LEARN_THREADPOOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Фиксированный набор рабочих потоков с общей очередью задач.
+// Потоки создаются один раз: на каждом кадре только раздаются задачи, без создания std::thread.
+class ThreadPool {
+public:
+    explicit ThreadPool(uint32_t threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    uint32_t size() const { return static_cast<uint32_t>(workers.size()); }
+
+    // исключение задачи попадает в future
+    std::future<void> submit(std::function<void()> task);
+
+    // body(0) ... body(count - 1) на потоках пула; возвращается после завершения всех,
+    // первое исключение пробрасывается вызывающему
+    void parallelFor(uint32_t count, const std::function<void(uint32_t)>& body);
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::queue<std::packaged_task<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    bool stopping = false;
+};
+
+#endif //VULKAN_LEARN_THREADPOOL_H
@@ -0,0 +1,44 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_TIMELINESEMAPHORE_H
+#define VULKAN_LEARN_TIMELINESEMAPHORE_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+// Один монотонно растущий счетчик прогресса GPU (VK_KHR_timeline_semaphore, в ядре с Vulkan 1.2).
+// Каждый submit сигналит следующее значение; дождаться можно точного значения, а узнать прогресс - без ожидания.
+// Заменяет пачку fence: кадр в полете и батч загрузки помнят только свое значение.
+class TimelineSemaphore {
+public:
+    // устройство должно быть создано с расширением и включенной фичей timelineSemaphore
+    void init(VkDevice device);
+    void destroy();
+
+    // значение для следующего submit; сигналить его обязан именно этот submit
+    uint64_t next() { return ++lastValue; }
+    uint64_t lastSubmitted() const { return lastValue; }
+
+    // до какого значения GPU дошел, без блокировки
+    uint64_t completedValue();
+    bool isComplete(uint64_t value) { return value <= completedValue(); }
+
+    // блокирует CPU, пока счетчик не дойдет до value; false - истек timeout (наносекунды)
+    bool wait(uint64_t value, uint64_t timeout = UINT64_MAX);
+
+    VkSemaphore handle() const { return semaphore; }
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    uint64_t lastValue = 0;
+    uint64_t completed = 0; // последнее прочитанное значение: без вызова драйвера для уже завершенного
+
+    // функции расширения: с apiVersion 1.0 загрузчик их не экспортирует
+    PFN_vkWaitSemaphoresKHR waitSemaphores = nullptr;
+    PFN_vkGetSemaphoreCounterValueKHR getSemaphoreCounterValue = nullptr;
+};
+
+#endif //VULKAN_LEARN_TIMELINESEMAPHORE_H
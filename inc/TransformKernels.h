@@ -0,0 +1,46 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_TRANSFORMKERNELS_H
+#define VULKAN_LEARN_TRANSFORMKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Ядра TransformSystem: мировые матрицы объектов и отсечение их сфер по frustum.
+// Интерфейс - только float и указатели: TransformSystemAvx2.cpp собирается с -mavx2 и не подключает glm и STL,
+// иначе их inline функции с AVX2 кодом линковщик мог бы выбрать для всей программы
+
+// пакет - 8 объектов: регистр AVX2, SSE обрабатывает пакет за два прохода. Массивы SoA дополнены до кратного
+const size_t TRANSFORM_BATCH = 8;
+
+struct TransformView {
+    // SoA, по одному элементу на объект: позиция, вращение (единичный кватернион) и масштаб
+    const float* positionX;
+    const float* positionY;
+    const float* positionZ;
+    const float* rotationX;
+    const float* rotationY;
+    const float* rotationZ;
+    const float* rotationW;
+    const float* scale;
+
+    // общие для всех объектов, column-major: world = parent * TRS * local
+    float parent[16];
+    float local[16];
+    float bounds[4];     // сфера в пространстве local
+    float radiusScale;   // во сколько parent и local растягивают радиус (наибольшая длина столбца)
+    float planes[6][4];  // мировое пространство, нормали смотрят внутрь
+};
+
+// Объекты [begin, end), begin кратен TRANSFORM_BATCH. Номера видимых пишутся в visible подряд и по возрастанию,
+// их матрицы - в world по 16 float (world == nullptr - матрицы не нужны). Возвращает число видимых
+size_t transformCullScalar(const TransformView& view, size_t begin, size_t end, uint32_t* visible, float* world);
+size_t transformCullSse(const TransformView& view, size_t begin, size_t end, uint32_t* visible, float* world);
+size_t transformCullAvx2(const TransformView& view, size_t begin, size_t end, uint32_t* visible, float* world);
+
+// собран ли TransformSystemAvx2.cpp с AVX2 (поддержку процессором проверяет transformKernelSupported)
+bool transformAvx2Compiled();
+
+#endif //VULKAN_LEARN_TRANSFORMKERNELS_H
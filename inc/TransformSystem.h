@@ -0,0 +1,63 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_TRANSFORMSYSTEM_H
+#define VULKAN_LEARN_TRANSFORMSYSTEM_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ThreadPool.h"
+#include "TransformKernels.h"
+
+enum class TransformKernel {
+    Scalar, // glm, по одному объекту
+    Sse,    // 4 объекта за инструкцию
+    Avx2    // 8 объектов, FMA
+};
+
+const char* transformKernelName(TransformKernel kernel);
+TransformKernel parseTransformKernel(const std::string& name);
+// собран и поддерживается процессором (CPUID проверяется во время работы)
+bool transformKernelSupported(TransformKernel kernel);
+TransformKernel bestTransformKernel();
+
+// Трансформы множества объектов в раскладке SoA: позиция, вращение и масштаб каждого объекта лежат в отдельных
+// массивах, поэтому ядра читают пакет объектов одной загрузкой на компоненту. За один проход строятся мировые
+// матрицы и отсекаются сферы объектов; на выходе - компактный список видимых для записи команд
+class TransformSystem {
+public:
+    void resize(size_t count);
+    size_t size() const { return count; }
+
+    // вращение на angle радиан вокруг единичной оси axis
+    void set(size_t index, const glm::vec3& position, const glm::vec3& axis, float angle, float scale);
+
+    // общие матрицы: parent - слева (вращение сцены), local - справа (приведение меша); bounds - сфера в пространстве local
+    void setParent(const glm::mat4& parent);
+    void setLocal(const glm::mat4& local, const glm::vec4& bounds);
+
+    // Мировые матрицы и отсечение по 6 плоскостям (мировое пространство, нормали внутрь). Возвращает число видимых n:
+    // visible[0 .. n) - их номера по возрастанию, world[0 .. n) (если не nullptr) - их матрицы в том же порядке.
+    // Векторы только растут до size() и не обрезаются - иначе каждый кадр заново заполнялись бы нулями.
+    // Куски по CHUNK_SIZE объектов раздаются потокам pool; pool == nullptr - все в вызывающем потоке
+    size_t update(const glm::vec4 planes[6], TransformKernel kernel, ThreadPool* pool,
+                  std::vector<uint32_t>& visible, std::vector<glm::mat4>* world) const;
+
+    static constexpr size_t CHUNK_SIZE = 16384;
+
+private:
+    size_t count = 0;
+    std::vector<float> positionX, positionY, positionZ;
+    std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+    std::vector<float> scale;
+    glm::mat4 parent{1.0f};
+    glm::mat4 local{1.0f};
+    glm::vec4 bounds{0.0f};
+};
+
+#endif //VULKAN_LEARN_TRANSFORMSYSTEM_H
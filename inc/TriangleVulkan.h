@@ -23,6 +23,30 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <chrono>
+#include <cmath>
+#include <functional>
+#include <thread>
+
+#include "AppOptions.h"
+#include "FrameProfiler.h"
+#include "GpuProfiler.h"
+#include "DeviceAllocator.h"
+#include "UploadManager.h"
+#include "PipelineCache.h"
+#include "PipelineCompiler.h"
+#include "ShaderLibrary.h"
+#include "ThreadPool.h"
+#include "UniformRing.h"
+#include "QueueScheduler.h"
+#include "RenderGraph.h"
+#include "Meshlet.h"
+#include "SceneGraph.h"
+#include "TransformSystem.h"
+#include "DeletionQueue.h"
+#include "DeviceCaps.h"
+#include "InitGraph.h"
+#include "MeshFile.h"
+#include "VertexFormat.h"
 
 #ifdef NDEBUG
 const bool enableValidationLayers = false;
@@ -33,6 +57,9 @@ const bool enableValidationLayers = true;
 struct QueueFamilyIndices {
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> presentFamily;
+    // необязательные выделенные семейства (--async-queues): работают параллельно с графикой
+    std::optional<uint32_t> computeFamily;  // COMPUTE без GRAPHICS
+    std::optional<uint32_t> transferFamily; // только TRANSFER
 
     bool isComplete()
     {
@@ -40,62 +67,56 @@ struct QueueFamilyIndices {
     }
 };
 
-struct Vertex {
-    glm::vec2 pos;
-    glm::vec3 color;
+// данные одной копии меша при instancing: читаются из binding 1 раз на instance, а не на вершину
+struct InstanceData {
+    glm::mat4 transform;
+    glm::vec4 color; // умножается на цвет вершины
 
-    // общее описание того, как вершины расположены в памяти
-    // (размер каждой вершины, как они читаются)
-    static VkVertexInputBindingDescription getBindingDescription()
-    {
-        VkVertexInputBindingDescription bindingDescription{};
-        bindingDescription.binding = 0;
-        bindingDescription.stride = sizeof(Vertex); // количество байт от одной записи до следующей
-        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-        return bindingDescription;
-    }
-
-//    pos.x  pos.y  color.r  color.g  color.b     |  pos.x  pos.y  color.r  color.g  color.b |  pos.x  pos.y  color.r  color.g  color.b
-//    (8 байт)      (12 байт)                     |  (8 байт)      (12 байт)                 |  (8 байт)      (12 байт)
-//    ------------------- 20 байт ----------------|----------------- 20 байт ----------------|---------------- 20 байт ----------------
-
-    // это конкретное описание отдельных атрибутов внутри вершины
-    // (смещение, формат, связь с location в шейдере)
-    static std::array<VkVertexInputAttributeDescription,2> getAttributeDescriptions()
-    {
-        std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
-
-        // position from vertex shader ( in layout[0])
-        attributeDescriptions[0].binding = 0;
-        attributeDescriptions[0].location = 0;
-        attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT; // pos.x,pos.y то есть два float
-        attributeDescriptions[0].offset = offsetof(Vertex, pos);
-
-        // color from vertex shader ( in layout[1])
-        attributeDescriptions[1].binding = 0;
-        attributeDescriptions[1].location = 1;
-        attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT; // color.r  color.g  color.b то есть три float
-        attributeDescriptions[1].offset = offsetof(Vertex, color);
-
-        return attributeDescriptions;
-    }
 };
 
+// mat4 в вершинном входе занимает 4 location подряд, по одному на столбец;
+// следующая запись - на следующем instance
+using InstanceVertexInput = VertexInputLayout<
+        VertexBinding<INSTANCE_BINDING, sizeof(InstanceData), VK_VERTEX_INPUT_RATE_INSTANCE,
+                VERTEX_ATTRIBUTE_COLUMNS(InstanceData, transform, 2, VK_FORMAT_R32G32B32A32_SFLOAT, 4, glm::vec4),
+                VERTEX_ATTRIBUTE(InstanceData, color, 6, VK_FORMAT_R32G32B32A32_SFLOAT)>>;
+
 struct SwapChainSupportDetails {
     std::vector<VkSurfaceFormatKHR> formats;
     std::vector<VkPresentModeKHR>   presentModes;
     VkSurfaceCapabilitiesKHR        capabilities;
 };
 
+// общие для всего кадра матрицы; model у каждого объекта своя (ObjectUniforms или DrawPushConstants)
 struct UniformBufferObject {
-     glm::mat4 model;
      glm::mat4 view;
      glm::mat4 proj;
 };
 
+// данные одного объекта в динамическом uniform буфере (binding 1): у каждого draw свое смещение в кольце
+struct ObjectUniforms {
+    glm::mat4 model;
+    glm::vec4 color;
+};
+
+// данные одного draw через vkCmdPushConstants (--push-constants), совпадает с shaders/push.vert;
+// 68 байт - в гарантированные 128 байт maxPushConstantsSize помещается
+struct DrawPushConstants {
+    glm::mat4 model;
+    uint32_t materialIndex; // индекс в таблице материалов шейдера
+};
+
+// один объект в списке отрисовки
+struct DrawItem {
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+    uint32_t objectIndex; // уходит в firstInstance, по нему шейдер найдет данные объекта
+};
+
 class TriangleVulkan {
 public:
+    explicit TriangleVulkan(const AppOptions& options = {});
     void run();
 
 private:
@@ -135,34 +156,64 @@ private:
     // 8. Создание Swap Chain
     void createSwapChain();
     void recreateSwapChain();
+    void resizeStressTest();
     SwapChainSupportDetails queueSwapChainSupport(const VkPhysicalDevice& device);
     VkSurfaceFormatKHR chooseSwapChainFormats(const std::vector<VkSurfaceFormatKHR>& availableFormats);
     VkPresentModeKHR chooseSwapChainPresent(const std::vector<VkPresentModeKHR>& availablePresentModes);
     VkExtent2D chooseSwapChainExtent(const VkSurfaceCapabilitiesKHR& capabilities);
     void createImageViews();
 
-    // 9. Создание Render Pass и графического конвейера (Pipeline)
-    void createRenderPass();
-    void createGraphicsPipeline();
-    VkShaderModule createShaderModule(const std::vector<char>& code);
+    // 8.1 Headless режим: вместо swap chain рендерим в собственные VkImage
+    void createOffscreenTargets();
+    void cleanupOffscreenTargets();
 
-    // 10. Создание Framebuffer
-    void createFramebuffers();
+    // 9. Граф кадра (render pass и framebuffers создает он) и графический конвейер (Pipeline)
+    void createFrameGraph();
+    void renderGraphReport();
+    void createGraphicsPipeline();
+    void preloadShaders();
 
     // 11. Создание Command Pool и буферов команд
     void createCommandPool();
     void createCommandBuffers();
     void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+    void recordMainPass(VkCommandBuffer commandBuffer);
+    void recordDrawRange(VkCommandBuffer commandBuffer, size_t begin, size_t end, bool timed);
+    void recordItemDraws(VkCommandBuffer commandBuffer, size_t index);
+    VkPipeline selectDrawPipeline();
+
+    // 11.1 Параллельная запись: каждому потоку свой VkCommandPool на каждый кадр в полете
+    void createDrawList();
+    void cullObjects();
+    void createParallelRecording(uint32_t threadCount);
+    void destroyParallelRecording();
+    void recordSecondaryBuffers(std::vector<VkCommandBuffer>& recorded);
 
     // 12. Создание буферов (Vertex / Index)
-    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, DeviceAllocation& bufferMemory,
+                      bool concurrent = false);
+    void destroyBuffer(VkBuffer buffer, DeviceAllocation& bufferMemory);
+    void loadMesh();
+    void loadMeshFile();
+    void buildMeshClusters(const Vertex* source, size_t vertexCount);
+    void cullMeshlets();
     void createVertexBuffer();
     void createIndexBuffer();
     void createUniformBuffer();
     void updateUniformBuffer(uint32_t currentImage);
+    void createObjectUniformRing();
+    void updateObjectUniforms(uint32_t currentImage);
+    void createInstanceBuffers();
+    void updateInstanceBuffer(uint32_t currentImage);
+    InstanceData makeInstance(uint32_t index, float time) const;
+    void gridPlacement(uint32_t index, glm::vec3& position, float& scale) const;
+    void buildScene();
+    void updateScene();
+    glm::mat4 objectLocal(uint32_t index, float time) const;
+    glm::mat4 rowLocal(uint32_t row, float time) const;
+    float animationTime() const;
     void createDescriptorPool();
     void createDescriptorSets();
-    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
     uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 
     // 13. Создание объектов синхронизации (Semaphores, Fences)
@@ -173,10 +224,24 @@ private:
     void drawFrame();
 
     // 15. Вспомогательные функции
-    static std::vector<char> readFile(const std::string& fileName);
     void printPhysicalDevices(const std::vector<VkPhysicalDevice>& devices);
     void printVkExtensions(const std::vector<VkExtensionProperties>& extensions);
     void mainLoop();
+    void benchmarkLoop();
+    void writeBenchmarkReport(std::ostream& out, double elapsedSeconds);
+    void printGpuStats();
+    void recordScalingBenchmark();
+    void vertexFormatReport();
+    void transformBenchmark();
+    void writeReport(const std::function<void(std::ostream&)>& write);
+
+    // 17. GPU-driven отрисовка: отсечение в compute шейдере + indirect draw
+    void createCullingResources();
+    void destroyCullingResources();
+    void recordCulling(VkCommandBuffer commandBuffer);
+    uint64_t submitAsyncCulling();
+    void recordIndirectDraws(VkCommandBuffer commandBuffer);
+    static void extractFrustumPlanes(const glm::mat4& matrix, glm::vec4 planes[6]);
 
     // 16. Очистка ресурсов
     void cleanup();
@@ -184,68 +249,219 @@ private:
     void cleanupSwapChain();
 
 private:
+        AppOptions options;
+        InitGraph startup; // шаги инициализации и их время (--startup-report)
+
         // 1. Базовые компоненты (инициализация)
         VkInstance instance;
-        GLFWwindow* window;
+        GLFWwindow* window = nullptr;
         const int WIDTH = 900;
         const int HEIGHT = 600;
-        VkSurfaceKHR surface;
+        VkSurfaceKHR surface = VK_NULL_HANDLE;
         const std::vector<const char*> validationLayers = {"VK_LAYER_KHRONOS_validation"};
         VkDebugUtilsMessengerEXT debugMessenger;
 
         // 2. Устройство (выбор видеокарты и создание логического устройства)
         VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+        DeviceCaps deviceCaps;              // свойства, features, память, очереди и расширения - запрошены один раз
+        QueueFamilyIndices familyIndices;   // семейства очередей выбранного устройства
+        SwapChainSupportDetails swapChainSupport; // форматы и present modes surface; capabilities обновляются при пересоздании
         VkDevice device;
         VkQueue graphicsQueue;
         VkQueue presentQueue;
-        const std::vector<const char*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+        DeviceAllocator allocator; // все буферы и images берут память из его блоков, а не отдельным vkAllocateMemory
+        UploadManager uploadManager; // копирования в DEVICE_LOCAL буферы через staging кольцо, без vkQueueWaitIdle
+        std::vector<const char*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME }; // в headless режиме пустой
 
         // 3. Swap Chain (цепочка кадров)
-        VkSwapchainKHR swapChain;
+        VkSwapchainKHR swapChain = VK_NULL_HANDLE;
+        uint32_t swapChainRecreations = 0; // для --resize-stress
         VkFormat swapChainImageFormat;
         VkExtent2D swapChainExtent;
         std::vector<VkImage> swapChainImages;
         std::vector<VkImageView> swapChainImageViews;
 
-        // 4. Рендер-процесс (Render Pass, Pipeline, Framebuffers)
-        VkRenderPass renderPass;
-        VkPipeline graphicsPipeline; // ?
+        // 3.1 Offscreen цели (headless): swapChainImages указывают на них, память принадлежит нам
+        const VkFormat OFFSCREEN_FORMAT = VK_FORMAT_R8G8B8A8_UNORM; // обязателен для color attachment на любом устройстве
+        std::vector<DeviceAllocation> offscreenImagesMemory;
+
+        // 4. Рендер-процесс: граф кадра - [отсечение в compute] -> основной проход в swap chain image.
+        // Барьеры между проходами, переходы layout и framebuffers - его забота
+        RenderGraph frameGraph{"frame"};
+        RenderGraph::PassId mainPass = 0;
+        RenderGraph::ResourceId backbufferResource = 0;
+        RenderGraph::ResourceId drawCommandsResource = RenderGraph::NONE;
+        RenderGraph::ResourceId drawCountResource = RenderGraph::NONE;
+        bool recordParallel = false;                      // кадр пишется secondary буферами
+        std::vector<VkCommandBuffer> frameSecondaryBuffers; // записаны до primary, исполняет основной проход
+        VkRenderPass renderPass; // основного прохода, принадлежит frameGraph
+        // pipeline компилируются в фоне (PipelineCompiler), здесь только их handles
+        PipelineHandle graphicsPipeline = INVALID_PIPELINE_HANDLE; // базовый, он же запасной, пока вариант не готов
+        PipelineHandle instancedPipeline = INVALID_PIPELINE_HANDLE; // тот же pipeline + binding 1 с InstanceData (--instanced)
+        PipelineHandle pushConstantPipeline = INVALID_PIPELINE_HANDLE; // model и материал через push constants (--push-constants)
+        VkPipeline drawPipeline = VK_NULL_HANDLE; // выбран в начале записи кадра; VK_NULL_HANDLE - кадр без draw
+        uint32_t fallbackFrames = 0;    // кадры, нарисованные базовым pipeline вместо еще не готового варианта
+        uint32_t skippedDrawFrames = 0; // кадры без draw: не готов ни один pipeline
+        PipelineCache pipelineCache; // переживает перезапуск процесса, см. --pipeline-cache
+        PipelineCompiler pipelineCompiler; // пул потоков компиляции, общий VkPipelineCache
+        ShaderLibrary shaderLibrary; // шейдерные модули создаются один раз и живут до cleanup()
+        bool pipelineFeedbackSupported = false; // VK_EXT_pipeline_creation_feedback - для подсчета попаданий в кэш
         VkPipelineLayout pipelineLayout; // ?
-        std::vector<VkFramebuffer> swapChainFramebuffers;
 
         // 5. Командные буферы и синхронизация
         VkCommandPool commandPool; // ?
         const int MAX_FRAMES_IN_FLIGHT = 2; // кол-во кадров которые могут готовиться одновременно
         uint32_t currentFrame = 0;
+        FrameProfiler frameProfiler; // CPU время фаз drawFrame() для бенчмарка
+        GpuProfiler gpuProfiler;     // timestamps/pipeline statistics на каждый кадр в полете
         std::vector<VkCommandBuffer> commandBuffers;
         std::vector<VkSemaphore> imageAvailableSemaphores; // ?
         std::vector<VkSemaphore> renderFinishedSemaphores;// ?
         std::vector<VkFence> inFlightFences; // ??
+        // --sync timeline: вместо fence счетчик graphics очереди, кадр помнит значение, которое сигналит его submit.
+        // Планировщик отдает загрузки и отсечение выделенным очередям (--async-queues), у каждой свой timeline
+        QueueScheduler queueScheduler;
+        std::vector<uint64_t> frameTimelineValues;
+        std::vector<VkBufferMemoryBarrier> frameAcquireBarriers; // acquire половина передачи владения от transfer очереди
+        // где кадр ждет загрузки: вершины/индексы и compute отсечение (объекты для cull.comp)
+        const VkPipelineStageFlags UPLOAD_CONSUMER_STAGES = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        // номер кадра (с 1), отправленного из каждого слота: после ожидания слота этот кадр и все до него завершены
+        uint64_t submittedFrames = 0;
+        std::vector<uint64_t> frameNumbers;
+        DeletionQueue deletionQueue; // старые swap chain, image views, framebuffers - пока их читают кадры в полете
+
+        // 5.1 Параллельная запись (--record-threads): пулы [кадр * recordSlotCount + поток]
+        struct RecordSlot {
+            VkCommandPool pool = VK_NULL_HANDLE;
+            VkCommandBuffer commandBuffer = VK_NULL_HANDLE; // secondary, пишет свой кусок drawList
+        };
+        std::unique_ptr<ThreadPool> recordPool; // nullptr - запись в одном потоке прямо в primary
+        std::vector<RecordSlot> recordSlots;
+        uint32_t recordSlotCount = 0;
+        std::vector<DrawItem> drawList;
+        // номера drawList, которые пишутся в кадр: [0, visibleDrawCount). Без --cpu-culling - все по порядку
+        std::vector<uint32_t> visibleDraws;
+        size_t visibleDrawCount = 0;
+
+        // 11.2 Отсечение объектов на CPU (--cpu-culling)
+        TransformSystem objectTransforms;
+        TransformKernel transformKernel = TransformKernel::Scalar;
+        std::vector<glm::mat4> visibleWorlds;   // model матрицы видимых, в порядке visibleDraws
+        std::unique_ptr<ThreadPool> cullPool;
+        uint64_t cpuCullTested = 0;             // накопленные за запуск счетчики для отчета бенчмарка
+        uint64_t cpuCullVisible = 0;
 
         // 6. Буферы (Вершины, Индексы)
         VkBuffer vertexBuffer;
-        VkDeviceMemory vertexBufferMemory;
+        DeviceAllocation vertexBufferMemory;
 
         VkBuffer indexBuffer;
-        VkDeviceMemory indexBufferMemory;
+        DeviceAllocation indexBufferMemory;
+        UploadTicket geometryUpload = 0; // батч, в котором ушли вершины и индексы
 
         std::vector<VkBuffer> uniformBuffers;
-        std::vector<VkDeviceMemory> uniformBuffersMemory;
+        std::vector<DeviceAllocation> uniformBuffersMemory;
         std::vector<void*> uniformBuffersMapped;
-
+        UniformRing uniformRing;                    // ObjectUniforms всех объектов кадра
+        std::vector<uint32_t> objectUniformOffsets; // dynamic offset каждого draw в кольце текущего кадра
+        const uint32_t MATERIAL_COUNT = 4;          // размер таблицы материалов в shaders/push.vert
+
+        // 6.1 Instancing: свой буфер на каждый кадр в полете, чтобы CPU мог писать, пока GPU читает прошлый кадр
+        std::vector<InstanceData> instances;
+        std::vector<VkBuffer> instanceBuffers;
+        std::vector<DeviceAllocation> instanceBuffersMemory;
+        // объекты, чьи матрицы еще не скопированы в буфер кадра; целиком - первый раз или когда изменилось все
+        std::vector<std::vector<uint32_t>> instanceUploads;
+        std::vector<std::vector<uint8_t>> instanceUploadQueued;
+        std::vector<bool> instanceFullUpload;
+
+        // 6.1 Граф сцены: строки сетки - узлы-группы, объекты - их дети. world объекта - в пространстве сетки
+        // и зеркалится в instances[i].transform; вращение всей сцены (sceneTransform) по-прежнему отдельно
+        SceneGraph scene;
+        std::vector<uint32_t> rowNodes;
+        std::vector<uint32_t> objectNodes;
+        std::vector<uint32_t> nodeObjects;   // объект узла, у групп - UINT32_MAX
+        uint32_t animatedRowCursor = 0;
+        std::chrono::steady_clock::time_point animationStart = std::chrono::steady_clock::now();
+        uint64_t sceneFrames = 0;            // накопленные за запуск счетчики для отчета бенчмарка
+        uint64_t sceneDirtyNodes = 0;
+        uint64_t instanceUploadBytes = 0;
+
+        // встроенный квадрат - если не указан --mesh
         const std::vector<Vertex> vertices = {
-                {{-0.5f, -0.5f}, {1.0f, 0.0f, 0.0f}},
-                {{0.5f, -0.5f}, {0.0f, 1.0f, 0.0f}},
-                {{0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}},
-                {{-0.5f, 0.5f}, {1.0f, 1.0f, 1.0f}}
+                {{-0.5f, -0.5f, 0.0f}, {1.0f, 0.0f, 0.0f}},
+                {{0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f}},
+                {{0.5f, 0.5f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+                {{-0.5f, 0.5f, 0.0f}, {1.0f, 1.0f, 1.0f}}
         };
 
         const std::vector<uint16_t> indices = { 0,1,2,2,3,0};
+
+        // 6.2 Меш из файла (--mesh): отображение живет до копирования в staging, потом закрывается
+        std::unique_ptr<MeshFile> meshFile;
+        uint32_t meshIndexCount = 0;
+        VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+        glm::vec4 meshBounds{0.0f};        // центр и радиус в пространстве меша
+        glm::mat4 meshTransform{1.0f};     // приводит меш из файла к размеру встроенного квадрата
+
+        // 6.3 Формат вершинного буфера (--vertex-format): сжатые вершины кодируются в loadMesh()
+        VertexLayout vertexLayout;
+        std::vector<uint8_t> vertexData;          // сжатые или разделенные на потоки вершины, живут до копирования в staging
+        VkDeviceSize vertexBufferSize = 0;
+        std::vector<VkBuffer> vertexStreamBuffers;     // по одному на binding вершин меша (все - vertexBuffer)
+        std::vector<VkDeviceSize> vertexStreamOffsets;
+
+        // 6.4 Кластеры меша (--meshlets): границы в пространстве вершинного буфера, как meshBounds
+        std::vector<Meshlet> meshlets;
+        MeshletCuller meshletCuller;
+        std::vector<MeshletDraw> meshletDraws;   // видимые диапазоны всех объектов кадра (CPU отсечение)
+        std::vector<size_t> meshletDrawOffsets;  // диапазоны объекта i: [offsets[i], offsets[i + 1])
+        uint64_t meshletsTested = 0;             // накопленные за запуск счетчики для отчета бенчмарка
+        uint64_t meshletsVisible = 0;
+        VkBuffer meshletBuffer = VK_NULL_HANDLE;  // Meshlet[] для отсечения в compute (--gpu-driven)
+        DeviceAllocation meshletBufferMemory;
         bool framebufferResized = false;
 
         VkDescriptorPool descriptorPool;
         VkDescriptorSetLayout descriptorSetLayout;
         std::vector<VkDescriptorSet> descriptorSets;
+        UniformBufferObject lastUbo{}; // матрицы текущего кадра, из них строится frustum для отсечения
+        glm::mat4 sceneTransform{1.0f}; // вращение всей сцены, домножается на transform каждого объекта
+
+        // 7. GPU-driven отрисовка (--gpu-driven)
+        struct CullObject {                 // std430, совпадает с shaders/cull.comp
+            glm::vec4 boundingSphere;       // центр и радиус в пространстве меша
+            uint32_t indexCount;
+            uint32_t firstIndex;
+            int32_t vertexOffset;
+            uint32_t pad;
+        };
+        struct CullPushConstants {
+            glm::vec4 frustumPlanes[6];
+            uint32_t objectCount;
+            uint32_t compact;               // 1 - видимые команды подряд + счетчик (для DrawIndexedIndirectCount)
+            uint32_t meshletCount;          // 0 - отсечение объектов целиком, иначе пар объект x кластер
+            uint32_t pad;
+            glm::vec4 camera;               // позиция камеры в пространстве сетки instances (конус нормалей)
+        };
+        VkBuffer cullObjectBuffer = VK_NULL_HANDLE;
+        DeviceAllocation cullObjectBufferMemory;
+        std::vector<VkBuffer> drawCommandBuffers;     // VkDrawIndexedIndirectCommand, свой на кадр в полете
+        std::vector<DeviceAllocation> drawCommandBuffersMemory;
+        std::vector<VkBuffer> drawCountBuffers;
+        std::vector<DeviceAllocation> drawCountBuffersMemory;
+        VkDescriptorSetLayout cullDescriptorSetLayout = VK_NULL_HANDLE;
+        VkDescriptorPool cullDescriptorPool = VK_NULL_HANDLE;
+        std::vector<VkDescriptorSet> cullDescriptorSets;
+        VkPipelineLayout cullPipelineLayout = VK_NULL_HANDLE;
+        VkPipeline cullPipeline = VK_NULL_HANDLE;
+        // отсечение в async compute очереди: свой пул и командный буфер на каждый кадр в полете
+        bool asyncCulling = false;
+        VkCommandPool computeCommandPool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> computeCommandBuffers;
+        bool multiDrawIndirectSupported = false;
+        bool drawIndirectCountSupported = false;     // VK_KHR_draw_indirect_count
+        PFN_vkCmdDrawIndexedIndirectCountKHR cmdDrawIndexedIndirectCount = nullptr;
 };
 
 #endif //VULKAN_LEARN_TRIANGLEVULKAN_H
@@ -0,0 +1,60 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_UNIFORMRING_H
+#define VULKAN_LEARN_UNIFORMRING_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "DeviceAllocator.h"
+
+// Линейный аллокатор uniform данных: на каждый кадр в полете один большой постоянно отображенный буфер.
+// За кадр данные только дописываются, в начале кадра (после его fence) указатель сбрасывается в ноль.
+// Смещения выровнены по minUniformBufferOffsetAlignment и передаются как dynamic offset
+// для VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC - один descriptor set на кадр вместо набора на объект.
+class UniformRing {
+public:
+    void init(VkDevice device, DeviceAllocator& allocator, VkDeviceSize minAlignment,
+              uint32_t framesInFlight, VkDeviceSize frameCapacity);
+    void destroy();
+
+    // GPU уже не читает данные этого кадра
+    void beginFrame(uint32_t frame);
+
+    // место под size байт в буфере текущего кадра; возвращает смещение для vkCmdBindDescriptorSets
+    uint32_t allocate(VkDeviceSize size, void*& data);
+
+    template <typename T>
+    uint32_t push(const T& value)
+    {
+        void* data = nullptr;
+        uint32_t offset = allocate(sizeof(T), data);
+        memcpy(data, &value, sizeof(T));
+        return offset;
+    }
+
+    VkBuffer buffer(uint32_t frame) const { return frames[frame].buffer; }
+    VkDeviceSize alignment() const { return align; }
+    VkDeviceSize capacity() const { return frameCapacity; }
+    VkDeviceSize usedBytes() const { return head; }
+
+private:
+    struct FrameBuffer {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        DeviceAllocation memory;
+    };
+
+    VkDevice device = VK_NULL_HANDLE;
+    DeviceAllocator* allocator = nullptr;
+    std::vector<FrameBuffer> frames;
+    uint32_t currentFrame = 0;
+    VkDeviceSize head = 0;
+    VkDeviceSize align = 1;
+    VkDeviceSize frameCapacity = 0;
+};
+
+#endif //VULKAN_LEARN_UNIFORMRING_H
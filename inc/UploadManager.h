@@ -0,0 +1,111 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_UPLOADMANAGER_H
+#define VULKAN_LEARN_UPLOADMANAGER_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <vector>
+
+#include "DeviceAllocator.h"
+#include "TimelineSemaphore.h"
+
+// номер батча загрузки; 0 - загрузок не было, ждать нечего
+using UploadTicket = uint64_t;
+
+struct UploadStats {
+    VkDeviceSize bytesUploaded = 0;
+    uint64_t batchesSubmitted = 0;
+    uint64_t stagingStalls = 0; // сколько раз ждали GPU, потому что staging кольцо было заполнено
+};
+
+// Загрузка данных в DEVICE_LOCAL буферы без vkQueueWaitIdle:
+// данные копируются в постоянно отображенное staging кольцо, копирования копятся в командном буфере батча,
+// батч отправляется с собственным fence. Кольцо освобождается по мере завершения батчей (строго по порядку),
+// а потребитель ждет только батч своего тикета.
+// С timeline семафором батч вместо fence сигналит следующее значение общего счетчика,
+// и другие submit могут ждать именно его (pendingTimelineValue) без ожидания на CPU.
+// Если загрузки идут в отдельную transfer очередь, exclusive буферы после копирования передаются
+// семейству-потребителю: release барьер в батче, acquire - в командном буфере потребителя (takeAcquireBarriers).
+class UploadManager {
+public:
+    static constexpr VkDeviceSize DEFAULT_STAGING_SIZE = 16ull * 1024 * 1024;
+
+    // timeline == nullptr - завершение батчей отслеживается fence;
+    // consumerFamily - семейство очереди, которая читает буферы (VK_QUEUE_FAMILY_IGNORED - та же очередь)
+    void init(VkDevice device, DeviceAllocator& allocator, VkQueue queue, uint32_t queueFamilyIndex,
+              TimelineSemaphore* timeline = nullptr, uint32_t consumerFamily = VK_QUEUE_FAMILY_IGNORED,
+              VkDeviceSize stagingSize = DEFAULT_STAGING_SIZE);
+    void destroy();
+
+    // копирует size байт из data в dst[dstOffset...]; данные больше кольца разбиваются на куски.
+    // Память data можно переиспользовать сразу после возврата.
+    // concurrent - буфер создан с VK_SHARING_MODE_CONCURRENT, передавать владение не нужно.
+    // Exclusive буфер после передачи принадлежит потребителю: повторно загружать в него нельзя
+    UploadTicket upload(VkBuffer dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size, bool concurrent = false);
+
+    // отправить накопленные копирования; возвращает тикет отправленного батча (или последнего, если копировать нечего)
+    UploadTicket flush();
+
+    // acquire барьеры для буферов из уже отправленных батчей; записать в командный буфер очереди-потребителя,
+    // который ждет pendingTimelineValue() (стадии ожидания - srcStageMask барьера)
+    std::vector<VkBufferMemoryBarrier> takeAcquireBarriers();
+
+    bool isComplete(UploadTicket ticket);
+    void wait(UploadTicket ticket);
+    void waitIdle();
+
+    // значение timeline, которое сигналит последний отправленный батч (0 - без timeline или все уже завершено)
+    uint64_t pendingTimelineValue() const;
+
+    UploadStats stats() const;
+    void printStats(std::ostream& out) const;
+
+private:
+    struct Batch {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        UploadTicket ticket = 0;
+        uint64_t timelineValue = 0; // при работе с timeline вместо fence
+        VkDeviceSize ringBytes = 0; // сколько байт кольца занято батчем (включая пропуск в конце при переходе через край)
+    };
+
+    Batch& currentBatch();
+    bool allocateStaging(VkDeviceSize size, VkDeviceSize& offset);
+    void retireCompleted(bool waitOldest);
+    Batch acquireBatchObjects();
+    UploadTicket submitBatch(bool releaseOwnership);
+    bool isBatchComplete(const Batch& batch);
+
+    VkDevice device = VK_NULL_HANDLE;
+    DeviceAllocator* allocator = nullptr;
+    VkQueue queue = VK_NULL_HANDLE;
+    TimelineSemaphore* timeline = nullptr;
+    uint32_t queueFamily = 0;
+    uint32_t consumerFamily = VK_QUEUE_FAMILY_IGNORED;
+    std::vector<VkBuffer> unreleasedBuffers;          // записаны, но еще не отданы потребителю
+    std::vector<VkBufferMemoryBarrier> pendingAcquires; // отданы, потребитель еще не забрал
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    DeviceAllocation stagingMemory;
+    VkDeviceSize ringSize = 0;
+    VkDeviceSize ringHead = 0;
+    VkDeviceSize ringUsed = 0;
+
+    bool recording = false;
+    Batch recordingBatch;
+    std::deque<Batch> submitted;   // в порядке отправки
+    std::vector<Batch> freeBatches; // командные буферы и fence для повторного использования
+
+    UploadTicket nextTicket = 1;
+    UploadTicket completedTicket = 0;
+    UploadTicket lastSubmittedTicket = 0;
+    UploadStats counters;
+};
+
+#endif //VULKAN_LEARN_UPLOADMANAGER_H
@@ -0,0 +1,128 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_VERTEXFORMAT_H
+#define VULKAN_LEARN_VERTEXFORMAT_H
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "VertexInput.h"
+
+// Вершина в полной точности: так ее пишет конвертер и так она лежит в .vmesh (VMESH_VERTEX_POSITION_COLOR).
+// Сжатые форматы ниже получаются из нее при загрузке
+struct Vertex {
+    glm::vec3 pos;
+    glm::vec3 color;
+};
+
+//    pos.x  pos.y  pos.z  color.r  color.g  color.b |  pos.x  pos.y  pos.z  color.r  color.g  color.b
+//    (12 байт)            (12 байт)                 |  (12 байт)            (12 байт)
+//    --------------------- 24 байта ----------------|--------------------- 24 байта ----------------
+
+// как вершины лежат в вершинном буфере (--vertex-format)
+enum class VertexFormat {
+    Float32, // Vertex как есть, 24 байта
+    Half,    // позиция 4 x float16, цвет RGBA8 UNORM - 12 байт
+    Snorm16, // позиция 4 x SNORM16, цвет RGBA8 UNORM - 12 байт
+};
+
+const char* vertexFormatName(VertexFormat format);
+VertexFormat parseVertexFormat(const std::string& name); // кидает исключение на неизвестное имя
+
+// Сжатая вершина. Позиция квантуется в [-1, 1] относительно границ меша (QuantizationBounds), четвертая
+// компонента - выравнивание: 3-компонентные 16-битные форматы почти нигде не поддерживаются как вершинные.
+// Распаковка бесплатна - ее делает выборка вершин по формату атрибута, шейдеры получают те же vec3
+//
+//    pos.x  pos.y  pos.z  pad  |  r  g  b  a
+//    ------ 8 байт ----------- | -- 4 байта --
+struct PackedVertex {
+    uint16_t pos[4];  // биты float16 или int16 SNORM
+    uint32_t color;   // r | g << 8 | b << 16 | a << 24
+};
+static_assert(sizeof(PackedVertex) == 12, "PackedVertex must be tightly packed");
+
+// Область, которая отображается в [-1, 1]: позиция в буфере = (pos - center) / extent.
+// Масштаб общий по всем осям, чтобы ограничивающая сфера осталась сферой
+struct QuantizationBounds {
+    glm::vec3 center{0.0f};
+    float extent = 1.0f;
+
+    static QuantizationBounds compute(const Vertex* vertices, size_t count);
+
+    // обратное преобразование для матрицы модели: buffer -> пространство меша
+    glm::mat4 dequantizeTransform() const;
+};
+
+// Вершинный вход меша: location 0 - позиция, 1 - цвет. Binding 2 и дальше свободны под instance данные
+const uint32_t INSTANCE_BINDING = 2;
+
+// чередующиеся вершины - один binding
+using Float32VertexInput = VertexInputLayout<
+        VertexBinding<0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX,
+                VERTEX_ATTRIBUTE(Vertex, pos, 0, VK_FORMAT_R32G32B32_SFLOAT),     // pos.x, pos.y, pos.z то есть три float
+                VERTEX_ATTRIBUTE(Vertex, color, 1, VK_FORMAT_R32G32B32_SFLOAT)>>; // color.r  color.g  color.b то есть три float
+
+template <VkFormat PositionFormat>
+using PackedVertexInput = VertexInputLayout<
+        VertexBinding<0, sizeof(PackedVertex), VK_VERTEX_INPUT_RATE_VERTEX,
+                VERTEX_ATTRIBUTE(PackedVertex, pos, 0, PositionFormat),
+                VERTEX_ATTRIBUTE(PackedVertex, color, 1, VK_FORMAT_R8G8B8A8_UNORM)>>;
+
+// Раздельные потоки (SoA): позиции в binding 0, цвет в binding 1. Проход, которому нужна только позиция,
+// привязывает один binding 0 и не тянет цвет через кэш вершин
+template <VkFormat PositionFormat, VkFormat ColorFormat>
+using SplitVertexInput = VertexInputLayout<
+        VertexBinding<0, vertexFormatSize(PositionFormat), VK_VERTEX_INPUT_RATE_VERTEX, VertexAttribute<0, PositionFormat, 0>>,
+        VertexBinding<1, vertexFormatSize(ColorFormat), VK_VERTEX_INPUT_RATE_VERTEX, VertexAttribute<1, ColorFormat, 0>>>;
+
+// Раскладка, выбранная при запуске (--vertex-format, --vertex-streams), - копия одного из constexpr описаний выше.
+// Потоки лежат в одном VkBuffer друг за другом: binding i начинается с streamOffset(i, vertexCount)
+struct VertexLayout {
+    VertexFormat format = VertexFormat::Float32;
+    bool split = false;
+    std::vector<VkVertexInputBindingDescription> bindings;
+    std::vector<VkVertexInputAttributeDescription> attributes;
+
+    static VertexLayout get(VertexFormat format, bool split = false);
+
+    // байт на вершину по всем потокам
+    uint32_t stride() const;
+    VkDeviceSize streamOffset(size_t binding, size_t vertexCount) const;
+
+private:
+    template <typename Input>
+    static VertexLayout from(VertexFormat format, bool split)
+    {
+        VertexLayout layout;
+        layout.format = format;
+        layout.split = split;
+        layout.bindings.assign(Input::bindings.begin(), Input::bindings.end());
+        layout.attributes.assign(Input::attributes.begin(), Input::attributes.end());
+        return layout;
+    }
+};
+
+// Чередующиеся вершины (interleaved, один binding) -> потоки раскладки split, атрибуты сопоставляются по location
+void deinterleaveVertices(const void* src, size_t count, const VertexLayout& interleaved, const VertexLayout& split, void* dst);
+
+// Кодировщики: SSE2 на x86-64, скалярный путь везде остальной и для сравнения (allowSimd = false).
+// Результаты обоих путей совпадают побитно
+void encodeVertices(const Vertex* src, size_t count, VertexFormat format, const QuantizationBounds& bounds,
+                    PackedVertex* dst, bool allowSimd = true);
+
+// Октаэдрическая нормаль: единичный вектор -> 2 x SNORM16 в uint32 (x в младших битах), 4 байта вместо 12
+void encodeNormalsOct16(const glm::vec3* normals, size_t count, uint32_t* dst, bool allowSimd = true);
+glm::vec3 decodeNormalOct16(uint32_t encoded);
+
+// обратные преобразования на CPU - для проверки ошибки квантования
+float halfToFloat(uint16_t value);
+glm::vec3 decodePosition(const PackedVertex& vertex, VertexFormat format, const QuantizationBounds& bounds);
+
+#endif //VULKAN_LEARN_VERTEXFORMAT_H
@@ -0,0 +1,135 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#ifndef VULKAN_LEARN_VERTEXINPUT_H
+#define VULKAN_LEARN_VERTEXINPUT_H
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Описание вершинного входа на этапе компиляции: раскладка объявляется списком binding и атрибутов,
+// а массивы VkVertexInputBindingDescription/VkVertexInputAttributeDescription собираются constexpr.
+// Размеры массивов, выход атрибута за stride и повтор location/binding проверяются static_assert
+//
+//     using Layout = VertexInputLayout<
+//         VertexBinding<0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX,
+//             VERTEX_ATTRIBUTE(Vertex, pos, 0, VK_FORMAT_R32G32B32_SFLOAT),
+//             VERTEX_ATTRIBUTE(Vertex, color, 1, VK_FORMAT_R32G32B32_SFLOAT)>>;
+//     Layout::bindings, Layout::attributes
+
+// байт на атрибут; форматы, которых нет в списке, не пройдут static_assert в VertexAttribute
+constexpr uint32_t vertexFormatSize(VkFormat format)
+{
+    switch (format)
+    {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SNORM:
+        case VK_FORMAT_R16G16_SNORM:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R32_UINT:
+        case VK_FORMAT_R32_SFLOAT:
+            return 4;
+        case VK_FORMAT_R16G16B16A16_SNORM:
+        case VK_FORMAT_R16G16B16A16_UNORM:
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+        case VK_FORMAT_R32G32_SFLOAT:
+            return 8;
+        case VK_FORMAT_R32G32B32_SFLOAT:
+            return 12;
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+        case VK_FORMAT_R32G32B32A32_UINT:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+// Атрибут с location Location по смещению Offset внутри записи binding.
+// Count > 1 - матрица или массив: Count location подряд, каждый следующий через Step байт (столбцы mat4)
+template <uint32_t Location, VkFormat Format, uint32_t Offset, uint32_t Count = 1, uint32_t Step = 0>
+struct VertexAttribute {
+    static_assert(vertexFormatSize(Format) > 0, "unknown vertex attribute format: add it to vertexFormatSize()");
+    static_assert(Count == 1 || Step >= vertexFormatSize(Format), "attribute columns overlap");
+
+    static constexpr uint32_t count = Count;
+    static constexpr uint32_t end = Offset + (Count - 1) * Step + vertexFormatSize(Format);
+
+    static constexpr void describe(uint32_t binding, VkVertexInputAttributeDescription* out)
+    {
+        for (uint32_t i = 0; i < Count; i++)
+        {
+            out[i] = {Location + i, binding, Format, Offset + i * Step};
+        }
+    }
+};
+
+// смещение поля структуры вершины берется через offsetof, чтобы раскладка не расходилась с C++ типом
+#define VERTEX_ATTRIBUTE(Type, member, location, format) \
+    VertexAttribute<location, format, static_cast<uint32_t>(offsetof(Type, member))>
+#define VERTEX_ATTRIBUTE_COLUMNS(Type, member, location, format, columns, ColumnType) \
+    VertexAttribute<location, format, static_cast<uint32_t>(offsetof(Type, member)), columns, static_cast<uint32_t>(sizeof(ColumnType))>
+
+// Один вершинный буфер (binding): шаг записи и частота - на вершину или на instance
+template <uint32_t Binding, uint32_t Stride, VkVertexInputRate Rate, typename... Attributes>
+struct VertexBinding {
+    static_assert(((Attributes::end <= Stride) && ...), "vertex attribute runs past the binding stride");
+
+    static constexpr uint32_t attributeCount = (Attributes::count + ... + 0);
+    static constexpr VkVertexInputBindingDescription description{Binding, Stride, Rate};
+
+    static constexpr void describe(VkVertexInputAttributeDescription* out)
+    {
+        ((Attributes::describe(Binding, out), out += Attributes::count), ...);
+    }
+};
+
+template <size_t BindingCount, size_t AttributeCount>
+constexpr bool vertexInputSlotsUnique(const std::array<VkVertexInputBindingDescription, BindingCount>& bindings,
+                                      const std::array<VkVertexInputAttributeDescription, AttributeCount>& attributes)
+{
+    for (size_t i = 0; i < BindingCount; i++)
+    {
+        for (size_t j = i + 1; j < BindingCount; j++)
+        {
+            if (bindings[i].binding == bindings[j].binding)
+            {
+                return false;
+            }
+        }
+    }
+    for (size_t i = 0; i < AttributeCount; i++)
+    {
+        for (size_t j = i + 1; j < AttributeCount; j++)
+        {
+            if (attributes[i].location == attributes[j].location)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Полный вершинный вход pipeline: несколько binding, в том числе раздельные потоки одного меша
+// (позиции отдельно от остальных атрибутов) и instance данные
+template <typename... Bindings>
+struct VertexInputLayout {
+    static constexpr size_t bindingCount = sizeof...(Bindings);
+    static constexpr size_t attributeCount = (Bindings::attributeCount + ... + 0);
+
+    static constexpr std::array<VkVertexInputBindingDescription, bindingCount> bindings{Bindings::description...};
+
+    static constexpr std::array<VkVertexInputAttributeDescription, attributeCount> attributes = [] {
+        std::array<VkVertexInputAttributeDescription, attributeCount> result{};
+        VkVertexInputAttributeDescription* out = result.data();
+        ((Bindings::describe(out), out += Bindings::attributeCount), ...);
+        return result;
+    }();
+
+    static_assert(vertexInputSlotsUnique(bindings, attributes), "duplicate binding or location in vertex input layout");
+};
+
+#endif //VULKAN_LEARN_VERTEXINPUT_H
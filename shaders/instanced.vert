@@ -0,0 +1,26 @@
+#version 450
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// для instancing здесь одна запись на кадр: вращение всей сцены
+layout(binding = 1) uniform ObjectUniforms {
+    mat4 model;
+    vec4 color;
+} object;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+
+// binding 1, VK_VERTEX_INPUT_RATE_INSTANCE (InstanceData)
+layout(location = 2) in mat4 instanceTransform;
+layout(location = 6) in vec4 instanceColor;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    gl_Position = ubo.proj * ubo.view * object.model * instanceTransform * vec4(inPosition, 1.0);
+    fragColor = inColor * instanceColor.rgb;
+}
@@ -0,0 +1,30 @@
+#version 450
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// данные draw записаны в командный буфер через vkCmdPushConstants (DrawPushConstants)
+layout(push_constant) uniform DrawParameters {
+    mat4 model;
+    uint materialIndex;
+} draw;
+
+// таблица материалов, MATERIAL_COUNT в TriangleVulkan.h
+const vec3 MATERIALS[4] = vec3[](
+    vec3(1.0, 1.0, 1.0),
+    vec3(1.0, 0.6, 0.6),
+    vec3(0.6, 1.0, 0.6),
+    vec3(0.6, 0.6, 1.0)
+);
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    gl_Position = ubo.proj * ubo.view * draw.model * vec4(inPosition, 1.0);
+    fragColor = inColor * MATERIALS[draw.materialIndex];
+}
@@ -0,0 +1,22 @@
+#version 450
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// данные объекта: смещение в кольце задается dynamic offset при привязке
+layout(binding = 1) uniform ObjectUniforms {
+    mat4 model;
+    vec4 color;
+} object;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    gl_Position = ubo.proj * ubo.view * object.model * vec4(inPosition, 1.0);
+    fragColor = inColor * object.color.rgb;
+}
@@ -0,0 +1,343 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "AppOptions.h"
+
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+const uint32_t DEFAULT_HEADLESS_FRAMES = 300;
+const uint32_t DEFAULT_BENCHMARK_FRAMES = 1000;
+
+uint32_t parseUint(const std::string& name, const std::string& value)
+{
+    try
+    {
+        // stoul пропускает пробелы и принимает знак ("-1" -> ULONG_MAX), поэтому первой должна быть цифра
+        if (value.empty() || value[0] < '0' || value[0] > '9')
+        {
+            throw std::invalid_argument(value);
+        }
+        size_t parsed = 0;
+        unsigned long result = std::stoul(value, &parsed);
+        if (parsed != value.size())
+        {
+            throw std::invalid_argument(value);
+        }
+        if (result > UINT32_MAX)
+        {
+            throw std::out_of_range(value);
+        }
+        return static_cast<uint32_t>(result);
+    }
+    catch (const std::exception&)
+    {
+        throw std::runtime_error("invalid value for " + name + ": " + value);
+    }
+}
+
+double parseDouble(const std::string& name, const std::string& value)
+{
+    try
+    {
+        size_t parsed = 0;
+        double result = std::stod(value, &parsed);
+        if (parsed != value.size() || result < 0.0)
+        {
+            throw std::invalid_argument(value);
+        }
+        return result;
+    }
+    catch (const std::exception&)
+    {
+        throw std::runtime_error("invalid value for " + name + ": " + value);
+    }
+}
+
+} // namespace
+
+AppOptions parseAppOptions(int argc, char** argv)
+{
+    AppOptions options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        // значение опции - следующий аргумент
+        auto nextValue = [&]() -> std::string {
+            if (i + 1 >= argc)
+            {
+                throw std::runtime_error("missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--headless")
+        {
+            options.headless = true;
+        }
+        else if (arg == "--frames")
+        {
+            options.frameCount = parseUint(arg, nextValue());
+        }
+        else if (arg == "--benchmark")
+        {
+            options.benchmark = true;
+        }
+        else if (arg == "--warmup")
+        {
+            options.warmupFrames = parseUint(arg, nextValue());
+        }
+        else if (arg == "--duration")
+        {
+            options.benchmarkSeconds = parseDouble(arg, nextValue());
+        }
+        else if (arg == "--benchmark-out")
+        {
+            options.benchmarkOutput = nextValue();
+        }
+        else if (arg == "--gpu-timing")
+        {
+            options.gpuTiming = true;
+        }
+        else if (arg == "--pipeline-stats")
+        {
+            options.gpuTiming = true;
+            options.pipelineStatistics = true;
+        }
+        else if (arg == "--objects")
+        {
+            options.objectCount = parseUint(arg, nextValue());
+        }
+        else if (arg == "--instanced")
+        {
+            options.instanced = true;
+        }
+        else if (arg == "--animate-instances")
+        {
+            options.instanced = true;
+            options.animateInstances = true;
+        }
+        else if (arg == "--animate-rows")
+        {
+            options.animateRows = parseUint(arg, nextValue());
+        }
+        else if (arg == "--static-scene")
+        {
+            options.staticScene = true;
+        }
+        else if (arg == "--push-constants")
+        {
+            options.pushConstants = true;
+        }
+        else if (arg == "--gpu-driven")
+        {
+            options.instanced = true;
+            options.gpuDriven = true;
+        }
+        else if (arg == "--record-threads")
+        {
+            options.recordThreads = parseUint(arg, nextValue());
+        }
+        else if (arg == "--record-scaling")
+        {
+            options.recordScaling = true;
+        }
+        else if (arg == "--resize-stress")
+        {
+            options.resizeStress = true;
+        }
+        else if (arg == "--async-queues")
+        {
+            options.timelineSync = true;
+            options.asyncQueues = true;
+        }
+        else if (arg == "--sync")
+        {
+            std::string mode = nextValue();
+            if (mode != "binary" && mode != "timeline")
+            {
+                throw std::runtime_error("invalid value for --sync: " + mode);
+            }
+            options.timelineSync = mode == "timeline";
+        }
+        else if (arg == "--serial-init")
+        {
+            options.serialInit = true;
+        }
+        else if (arg == "--startup-report")
+        {
+            options.startupReport = true;
+        }
+        else if (arg == "--mesh")
+        {
+            options.meshPath = nextValue();
+        }
+        else if (arg == "--vertex-format")
+        {
+            options.vertexFormat = parseVertexFormat(nextValue());
+        }
+        else if (arg == "--vertex-streams")
+        {
+            std::string mode = nextValue();
+            if (mode != "interleaved" && mode != "split")
+            {
+                throw std::runtime_error("invalid value for --vertex-streams: " + mode);
+            }
+            options.splitVertexStreams = mode == "split";
+        }
+        else if (arg == "--vertex-format-report")
+        {
+            options.vertexFormatReport = true;
+        }
+        else if (arg == "--meshlets")
+        {
+            options.meshlets = true;
+        }
+        else if (arg == "--cpu-culling")
+        {
+            options.cpuCulling = true;
+        }
+        else if (arg == "--transform-kernel")
+        {
+            options.transformKernel = parseTransformKernel(nextValue());
+        }
+        else if (arg == "--transform-benchmark")
+        {
+            options.transformBenchmark = true;
+        }
+        else if (arg == "--render-graph-dump")
+        {
+            options.renderGraphDump = true;
+        }
+        else if (arg == "--render-graph-report")
+        {
+            options.renderGraphReport = true;
+        }
+        else if (arg == "--pipeline-threads")
+        {
+            options.pipelineThreads = parseUint(arg, nextValue());
+        }
+        else if (arg == "--pipeline-cache")
+        {
+            options.pipelineCachePath = nextValue();
+        }
+        else if (arg == "--no-pipeline-cache")
+        {
+            options.pipelineCachePath.clear();
+        }
+        else if (arg == "--shader-dir")
+        {
+            options.shaderDir = nextValue();
+        }
+        else if (arg == "--help" || arg == "-h")
+        {
+            options.showHelp = true;
+        }
+        else
+        {
+            throw std::runtime_error("unknown option: " + arg);
+        }
+    }
+
+    if (options.frameCount == 0)
+    {
+        if ((options.benchmark && options.benchmarkSeconds == 0.0) || options.recordScaling || options.resizeStress)
+        {
+            options.frameCount = DEFAULT_BENCHMARK_FRAMES;
+        }
+        else if (options.headless && !options.benchmark)
+        {
+            // без окна нечего закрывать, поэтому количество кадров должно быть конечным
+            options.frameCount = DEFAULT_HEADLESS_FRAMES;
+        }
+    }
+
+    if (options.objectCount == 0)
+    {
+        throw std::runtime_error("--objects must be at least 1");
+    }
+
+    if (options.resizeStress && options.headless)
+    {
+        throw std::runtime_error("--resize-stress needs a window, it cannot be combined with --headless");
+    }
+
+    if (options.pushConstants && options.instanced)
+    {
+        // у instancing данные объектов и так в instance буфере, push constants там нечего передавать
+        throw std::runtime_error("--push-constants cannot be combined with --instanced or --gpu-driven");
+    }
+
+    if (options.meshlets && options.instanced && !options.gpuDriven)
+    {
+        // один instanced draw рисует все объекты одним диапазоном индексов - видимость кластеров у объектов разная
+        throw std::runtime_error("--meshlets needs per-object draws or --gpu-driven, it cannot be combined with --instanced");
+    }
+
+    if (options.cpuCulling && options.instanced)
+    {
+        // instanced draw рисует непрерывный диапазон instances, а видимые объекты идут вразброс
+        throw std::runtime_error("--cpu-culling draws objects one by one, it cannot be combined with --instanced or --gpu-driven");
+    }
+
+    if (options.cpuCulling && options.animateRows > 0)
+    {
+        // --cpu-culling держит свою SoA копию трансформов, построенную один раз
+        throw std::runtime_error("--animate-rows cannot be combined with --cpu-culling");
+    }
+
+    if (options.transformKernel && !transformKernelSupported(*options.transformKernel))
+    {
+        throw std::runtime_error(std::string("--transform-kernel ") + transformKernelName(*options.transformKernel)
+                                 + " is not supported by this CPU or build");
+    }
+
+    return options;
+}
+
+void printUsage(const char* programName)
+{
+    std::cout << "Usage: " << programName << " [options]\n"
+              << "  --headless        render into offscreen images, no window and no swap chain\n"
+              << "  --frames N        stop after N frames (headless default: " << DEFAULT_HEADLESS_FRAMES << ")\n"
+              << "  --benchmark       measure drawFrame() after warm-up and print a JSON report\n"
+              << "  --warmup N        frames rendered before measuring (default: 100)\n"
+              << "  --duration S      measure for S seconds instead of --frames (default frames: " << DEFAULT_BENCHMARK_FRAMES << ")\n"
+              << "  --benchmark-out F write the JSON report to file F instead of stdout\n"
+              << "  --gpu-timing      GPU timestamps around the render pass and draws (logged once per second, added to the benchmark)\n"
+              << "  --pipeline-stats  also collect vertex/fragment shader invocations and clipping primitives\n"
+              << "  --objects N       draw N objects per frame (default: 1)\n"
+              << "  --instanced       draw all objects with one instanced draw (per-instance transform and colour)\n"
+              << "  --animate-instances  rewrite the instance buffer every frame (implies --instanced)\n"
+              << "  --animate-rows N  move N grid rows per frame: only their subtrees of the scene graph are recomputed and uploaded\n"
+              << "  --static-scene    stop the scene animation clock: a static scene recomputes and uploads no matrices\n"
+              << "  --push-constants  pass each draw's model matrix and material index with vkCmdPushConstants\n"
+              << "  --gpu-driven      frustum-cull objects in a compute shader and draw them with indirect commands\n"
+              << "  --record-threads N  record the draw list into secondary command buffers on N threads\n"
+              << "  --record-scaling  measure command buffer recording with 1..N threads (N = --record-threads or CPU count)\n"
+              << "  --resize-stress   resize the window every other frame and report the worst frame time (JSON)\n"
+              << "  --sync MODE       frame synchronisation: binary (fences, default) or timeline (VK_KHR_timeline_semaphore)\n"
+              << "  --async-queues    uploads on a dedicated transfer queue, culling on an async compute queue (implies --sync timeline)\n"
+              << "  --startup-report  print the duration and thread of every initialisation step to stderr\n"
+              << "  --serial-init     run initialisation steps one by one on the main thread (for comparison)\n"
+              << "  --mesh F          draw the .vmesh file F (see tools/meshconv) instead of the built-in quad\n"
+              << "  --vertex-format F vertex buffer layout: float32 (default), half or snorm16 positions with RGBA8 colours\n"
+              << "  --vertex-streams M  interleaved (default) or split: positions and colours in separate vertex streams\n"
+              << "  --meshlets        split the mesh into clusters and skip clusters outside the frustum or facing away\n"
+              << "  --cpu-culling     frustum-cull objects on the CPU (SoA transforms, SIMD, all cores) and draw only visible ones\n"
+              << "  --transform-kernel K  scalar, sse or avx2 for --cpu-culling (default: the best one the CPU supports)\n"
+              << "  --transform-benchmark  compare scalar and SIMD transform + culling for 10k, 100k and 1M objects (JSON)\n"
+              << "  --vertex-format-report  compare vertex formats on the CPU: size, encode speed, quantisation error (JSON)\n"
+              << "  --render-graph-dump  print the compiled frame graph: pass order, barriers, transient memory\n"
+              << "  --render-graph-report  compile the frame graph and a sample deferred + bloom graph, report memory aliasing (JSON)\n"
+              << "  --pipeline-threads N  compile graphics pipelines on N background threads (default: 2, 0 = synchronously)\n"
+              << "  --pipeline-cache F  load/save the driver pipeline cache at F (default: pipeline_cache.bin)\n"
+              << "  --no-pipeline-cache do not read or write the pipeline cache\n"
+              << "  --shader-dir DIR    directory with compiled .spv files (embedded shaders take precedence)\n"
+              << "  --help            show this message\n";
+}
@@ -0,0 +1,33 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "DeletionQueue.h"
+
+#include <utility>
+
+void DeletionQueue::push(uint64_t frameNumber, std::function<void()> deleter)
+{
+    entries.push_back({frameNumber, std::move(deleter)});
+}
+
+void DeletionQueue::collect(uint64_t completedFrame)
+{
+    while (!entries.empty() && entries.front().frameNumber <= completedFrame)
+    {
+        // сначала снять из очереди: deleter может сам положить что-то в очередь
+        std::function<void()> deleter = std::move(entries.front().deleter);
+        entries.pop_front();
+        deleter();
+    }
+}
+
+void DeletionQueue::flush()
+{
+    while (!entries.empty())
+    {
+        std::function<void()> deleter = std::move(entries.front().deleter);
+        entries.pop_front();
+        deleter();
+    }
+}
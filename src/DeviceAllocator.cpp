@@ -0,0 +1,372 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "DeviceAllocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+// Блок VkDeviceMemory разбит на непрерывные участки (свободные и занятые), упорядоченные по смещению.
+// Свободные дополнительно лежат в freeBySize - для best-fit поиска.
+struct DeviceMemoryBlock {
+    struct Segment {
+        VkDeviceSize size = 0;
+        bool free = true;
+    };
+
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize size = 0;
+    void* mapped = nullptr;
+    uint32_t memoryType = 0;
+    uint32_t poolKey = 0;
+    VkDeviceSize used = 0;
+    uint32_t allocations = 0;
+
+    std::map<VkDeviceSize, Segment> segments;               // offset -> участок
+    std::multimap<VkDeviceSize, VkDeviceSize> freeBySize;   // size -> offset свободных участков
+
+    void addFree(VkDeviceSize offset, VkDeviceSize segmentSize)
+    {
+        segments[offset] = { segmentSize, true };
+        freeBySize.emplace(segmentSize, offset);
+    }
+
+    void removeFree(VkDeviceSize offset)
+    {
+        VkDeviceSize segmentSize = segments[offset].size;
+        auto range = freeBySize.equal_range(segmentSize);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second == offset)
+            {
+                freeBySize.erase(it);
+                break;
+            }
+        }
+        segments.erase(offset);
+    }
+
+    // выделение внутри блока; false если подходящего свободного участка нет
+    bool allocate(VkDeviceSize allocSize, VkDeviceSize alignment, VkDeviceSize& outOffset)
+    {
+        // best-fit: самый маленький свободный участок, в который запрос помещается с учетом выравнивания
+        for (auto it = freeBySize.lower_bound(allocSize); it != freeBySize.end(); ++it)
+        {
+            VkDeviceSize segmentOffset = it->second;
+            VkDeviceSize segmentSize = it->first;
+            VkDeviceSize alignedOffset = (segmentOffset + alignment - 1) / alignment * alignment;
+            VkDeviceSize padding = alignedOffset - segmentOffset;
+
+            if (padding + allocSize > segmentSize)
+            {
+                continue;
+            }
+
+            removeFree(segmentOffset);
+            if (padding > 0)
+            {
+                addFree(segmentOffset, padding);
+            }
+            segments[alignedOffset] = { allocSize, false };
+
+            VkDeviceSize tail = segmentSize - padding - allocSize;
+            if (tail > 0)
+            {
+                addFree(alignedOffset + allocSize, tail);
+            }
+
+            used += allocSize;
+            allocations++;
+            outOffset = alignedOffset;
+            return true;
+        }
+        return false;
+    }
+
+    void release(VkDeviceSize offset)
+    {
+        auto it = segments.find(offset);
+        if (it == segments.end() || it->second.free)
+        {
+            throw std::runtime_error("double free or foreign allocation in device allocator!");
+        }
+
+        VkDeviceSize freedOffset = offset;
+        VkDeviceSize freedSize = it->second.size;
+        used -= freedSize;
+        allocations--;
+        segments.erase(it);
+
+        // слияние с правым свободным соседом
+        auto next = segments.lower_bound(freedOffset + freedSize);
+        if (next != segments.end() && next->first == freedOffset + freedSize && next->second.free)
+        {
+            freedSize += next->second.size;
+            removeFree(next->first);
+        }
+
+        // и с левым
+        auto prev = segments.lower_bound(freedOffset);
+        if (prev != segments.begin())
+        {
+            --prev;
+            if (prev->second.free && prev->first + prev->second.size == freedOffset)
+            {
+                freedOffset = prev->first;
+                freedSize += prev->second.size;
+                removeFree(prev->first);
+            }
+        }
+
+        addFree(freedOffset, freedSize);
+    }
+};
+
+DeviceAllocator::DeviceAllocator() = default;
+DeviceAllocator::~DeviceAllocator() = default;
+
+void DeviceAllocator::init(VkDevice device, const DeviceCaps& caps, VkDeviceSize blockSize)
+{
+    this->device = device;
+    this->blockSize = blockSize;
+
+    memProperties = caps.memoryProperties;
+
+    const VkPhysicalDeviceProperties& properties = caps.properties;
+    bufferImageGranularity = std::max<VkDeviceSize>(1, properties.limits.bufferImageGranularity);
+    nonCoherentAtomSize = std::max<VkDeviceSize>(1, properties.limits.nonCoherentAtomSize);
+    maxMemoryAllocationCount = properties.limits.maxMemoryAllocationCount;
+    current.maxMemoryAllocationCount = maxMemoryAllocationCount;
+}
+
+void DeviceAllocator::destroy()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& [key, pool] : pools)
+    {
+        for (auto& block : pool.blocks)
+        {
+            if (block->mapped != nullptr)
+            {
+                vkUnmapMemory(device, block->memory);
+            }
+            vkFreeMemory(device, block->memory, nullptr);
+        }
+    }
+    pools.clear();
+    current = {};
+    current.maxMemoryAllocationCount = maxMemoryAllocationCount;
+}
+
+DeviceAllocation DeviceAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind)
+{
+    uint32_t memoryType = findMemoryType(requirements.memoryTypeBits, properties);
+    VkMemoryPropertyFlags typeFlags = memProperties.memoryTypes[memoryType].propertyFlags;
+
+    VkDeviceSize alignment = std::max<VkDeviceSize>(1, requirements.alignment);
+    VkDeviceSize size = requirements.size;
+
+    // flush некогерентной памяти идет кусками nonCoherentAtomSize - участки не должны делить такой кусок
+    if ((typeFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(typeFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+    {
+        alignment = std::max(alignment, nonCoherentAtomSize);
+        size = (size + nonCoherentAtomSize - 1) / nonCoherentAtomSize * nonCoherentAtomSize;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Pool& pool = poolFor(memoryType, kind);
+
+    DeviceMemoryBlock* target = nullptr;
+    VkDeviceSize offset = 0;
+    for (auto& block : pool.blocks)
+    {
+        if (block->size - block->used >= size && block->allocate(size, alignment, offset))
+        {
+            target = block.get();
+            break;
+        }
+    }
+
+    if (target == nullptr)
+    {
+        // большие ресурсы получают собственный блок точного размера, чтобы не дробить общие
+        VkDeviceSize preferred = preferredBlockSize(memoryType);
+        VkDeviceSize newBlockSize = size > preferred / 2 ? size : preferred;
+
+        target = createBlock(pool, newBlockSize);
+        if (!target->allocate(size, alignment, offset))
+        {
+            throw std::runtime_error("failed to sub-allocate from a fresh memory block!");
+        }
+    }
+
+    current.bytesUsed += size;
+    current.allocationCount++;
+
+    DeviceAllocation allocation;
+    allocation.memory = target->memory;
+    allocation.offset = offset;
+    allocation.size = size;
+    allocation.memoryType = memoryType;
+    allocation.block = target;
+    allocation.mapped = target->mapped != nullptr ? static_cast<char*>(target->mapped) + offset : nullptr;
+    return allocation;
+}
+
+void DeviceAllocator::free(DeviceAllocation& allocation)
+{
+    if (allocation.block == nullptr)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    DeviceMemoryBlock* block = allocation.block;
+    block->release(allocation.offset);
+
+    current.bytesUsed -= allocation.size;
+    current.allocationCount--;
+
+    // пустой блок возвращаем драйверу, но последний блок пула оставляем - чтобы не пересоздавать его на каждом цикле
+    if (block->allocations == 0)
+    {
+        Pool& pool = pools[block->poolKey];
+        if (pool.blocks.size() > 1 || block->size != preferredBlockSize(block->memoryType))
+        {
+            destroyBlock(block);
+        }
+    }
+
+    allocation = {};
+}
+
+void DeviceAllocator::flush(const DeviceAllocation& allocation, VkDeviceSize offset, VkDeviceSize size)
+{
+    VkMemoryPropertyFlags typeFlags = memProperties.memoryTypes[allocation.memoryType].propertyFlags;
+    if (typeFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+    {
+        return;
+    }
+
+    VkDeviceSize begin = allocation.offset + offset;
+    VkDeviceSize end = size == VK_WHOLE_SIZE ? allocation.offset + allocation.size : begin + size;
+    begin = begin / nonCoherentAtomSize * nonCoherentAtomSize;
+    end = std::min(allocation.block->size, (end + nonCoherentAtomSize - 1) / nonCoherentAtomSize * nonCoherentAtomSize);
+
+    VkMappedMemoryRange range{};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = allocation.memory;
+    range.offset = begin;
+    range.size = end - begin;
+    vkFlushMappedMemoryRanges(device, 1, &range);
+}
+
+uint32_t DeviceAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+{
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
+    {
+        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            return i;
+        }
+    }
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+const VkPhysicalDeviceMemoryProperties& DeviceAllocator::memoryProperties() const
+{
+    return memProperties;
+}
+
+AllocatorStats DeviceAllocator::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return current;
+}
+
+void DeviceAllocator::printStats(std::ostream& out) const
+{
+    AllocatorStats snapshot = stats();
+    out << "device memory: " << snapshot.allocationCount << " allocations in " << snapshot.blockCount
+        << " blocks (limit " << snapshot.maxMemoryAllocationCount << "), used "
+        << snapshot.bytesUsed / 1024 << " KiB of " << snapshot.bytesReserved / 1024 << " KiB reserved" << std::endl;
+}
+
+DeviceAllocator::Pool& DeviceAllocator::poolFor(uint32_t memoryType, ResourceKind kind)
+{
+    // при granularity 1 буферы и images могут соседствовать как угодно - отдельные блоки не нужны
+    uint32_t kindIndex = bufferImageGranularity > 1 ? static_cast<uint32_t>(kind) : 0;
+    uint32_t key = memoryType * 2 + kindIndex;
+
+    Pool& pool = pools[key];
+    pool.key = key;
+    pool.memoryType = memoryType;
+    return pool;
+}
+
+DeviceMemoryBlock* DeviceAllocator::createBlock(Pool& pool, VkDeviceSize size)
+{
+    if (maxMemoryAllocationCount != 0 && current.blockCount >= maxMemoryAllocationCount)
+    {
+        throw std::runtime_error("maxMemoryAllocationCount reached!");
+    }
+
+    auto block = std::make_unique<DeviceMemoryBlock>();
+    block->size = size;
+    block->memoryType = pool.memoryType;
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = pool.memoryType;
+
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &block->memory) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate device memory block!");
+    }
+
+    // отображаем один раз на всю жизнь блока: память нельзя отображать дважды, а map/unmap на каждый буфер дорог
+    if (memProperties.memoryTypes[pool.memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        if (vkMapMemory(device, block->memory, 0, VK_WHOLE_SIZE, 0, &block->mapped) != VK_SUCCESS)
+        {
+            vkFreeMemory(device, block->memory, nullptr);
+            throw std::runtime_error("failed to map device memory block!");
+        }
+    }
+
+    block->poolKey = pool.key;
+    block->addFree(0, size);
+
+    current.bytesReserved += size;
+    current.blockCount++;
+
+    pool.blocks.push_back(std::move(block));
+    return pool.blocks.back().get();
+}
+
+void DeviceAllocator::destroyBlock(DeviceMemoryBlock* block)
+{
+    Pool& pool = pools[block->poolKey];
+
+    if (block->mapped != nullptr)
+    {
+        vkUnmapMemory(device, block->memory);
+    }
+    vkFreeMemory(device, block->memory, nullptr);
+
+    current.bytesReserved -= block->size;
+    current.blockCount--;
+
+    pool.blocks.erase(std::remove_if(pool.blocks.begin(), pool.blocks.end(),
+                                     [block](const std::unique_ptr<DeviceMemoryBlock>& candidate) { return candidate.get() == block; }),
+                      pool.blocks.end());
+}
+
+VkDeviceSize DeviceAllocator::preferredBlockSize(uint32_t memoryType) const
+{
+    // на маленьких кучах (например 256 MiB BAR) один блок не должен съедать заметную часть кучи
+    VkDeviceSize heapSize = memProperties.memoryHeaps[memProperties.memoryTypes[memoryType].heapIndex].size;
+    return std::max<VkDeviceSize>(1024 * 1024, std::min(blockSize, heapSize / 8));
+}
@@ -0,0 +1,41 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "DeviceCaps.h"
+
+#include <cstring>
+
+DeviceCaps DeviceCaps::query(VkPhysicalDevice physicalDevice)
+{
+    DeviceCaps caps;
+    caps.physicalDevice = physicalDevice;
+
+    vkGetPhysicalDeviceProperties(physicalDevice, &caps.properties);
+    vkGetPhysicalDeviceFeatures(physicalDevice, &caps.features);
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &caps.memoryProperties);
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    caps.queueFamilies.resize(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, caps.queueFamilies.data());
+
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+    caps.extensions.resize(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, caps.extensions.data());
+
+    return caps;
+}
+
+bool DeviceCaps::hasExtension(const char* name) const
+{
+    for (const auto& extension : extensions)
+    {
+        if (std::strcmp(extension.extensionName, name) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,217 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "FrameProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+const char* framePhaseName(FramePhase phase)
+{
+    switch (phase)
+    {
+        case FramePhase::FenceWait:      return "fenceWait";
+        case FramePhase::Acquire:        return "acquire";
+        case FramePhase::UpdateUniforms: return "updateUniformBuffer";
+        case FramePhase::Record:         return "recordCommandBuffer";
+        case FramePhase::Submit:         return "queueSubmit";
+        case FramePhase::Present:        return "queuePresent";
+        default:                         return "unknown";
+    }
+}
+
+// перцентиль по nearest-rank: значение, не меньше которого p% замеров
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(sorted.size())));
+    rank = std::clamp<size_t>(rank, 1, sorted.size());
+    return sorted[rank - 1];
+}
+
+TimingStats computeTimingStats(std::vector<double> samples)
+{
+    TimingStats stats;
+    if (samples.empty())
+    {
+        return stats;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    stats.count = samples.size();
+    stats.min   = samples.front();
+    stats.max   = samples.back();
+    stats.mean  = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+    stats.p50   = percentile(samples, 50.0);
+    stats.p95   = percentile(samples, 95.0);
+    stats.p99   = percentile(samples, 99.0);
+    return stats;
+}
+
+void writeTimingStatsJson(std::ostream& out, const TimingStats& stats)
+{
+    out << "{\"count\": " << stats.count
+        << ", \"min\": " << stats.min
+        << ", \"mean\": " << stats.mean
+        << ", \"p50\": " << stats.p50
+        << ", \"p95\": " << stats.p95
+        << ", \"p99\": " << stats.p99
+        << ", \"max\": " << stats.max << "}";
+}
+
+std::string jsonEscape(const std::string& text)
+{
+    std::string result;
+    result.reserve(text.size());
+    for (char c : text)
+    {
+        switch (c)
+        {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n";  break;
+            case '\t': result += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    continue; // управляющие символы в имени устройства не нужны
+                }
+                result += c;
+        }
+    }
+    return result;
+}
+
+void FrameProfiler::setRecording(bool enabled)
+{
+    recording = enabled;
+}
+
+bool FrameProfiler::isRecording() const
+{
+    return recording;
+}
+
+void FrameProfiler::reset()
+{
+    frameSamples.clear();
+    for (auto& samples : phaseSamples)
+    {
+        samples.clear();
+    }
+
+    gpuRenderPassSamples.clear();
+    gpuDrawSamples.clear();
+    statisticsFrames = 0;
+    vertexShaderInvocations = 0;
+    clippingPrimitives = 0;
+    fragmentShaderInvocations = 0;
+}
+
+void FrameProfiler::beginFrame()
+{
+    frameStart = Clock::now();
+}
+
+void FrameProfiler::endFrame()
+{
+    if (recording)
+    {
+        frameSamples.push_back(elapsedMs(frameStart, Clock::now()));
+    }
+}
+
+void FrameProfiler::beginPhase(FramePhase phase)
+{
+    phaseStart[static_cast<size_t>(phase)] = Clock::now();
+}
+
+void FrameProfiler::endPhase(FramePhase phase)
+{
+    if (recording)
+    {
+        size_t index = static_cast<size_t>(phase);
+        phaseSamples[index].push_back(elapsedMs(phaseStart[index], Clock::now()));
+    }
+}
+
+void FrameProfiler::addGpuFrame(const GpuFrameStats& stats)
+{
+    if (!recording || !stats.valid)
+    {
+        return;
+    }
+
+    gpuRenderPassSamples.push_back(stats.renderPassMs);
+    gpuDrawSamples.push_back(stats.totalDrawMs());
+
+    if (stats.hasPipelineStatistics)
+    {
+        statisticsFrames++;
+        vertexShaderInvocations += stats.vertexShaderInvocations;
+        clippingPrimitives += stats.clippingPrimitives;
+        fragmentShaderInvocations += stats.fragmentShaderInvocations;
+    }
+}
+
+size_t FrameProfiler::recordedFrames() const
+{
+    return frameSamples.size();
+}
+
+TimingStats FrameProfiler::frameStats() const
+{
+    return computeTimingStats(frameSamples);
+}
+
+TimingStats FrameProfiler::phaseStats(FramePhase phase) const
+{
+    return computeTimingStats(phaseSamples[static_cast<size_t>(phase)]);
+}
+
+void FrameProfiler::writeJson(std::ostream& out) const
+{
+    out << "\"frameMs\": ";
+    writeTimingStatsJson(out, frameStats());
+    out << ",\n  \"phasesMs\": {";
+
+    bool first = true;
+    for (uint32_t i = 0; i < static_cast<uint32_t>(FramePhase::Count); i++)
+    {
+        if (phaseSamples[i].empty())
+        {
+            continue; // например acquire/present в headless режиме
+        }
+        out << (first ? "\n" : ",\n") << "    \"" << framePhaseName(static_cast<FramePhase>(i)) << "\": ";
+        writeTimingStatsJson(out, computeTimingStats(phaseSamples[i]));
+        first = false;
+    }
+    out << "\n  }";
+
+    if (!gpuRenderPassSamples.empty())
+    {
+        out << ",\n  \"gpuMs\": {\n    \"renderPass\": ";
+        writeTimingStatsJson(out, computeTimingStats(gpuRenderPassSamples));
+        out << ",\n    \"draws\": ";
+        writeTimingStatsJson(out, computeTimingStats(gpuDrawSamples));
+        out << "\n  }";
+    }
+
+    if (statisticsFrames > 0)
+    {
+        // среднее на кадр
+        double frames = static_cast<double>(statisticsFrames);
+        out << ",\n  \"pipelineStatistics\": {"
+            << "\"frames\": " << statisticsFrames
+            << ", \"vertexShaderInvocations\": " << static_cast<double>(vertexShaderInvocations) / frames
+            << ", \"clippingPrimitives\": " << static_cast<double>(clippingPrimitives) / frames
+            << ", \"fragmentShaderInvocations\": " << static_cast<double>(fragmentShaderInvocations) / frames
+            << "}";
+    }
+}
+
+double FrameProfiler::elapsedMs(Clock::time_point from, Clock::time_point to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
@@ -0,0 +1,217 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "GpuProfiler.h"
+
+#include <array>
+#include <stdexcept>
+
+double GpuFrameStats::totalDrawMs() const
+{
+    double total = 0.0;
+    for (double ms : drawMs)
+    {
+        total += ms;
+    }
+    return total;
+}
+
+void GpuProfiler::init(VkDevice device, const DeviceCaps& caps, uint32_t queueFamilyIndex,
+                       uint32_t framesInFlight, bool pipelineStatistics)
+{
+    this->device = device;
+
+    timestampPeriodNs = caps.properties.limits.timestampPeriod; // наносекунд на один тик
+
+    // 0 значащих бит - очередь timestamps не поддерживает
+    uint32_t validBits = caps.queueFamilies[queueFamilyIndex].timestampValidBits;
+    if (validBits == 0)
+    {
+        return;
+    }
+    timestampMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+    statisticsEnabled = pipelineStatistics;
+
+    frames.resize(framesInFlight);
+    for (auto& frame : frames)
+    {
+        VkQueryPoolCreateInfo timestampInfo{};
+        timestampInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        timestampInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        timestampInfo.queryCount = TIMESTAMP_QUERY_COUNT;
+
+        if (vkCreateQueryPool(device, &timestampInfo, nullptr, &frame.timestampPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create timestamp query pool!");
+        }
+
+        if (statisticsEnabled)
+        {
+            VkQueryPoolCreateInfo statisticsInfo{};
+            statisticsInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            statisticsInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+            statisticsInfo.queryCount = 1;
+            statisticsInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                                                VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+                                                VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+            if (vkCreateQueryPool(device, &statisticsInfo, nullptr, &frame.statisticsPool) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to create pipeline statistics query pool!");
+            }
+        }
+    }
+}
+
+void GpuProfiler::destroy()
+{
+    for (auto& frame : frames)
+    {
+        vkDestroyQueryPool(device, frame.timestampPool, nullptr);
+        if (frame.statisticsPool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(device, frame.statisticsPool, nullptr);
+        }
+    }
+    frames.clear();
+}
+
+bool GpuProfiler::isEnabled() const
+{
+    return !frames.empty();
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+
+    // запросы нужно сбросить до первого использования в кадре, и сделать это вне render pass
+    FrameQueries& queries = frames[frame];
+    vkCmdResetQueryPool(commandBuffer, queries.timestampPool, 0, TIMESTAMP_QUERY_COUNT);
+    if (queries.statisticsPool != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(commandBuffer, queries.statisticsPool, 0, 1);
+    }
+    queries.timedDraws = 0;
+    queries.written = true;
+}
+
+void GpuProfiler::beginRenderPass(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+    if (isEnabled())
+    {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frames[frame].timestampPool, RENDER_PASS_BEGIN);
+    }
+}
+
+void GpuProfiler::endRenderPass(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+    if (isEnabled())
+    {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frames[frame].timestampPool, RENDER_PASS_END);
+    }
+}
+
+void GpuProfiler::beginDraw(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+    if (!isEnabled() || frames[frame].timedDraws >= MAX_TIMED_DRAWS)
+    {
+        return;
+    }
+
+    FrameQueries& queries = frames[frame];
+    queries.openDraw = FIRST_DRAW_QUERY + 2 * queries.timedDraws;
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queries.timestampPool, queries.openDraw);
+}
+
+void GpuProfiler::endDraw(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+    if (!isEnabled() || frames[frame].timedDraws >= MAX_TIMED_DRAWS)
+    {
+        return;
+    }
+
+    FrameQueries& queries = frames[frame];
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queries.timestampPool, queries.openDraw + 1);
+    queries.timedDraws++;
+}
+
+void GpuProfiler::beginStatistics(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+    if (isEnabled() && frames[frame].statisticsPool != VK_NULL_HANDLE)
+    {
+        vkCmdBeginQuery(commandBuffer, frames[frame].statisticsPool, 0, 0);
+    }
+}
+
+void GpuProfiler::endStatistics(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+    if (isEnabled() && frames[frame].statisticsPool != VK_NULL_HANDLE)
+    {
+        vkCmdEndQuery(commandBuffer, frames[frame].statisticsPool, 0);
+    }
+}
+
+bool GpuProfiler::collect(uint32_t frame)
+{
+    stats.valid = false;
+    if (!isEnabled() || !frames[frame].written)
+    {
+        return false;
+    }
+
+    FrameQueries& queries = frames[frame];
+    uint32_t queryCount = FIRST_DRAW_QUERY + 2 * queries.timedDraws;
+
+    // без VK_QUERY_RESULT_WAIT_BIT: если GPU еще не дописал результаты, просто пропускаем кадр
+    std::array<uint64_t, TIMESTAMP_QUERY_COUNT> timestamps{};
+    VkResult result = vkGetQueryPoolResults(device, queries.timestampPool, 0, queryCount,
+                                            sizeof(timestamps), timestamps.data(), sizeof(uint64_t),
+                                            VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS)
+    {
+        return false;
+    }
+
+    stats.renderPassMs = ticksToMs(timestamps[RENDER_PASS_BEGIN], timestamps[RENDER_PASS_END]);
+    stats.drawMs.resize(queries.timedDraws);
+    for (uint32_t i = 0; i < queries.timedDraws; i++)
+    {
+        uint32_t query = FIRST_DRAW_QUERY + 2 * i;
+        stats.drawMs[i] = ticksToMs(timestamps[query], timestamps[query + 1]);
+    }
+
+    stats.hasPipelineStatistics = false;
+    if (queries.statisticsPool != VK_NULL_HANDLE)
+    {
+        // порядок значений - по возрастанию битов: vertex shader, clipping primitives, fragment shader
+        std::array<uint64_t, 3> values{};
+        result = vkGetQueryPoolResults(device, queries.statisticsPool, 0, 1, sizeof(values), values.data(),
+                                       sizeof(values), VK_QUERY_RESULT_64_BIT);
+        if (result == VK_SUCCESS)
+        {
+            stats.vertexShaderInvocations = values[0];
+            stats.clippingPrimitives = values[1];
+            stats.fragmentShaderInvocations = values[2];
+            stats.hasPipelineStatistics = true;
+        }
+    }
+
+    stats.valid = true;
+    return true;
+}
+
+const GpuFrameStats& GpuProfiler::lastStats() const
+{
+    return stats;
+}
+
+double GpuProfiler::ticksToMs(uint64_t begin, uint64_t end) const
+{
+    uint64_t ticks = ((end & timestampMask) - (begin & timestampMask)) & timestampMask;
+    return static_cast<double>(ticks) * timestampPeriodNs / 1e6;
+}
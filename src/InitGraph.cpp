@@ -0,0 +1,229 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "InitGraph.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+
+#include "FrameProfiler.h"
+
+InitGraph::InitGraph() : startTime(Clock::now()), endTime(startTime), mainThreadId(std::this_thread::get_id())
+{
+}
+
+void InitGraph::step(const std::string& name, const std::function<void()>& fn)
+{
+    Task task;
+    task.name = name;
+    task.mainThread = true;
+    task.thread = std::this_thread::get_id();
+
+    auto start = Clock::now();
+    fn();
+    auto end = Clock::now();
+
+    task.startMs = sinceStartMs(start);
+    task.durationMs = std::chrono::duration<double, std::milli>(end - start).count();
+    task.done = true;
+    tasks.push_back(std::move(task));
+    endTime = end;
+}
+
+InitGraph::TaskId InitGraph::add(const std::string& name, std::function<void()> fn, const std::vector<TaskId>& dependencies, bool mainThread)
+{
+    TaskId id = static_cast<TaskId>(tasks.size());
+
+    Task task;
+    task.name = name;
+    task.fn = std::move(fn);
+    task.mainThread = mainThread;
+
+    for (TaskId dependency : dependencies)
+    {
+        if (dependency >= id)
+        {
+            throw std::runtime_error("init task " + name + " depends on a task added after it");
+        }
+        if (!tasks[dependency].done)
+        {
+            tasks[dependency].dependents.push_back(id);
+            task.pendingDependencies++;
+        }
+    }
+
+    tasks.push_back(std::move(task));
+    return id;
+}
+
+void InitGraph::run(ThreadPool* pool)
+{
+    mainThreadId = std::this_thread::get_id();
+
+    if (pool == nullptr)
+    {
+        for (TaskId id = 0; id < tasks.size(); id++)
+        {
+            if (!tasks[id].done)
+            {
+                execute(id, nullptr);
+            }
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for (TaskId id = 0; id < tasks.size(); id++)
+    {
+        if (!tasks[id].done && tasks[id].pendingDependencies == 0)
+        {
+            dispatch(id, pool);
+        }
+    }
+
+    // основной поток сам выполняет свои задачи, пока рабочие заняты остальными
+    for (;;)
+    {
+        progress.wait(lock, [this]() { return (!error && !mainReady.empty()) || workersRunning == 0; });
+        if (error || mainReady.empty())
+        {
+            // рабочих задач нет, а основному потоку нечего делать: граф пройден или остановлен ошибкой
+            break;
+        }
+
+        TaskId id = mainReady.front();
+        mainReady.erase(mainReady.begin());
+        lock.unlock();
+        execute(id, pool);
+        lock.lock();
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+// обязательно под mutex
+void InitGraph::dispatch(TaskId id, ThreadPool* pool)
+{
+    if (tasks[id].mainThread)
+    {
+        mainReady.push_back(id);
+        progress.notify_all();
+        return;
+    }
+
+    workersRunning++;
+    pool->submit([this, id, pool]() {
+        execute(id, pool);
+    });
+}
+
+void InitGraph::execute(TaskId id, ThreadPool* pool)
+{
+    Task& task = tasks[id];
+    std::exception_ptr failure;
+
+    auto start = Clock::now();
+    try
+    {
+        task.fn();
+    }
+    catch (...)
+    {
+        failure = std::current_exception();
+    }
+    auto end = Clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    task.thread = std::this_thread::get_id();
+    task.startMs = sinceStartMs(start);
+    task.durationMs = std::chrono::duration<double, std::milli>(end - start).count();
+    task.done = true;
+    endTime = std::max(endTime, end);
+
+    if (task.thread != mainThreadId && std::find(workerIds.begin(), workerIds.end(), task.thread) == workerIds.end())
+    {
+        workerIds.push_back(task.thread);
+    }
+
+    if (failure && !error)
+    {
+        error = failure;
+    }
+
+    if (!error && pool != nullptr)
+    {
+        for (TaskId dependent : task.dependents)
+        {
+            if (--tasks[dependent].pendingDependencies == 0)
+            {
+                dispatch(dependent, pool);
+            }
+        }
+    }
+
+    // последнее обращение к графу из рабочего потока: после этого run() может вернуться
+    if (!task.mainThread)
+    {
+        workersRunning--;
+        progress.notify_all();
+    }
+}
+
+double InitGraph::sinceStartMs(Clock::time_point time) const
+{
+    return std::chrono::duration<double, std::milli>(time - startTime).count();
+}
+
+double InitGraph::totalMs() const
+{
+    return sinceStartMs(endTime);
+}
+
+std::string InitGraph::threadName(std::thread::id thread) const
+{
+    auto worker = std::find(workerIds.begin(), workerIds.end(), thread);
+    if (worker == workerIds.end())
+    {
+        return "main";
+    }
+    return "worker " + std::to_string(worker - workerIds.begin() + 1);
+}
+
+void InitGraph::printReport(std::ostream& out) const
+{
+    // по времени начала: видно, какие шаги шли одновременно
+    std::vector<const Task*> sorted;
+    for (const auto& task : tasks)
+    {
+        sorted.push_back(&task);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Task* a, const Task* b) { return a->startMs < b->startMs; });
+
+    out << "startup: " << std::fixed << std::setprecision(2) << totalMs() << " ms\n";
+    for (const Task* task : sorted)
+    {
+        out << "  " << std::setw(9) << task->startMs << " +" << std::setw(9) << task->durationMs << " ms  "
+            << std::left << std::setw(10) << threadName(task->thread) << std::right << task->name << '\n';
+    }
+    out << std::defaultfloat << std::flush;
+}
+
+void InitGraph::writeJson(std::ostream& out) const
+{
+    out << "{\"totalMs\": " << totalMs() << ", \"steps\": [";
+    for (size_t i = 0; i < tasks.size(); i++)
+    {
+        out << (i > 0 ? ", " : "") << "{\"name\": \"" << jsonEscape(tasks[i].name) << "\", \"thread\": \"" << threadName(tasks[i].thread)
+            << "\", \"startMs\": " << tasks[i].startMs << ", \"ms\": " << tasks[i].durationMs << "}";
+    }
+    out << "]}";
+}
@@ -0,0 +1,139 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "MappedFile.h"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("failed to open file " + path);
+    }
+
+    LARGE_INTEGER size{};
+    GetFileSizeEx(file, &size);
+    fileHandle = file;
+    fileSize = static_cast<size_t>(size.QuadPart);
+
+    // пустой файл отобразить нельзя - оставляем data() == nullptr
+    if (fileSize > 0)
+    {
+        mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle != nullptr)
+        {
+            mapping = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        }
+        if (mapping == nullptr)
+        {
+            close();
+            throw std::runtime_error("failed to map file " + path);
+        }
+    }
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("failed to open file " + path);
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("failed to stat file " + path);
+    }
+    fileSize = static_cast<size_t>(info.st_size);
+
+    if (fileSize > 0)
+    {
+        void* result = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (result == MAP_FAILED)
+        {
+            ::close(fd);
+            throw std::runtime_error("failed to map file " + path);
+        }
+        mapping = result;
+    }
+    // отображение живет и после закрытия дескриптора
+    ::close(fd);
+#endif
+}
+
+void MappedFile::adviseSequential() const
+{
+#ifndef _WIN32
+    if (mapping != nullptr)
+    {
+        posix_madvise(const_cast<void*>(mapping), fileSize, POSIX_MADV_SEQUENTIAL);
+    }
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        std::swap(mapping, other.mapping);
+        std::swap(fileSize, other.fileSize);
+#ifdef _WIN32
+        std::swap(fileHandle, other.fileHandle);
+        std::swap(mappingHandle, other.mappingHandle);
+#endif
+    }
+    return *this;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+    if (mapping != nullptr)
+    {
+        UnmapViewOfFile(mapping);
+    }
+    if (mappingHandle != nullptr)
+    {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle != nullptr)
+    {
+        CloseHandle(fileHandle);
+    }
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#else
+    if (mapping != nullptr)
+    {
+        munmap(const_cast<void*>(mapping), fileSize);
+    }
+#endif
+    mapping = nullptr;
+    fileSize = 0;
+}
@@ -0,0 +1,104 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "MeshFile.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool rangeInside(uint64_t offset, uint64_t size, uint64_t fileSize)
+{
+    return offset <= fileSize && size <= fileSize - offset;
+}
+
+} // namespace
+
+MeshFile::MeshFile(const std::string& path) : file(path)
+{
+    if (file.size() < sizeof(VMeshHeader))
+    {
+        throw std::runtime_error("mesh file is truncated: " + path);
+    }
+
+    // отображение выровнено по странице, заголовок в начале - читаем его на месте
+    fileHeader = static_cast<const VMeshHeader*>(file.data());
+    const VMeshHeader& h = *fileHeader;
+
+    if (h.magic != VMESH_MAGIC)
+    {
+        throw std::runtime_error("not a .vmesh file: " + path);
+    }
+    if (h.version != VMESH_VERSION)
+    {
+        throw std::runtime_error("unsupported .vmesh version " + std::to_string(h.version) + ": " + path);
+    }
+    if (h.indexSize != 2 && h.indexSize != 4)
+    {
+        throw std::runtime_error("invalid index size in mesh file: " + path);
+    }
+    if (h.vertexCount == 0 || h.indexCount == 0 || h.vertexStride == 0)
+    {
+        throw std::runtime_error("mesh file is empty: " + path);
+    }
+    // счетчики из файла не доверенные: count * stride не должно переполниться до проверки диапазона
+    if (h.vertexCount > file.size() / h.vertexStride || h.indexCount > file.size() / h.indexSize)
+    {
+        throw std::runtime_error("mesh data is outside of the file (truncated?): " + path);
+    }
+    if (!rangeInside(h.vertexOffset, vertexBytes(), file.size()) || !rangeInside(h.indexOffset, indexBytes(), file.size()))
+    {
+        throw std::runtime_error("mesh data is outside of the file (truncated?): " + path);
+    }
+
+    // данные читаются один раз подряд, при копировании в staging
+    file.adviseSequential();
+}
+
+const void* MeshFile::vertexData() const
+{
+    return static_cast<const char*>(file.data()) + fileHeader->vertexOffset;
+}
+
+const void* MeshFile::indexData() const
+{
+    return static_cast<const char*>(file.data()) + fileHeader->indexOffset;
+}
+
+void writeMeshFile(const std::string& path, VMeshHeader header, const void* vertices, const void* indices)
+{
+    header.magic = VMESH_MAGIC;
+    header.version = VMESH_VERSION;
+    header.reserved = 0;
+
+    uint64_t vertexBytes = header.vertexCount * header.vertexStride;
+    uint64_t indexBytes = header.indexCount * header.indexSize;
+    header.vertexOffset = alignUp(sizeof(VMeshHeader), VMESH_ALIGNMENT);
+    header.indexOffset = alignUp(header.vertexOffset + vertexBytes, VMESH_ALIGNMENT);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+    {
+        throw std::runtime_error("failed to open mesh file for writing: " + path);
+    }
+
+    std::vector<char> padding(VMESH_ALIGNMENT, 0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(padding.data(), static_cast<std::streamsize>(header.vertexOffset - sizeof(header)));
+    out.write(static_cast<const char*>(vertices), static_cast<std::streamsize>(vertexBytes));
+    out.write(padding.data(), static_cast<std::streamsize>(header.indexOffset - header.vertexOffset - vertexBytes));
+    out.write(static_cast<const char*>(indices), static_cast<std::streamsize>(indexBytes));
+
+    if (!out)
+    {
+        throw std::runtime_error("failed to write mesh file: " + path);
+    }
+}
@@ -0,0 +1,200 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "MeshOptimizer.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+const size_t NOT_CACHED = SIZE_MAX;
+
+void checkIndices(const uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+    if (indexCount % 3 != 0)
+    {
+        throw std::runtime_error("index count is not a multiple of 3");
+    }
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        if (indices[i] >= vertexCount)
+        {
+            throw std::runtime_error("index out of range");
+        }
+    }
+}
+
+} // namespace
+
+VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+    checkIndices(indices, indexCount, vertexCount);
+
+    // FIFO без очереди: вершина в кэше, пока после ее загрузки было меньше cacheSize промахов
+    std::vector<size_t> loadedAt(vertexCount, NOT_CACHED);
+    size_t misses = 0;
+    size_t used = 0;
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        size_t& loaded = loadedAt[indices[i]];
+        if (loaded == NOT_CACHED)
+        {
+            used++;
+        }
+        if (loaded == NOT_CACHED || misses - loaded >= cacheSize)
+        {
+            loaded = misses++;
+        }
+    }
+
+    VertexCacheStats stats;
+    stats.cacheSize = cacheSize;
+    stats.shaded = misses;
+    stats.acmr = indexCount > 0 ? static_cast<double>(misses) / static_cast<double>(indexCount / 3) : 0.0;
+    stats.atvr = used > 0 ? static_cast<double>(misses) / static_cast<double>(used) : 0.0;
+    return stats;
+}
+
+void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+    checkIndices(indices, indexCount, vertexCount);
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // треугольники каждой вершины: adjacency[adjacencyOffset[v] .. adjacencyOffset[v + 1])
+    std::vector<uint32_t> live(vertexCount, 0);
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        live[indices[i]]++;
+    }
+    std::vector<size_t> adjacencyOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + live[v];
+    }
+    std::vector<uint32_t> adjacency(indexCount);
+    {
+        std::vector<size_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<uint32_t> output;
+    output.reserve(indexCount);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<size_t> cacheTime(vertexCount, 0);
+    std::vector<uint32_t> deadEnd;     // недавно использованные вершины - кандидаты, когда у веера нет соседей
+    std::vector<uint32_t> candidates;
+    size_t timestamp = cacheSize + 1;  // вершина в кэше, если timestamp - cacheTime <= cacheSize
+    size_t cursor = 0;                 // последовательный поиск, когда и deadEnd пуст
+
+    auto skipDeadEnd = [&]() -> int64_t {
+        while (!deadEnd.empty())
+        {
+            uint32_t v = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[v] > 0)
+            {
+                return v;
+            }
+        }
+        for (; cursor < vertexCount; cursor++)
+        {
+            if (live[cursor] > 0)
+            {
+                return static_cast<int64_t>(cursor);
+            }
+        }
+        return -1;
+    };
+
+    int64_t fan = skipDeadEnd();
+    while (fan >= 0)
+    {
+        candidates.clear();
+        for (size_t a = adjacencyOffset[fan]; a < adjacencyOffset[fan + 1]; a++)
+        {
+            uint32_t triangle = adjacency[a];
+            if (emitted[triangle])
+            {
+                continue;
+            }
+            for (size_t corner = 0; corner < 3; corner++)
+            {
+                uint32_t v = indices[triangle * 3 + corner];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (timestamp - cacheTime[v] > cacheSize)
+                {
+                    cacheTime[v] = timestamp++;
+                }
+            }
+            emitted[triangle] = true;
+        }
+
+        // следующий центр веера - вершина, которая останется в кэше, пока мы обойдем все ее треугольники;
+        // из таких - самая старая в кэше (ее раньше всех вытеснят)
+        int64_t next = -1;
+        int64_t bestPriority = -1;
+        for (uint32_t v : candidates)
+        {
+            if (live[v] == 0)
+            {
+                continue;
+            }
+            int64_t priority = 0;
+            if (timestamp - cacheTime[v] + 2 * live[v] <= cacheSize)
+            {
+                priority = static_cast<int64_t>(timestamp - cacheTime[v]);
+            }
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                next = v;
+            }
+        }
+        fan = next >= 0 ? next : skipDeadEnd();
+    }
+
+    std::memcpy(indices, output.data(), indexCount * sizeof(uint32_t));
+}
+
+size_t optimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexStride, uint32_t* indices, size_t indexCount)
+{
+    checkIndices(indices, indexCount, vertexCount);
+
+    const uint32_t UNASSIGNED = UINT32_MAX;
+    std::vector<uint32_t> remap(vertexCount, UNASSIGNED);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        uint32_t& target = remap[indices[i]];
+        if (target == UNASSIGNED)
+        {
+            target = next++;
+        }
+        indices[i] = target;
+    }
+
+    auto* bytes = static_cast<uint8_t*>(vertices);
+    std::vector<uint8_t> reordered(static_cast<size_t>(next) * vertexStride);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        if (remap[v] != UNASSIGNED)
+        {
+            std::memcpy(reordered.data() + remap[v] * vertexStride, bytes + v * vertexStride, vertexStride);
+        }
+    }
+    std::memcpy(bytes, reordered.data(), reordered.size());
+    return next;
+}
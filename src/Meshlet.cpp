@@ -0,0 +1,291 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "Meshlet.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESHLET_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// конус шире ~84 градусов почти никогда не отсекается, а проверка стоит как у узкого
+const float MIN_CONE_COS = 0.1f;
+
+uint32_t readIndex(const void* indices, uint32_t indexSize, size_t i)
+{
+    return indexSize == 2 ? static_cast<const uint16_t*>(indices)[i] : static_cast<const uint32_t*>(indices)[i];
+}
+
+void computeBounds(Meshlet& meshlet, const void* indices, uint32_t indexSize, const Vertex* vertices)
+{
+    size_t begin = meshlet.firstIndex;
+    size_t end = begin + meshlet.indexCount;
+
+    // сфера: центр AABB кластера и самая дальняя вершина
+    glm::vec3 lo = vertices[readIndex(indices, indexSize, begin)].pos;
+    glm::vec3 hi = lo;
+    for (size_t i = begin; i < end; i++)
+    {
+        const glm::vec3& p = vertices[readIndex(indices, indexSize, i)].pos;
+        lo = glm::min(lo, p);
+        hi = glm::max(hi, p);
+    }
+    glm::vec3 center = (lo + hi) * 0.5f;
+    float radius = 0.0f;
+    for (size_t i = begin; i < end; i++)
+    {
+        radius = std::max(radius, glm::length(vertices[readIndex(indices, indexSize, i)].pos - center));
+    }
+    meshlet.boundingSphere = glm::vec4(center, radius);
+
+    // конус: средняя нормаль и самое большое отклонение от нее. Лицевая сторона - против часовой стрелки
+    std::vector<glm::vec3> normals;
+    normals.reserve(meshlet.indexCount / 3);
+    glm::vec3 sum(0.0f);
+    for (size_t i = begin; i < end; i += 3)
+    {
+        const glm::vec3& a = vertices[readIndex(indices, indexSize, i)].pos;
+        const glm::vec3& b = vertices[readIndex(indices, indexSize, i + 1)].pos;
+        const glm::vec3& c = vertices[readIndex(indices, indexSize, i + 2)].pos;
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        float length = glm::length(normal);
+        if (length > 0.0f)
+        {
+            normals.push_back(normal / length);
+            sum += normals.back();
+        }
+    }
+
+    meshlet.cone = glm::vec4(0.0f, 0.0f, 1.0f, -1.0f);
+    float sumLength = glm::length(sum);
+    if (normals.empty() || sumLength <= 0.0f)
+    {
+        return;
+    }
+    glm::vec3 axis = sum / sumLength;
+    float minCos = 1.0f;
+    for (const glm::vec3& normal : normals)
+    {
+        minCos = std::min(minCos, glm::dot(axis, normal));
+    }
+    meshlet.cone = glm::vec4(axis, minCos >= MIN_CONE_COS ? minCos : -1.0f);
+}
+
+} // namespace
+
+std::vector<Meshlet> buildMeshlets(const void* indices, uint32_t indexSize, size_t indexCount,
+                                   const Vertex* vertices, size_t vertexCount)
+{
+    std::vector<Meshlet> meshlets;
+    std::vector<uint32_t> lastMeshlet(vertexCount, UINT32_MAX); // в каком кластере вершина встречалась последней
+
+    Meshlet current{};
+    auto finish = [&]() {
+        if (current.indexCount > 0)
+        {
+            computeBounds(current, indices, indexSize, vertices);
+            meshlets.push_back(current);
+        }
+        current = Meshlet{};
+    };
+
+    for (size_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        uint32_t meshletId = static_cast<uint32_t>(meshlets.size());
+        uint32_t corners[3] = {readIndex(indices, indexSize, i), readIndex(indices, indexSize, i + 1), readIndex(indices, indexSize, i + 2)};
+        // индексы из файла не проверены: дальше ими индексируются lastMeshlet и vertices (и в computeBounds)
+        for (uint32_t corner : corners)
+        {
+            if (corner >= vertexCount)
+            {
+                throw std::runtime_error("mesh index " + std::to_string(corner) + " is out of range (" + std::to_string(vertexCount) + " vertices)");
+            }
+        }
+
+        uint32_t added = 0;
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            // повтор вершины внутри треугольника считается один раз
+            bool repeated = (c > 0 && corners[c] == corners[0]) || (c > 1 && corners[c] == corners[1]);
+            added += (lastMeshlet[corners[c]] != meshletId && !repeated) ? 1 : 0;
+        }
+
+        if (current.vertexCount + added > MESHLET_MAX_VERTICES || current.indexCount / 3 + 1 > MESHLET_MAX_TRIANGLES)
+        {
+            finish();
+            current.firstIndex = static_cast<uint32_t>(i);
+            meshletId++;
+            added = 0;
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                bool repeated = (c > 0 && corners[c] == corners[0]) || (c > 1 && corners[c] == corners[1]);
+                added += repeated ? 0 : 1;
+            }
+        }
+        else if (current.indexCount == 0)
+        {
+            current.firstIndex = static_cast<uint32_t>(i);
+        }
+
+        for (uint32_t corner : corners)
+        {
+            lastMeshlet[corner] = meshletId;
+        }
+        current.vertexCount += added;
+        current.indexCount += 3;
+    }
+    finish();
+    return meshlets;
+}
+
+void MeshletCuller::init(const std::vector<Meshlet>& meshlets)
+{
+    size_t padded = (meshlets.size() + 3) / 4 * 4;
+    for (auto* array : {&centerX, &centerY, &centerZ, &radius, &axisX, &axisY, &axisZ, &coneCos, &coneSin})
+    {
+        array->assign(padded, 0.0f);
+    }
+    firstIndex.resize(meshlets.size());
+    indexCount.resize(meshlets.size());
+
+    for (size_t i = 0; i < meshlets.size(); i++)
+    {
+        const Meshlet& meshlet = meshlets[i];
+        centerX[i] = meshlet.boundingSphere.x;
+        centerY[i] = meshlet.boundingSphere.y;
+        centerZ[i] = meshlet.boundingSphere.z;
+        radius[i] = meshlet.boundingSphere.w;
+        axisX[i] = meshlet.cone.x;
+        axisY[i] = meshlet.cone.y;
+        axisZ[i] = meshlet.cone.z;
+        coneCos[i] = meshlet.cone.w;
+        coneSin[i] = meshlet.cone.w > 0.0f ? std::sqrt(1.0f - meshlet.cone.w * meshlet.cone.w) : 0.0f;
+        firstIndex[i] = meshlet.firstIndex;
+        indexCount[i] = meshlet.indexCount;
+    }
+}
+
+size_t MeshletCuller::cull(const glm::vec4 planes[6], const glm::vec3& camera, std::vector<MeshletDraw>& out, bool allowSimd) const
+{
+    const size_t CHUNK = 256; // кратно 4; видимость куска - на стеке, без выделений и общих буферов между потоками
+    uint8_t visible[CHUNK];
+    size_t visibleCount = 0;
+    bool open = false; // последний draw в out можно продолжить следующим кластером
+
+    for (size_t begin = 0; begin < size(); begin += CHUNK)
+    {
+        size_t end = std::min(begin + CHUNK, size());
+#ifdef MESHLET_SSE2
+        if (allowSimd)
+        {
+            cullSse2(planes, camera, begin, end, visible);
+        }
+        else
+#endif
+        {
+            cullScalar(planes, camera, begin, end, visible);
+        }
+
+        for (size_t i = begin; i < end; i++)
+        {
+            if (!visible[i - begin])
+            {
+                open = false;
+                continue;
+            }
+            visibleCount++;
+            if (open && out.back().firstIndex + out.back().indexCount == firstIndex[i])
+            {
+                out.back().indexCount += indexCount[i];
+            }
+            else
+            {
+                out.push_back({firstIndex[i], indexCount[i]});
+                open = true;
+            }
+        }
+    }
+    return visibleCount;
+}
+
+// Для всех нормалей n конуса (ось a, половина угла t) и точек p сферы (c, r) нужно dot(n, p - camera) >= 0.
+// Хватает L * cos(phi + t) >= r, где v = c - camera, L = |v|, phi - угол между v и a:
+// dot(v, a) * cos t - sqrt(L^2 - dot(v, a)^2) * sin t >= r
+void MeshletCuller::cullScalar(const glm::vec4 planes[6], const glm::vec3& camera, size_t begin, size_t end, uint8_t* visible) const
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        glm::vec3 center(centerX[i], centerY[i], centerZ[i]);
+        bool inside = true;
+        for (int p = 0; p < 6; p++)
+        {
+            inside = inside && glm::dot(glm::vec3(planes[p]), center) + planes[p].w >= -radius[i];
+        }
+
+        glm::vec3 v = center - camera;
+        float along = glm::dot(v, glm::vec3(axisX[i], axisY[i], axisZ[i]));
+        float across = std::sqrt(std::max(glm::dot(v, v) - along * along, 0.0f));
+        bool backFacing = coneCos[i] > 0.0f && along * coneCos[i] - across * coneSin[i] >= radius[i];
+
+        visible[i - begin] = inside && !backFacing;
+    }
+}
+
+#ifdef MESHLET_SSE2
+void MeshletCuller::cullSse2(const glm::vec4 planes[6], const glm::vec3& camera, size_t begin, size_t end, uint8_t* visible) const
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 cameraX = _mm_set1_ps(camera.x);
+    const __m128 cameraY = _mm_set1_ps(camera.y);
+    const __m128 cameraZ = _mm_set1_ps(camera.z);
+
+    for (size_t i = begin; i < end; i += 4)
+    {
+        __m128 cx = _mm_loadu_ps(&centerX[i]);
+        __m128 cy = _mm_loadu_ps(&centerY[i]);
+        __m128 cz = _mm_loadu_ps(&centerZ[i]);
+        __m128 r = _mm_loadu_ps(&radius[i]);
+        __m128 negR = _mm_sub_ps(zero, r);
+
+        // 6 плоскостей: dot(plane.xyz, c) + plane.w >= -r
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(planes[p].x)), _mm_mul_ps(cy, _mm_set1_ps(planes[p].y))),
+                                         _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(planes[p].z)), _mm_set1_ps(planes[p].w)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negR));
+        }
+
+        // конус нормалей, как в cullScalar()
+        __m128 vx = _mm_sub_ps(cx, cameraX);
+        __m128 vy = _mm_sub_ps(cy, cameraY);
+        __m128 vz = _mm_sub_ps(cz, cameraZ);
+        __m128 along = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, _mm_loadu_ps(&axisX[i])), _mm_mul_ps(vy, _mm_loadu_ps(&axisY[i]))),
+                                  _mm_mul_ps(vz, _mm_loadu_ps(&axisZ[i])));
+        __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+        __m128 across = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(lengthSquared, _mm_mul_ps(along, along)), zero));
+        __m128 cosine = _mm_loadu_ps(&coneCos[i]);
+        __m128 facing = _mm_sub_ps(_mm_mul_ps(along, cosine), _mm_mul_ps(across, _mm_loadu_ps(&coneSin[i])));
+        __m128 backFacing = _mm_and_ps(_mm_cmpgt_ps(cosine, zero), _mm_cmpge_ps(facing, r));
+
+        int mask = _mm_movemask_ps(_mm_andnot_ps(backFacing, inside));
+        for (size_t lane = 0; lane < 4 && i + lane < end; lane++)
+        {
+            visible[i + lane - begin] = static_cast<uint8_t>((mask >> lane) & 1);
+        }
+    }
+}
+#else
+void MeshletCuller::cullSse2(const glm::vec4 planes[6], const glm::vec3& camera, size_t begin, size_t end, uint8_t* visible) const
+{
+    cullScalar(planes, camera, begin, end, visible);
+}
+#endif
@@ -0,0 +1,297 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "PipelineCache.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+// свой заголовок перед данными драйвера: драйвер не обязан проверять, что блоб не обрезан и не испорчен
+struct CacheFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t dataSize;
+    uint64_t checksum;
+};
+
+const uint32_t CACHE_FILE_MAGIC = 0x43504B56; // "VKPC"
+const uint32_t CACHE_FILE_VERSION = 1;
+
+uint64_t fnv1a(const char* data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+void PipelineCache::init(VkDevice device, const DeviceCaps& caps, const std::string& path, bool creationFeedback)
+{
+    this->device = device;
+    this->path = path;
+    this->creationFeedback = creationFeedback;
+    deviceProperties = caps.properties;
+
+    std::vector<char> file;
+    if (!path.empty())
+    {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (in.is_open())
+        {
+            file.resize(static_cast<size_t>(in.tellg()));
+            in.seekg(0);
+            in.read(file.data(), static_cast<std::streamsize>(file.size()));
+            if (!in)
+            {
+                file.clear();
+                counters.rejectReason = "read error";
+            }
+        }
+    }
+
+    size_t dataOffset = 0;
+    size_t dataSize = 0;
+    bool valid = !file.empty() && validate(file, dataOffset, dataSize);
+
+    VkPipelineCacheCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    if (valid)
+    {
+        createInfo.initialDataSize = dataSize;
+        createInfo.pInitialData = file.data() + dataOffset;
+    }
+
+    VkResult result = vkCreatePipelineCache(device, &createInfo, nullptr, &cache);
+    if (result != VK_SUCCESS && valid)
+    {
+        // драйвер все-таки отказался от данных - начинаем с пустого кэша
+        counters.rejectReason = "rejected by driver";
+        valid = false;
+        createInfo.initialDataSize = 0;
+        createInfo.pInitialData = nullptr;
+        result = vkCreatePipelineCache(device, &createInfo, nullptr, &cache);
+    }
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create pipeline cache!");
+    }
+
+    counters.loadedBytes = valid ? dataSize : 0;
+}
+
+void PipelineCache::destroy()
+{
+    if (cache != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineCache(device, cache, nullptr);
+        cache = VK_NULL_HANDLE;
+    }
+}
+
+void PipelineCache::save()
+{
+    if (path.empty() || cache == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(device, cache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+    {
+        return;
+    }
+    std::vector<char> data(dataSize);
+    if (vkGetPipelineCacheData(device, cache, &dataSize, data.data()) != VK_SUCCESS)
+    {
+        return;
+    }
+
+    CacheFileHeader header{};
+    header.magic = CACHE_FILE_MAGIC;
+    header.version = CACHE_FILE_VERSION;
+    header.dataSize = dataSize;
+    header.checksum = fnv1a(data.data(), dataSize);
+
+    // сохранение вызывается из cleanup(): ошибка записи не должна ронять завершение, только предупреждение
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(data.data(), static_cast<std::streamsize>(dataSize));
+        out.close();
+        if (!out)
+        {
+            std::cerr << "failed to write pipeline cache " << tempPath << std::endl;
+            std::error_code ignored;
+            std::filesystem::remove(tempPath, ignored);
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error)
+    {
+        std::cerr << "failed to replace pipeline cache " << path << ": " << error.message() << std::endl;
+        std::filesystem::remove(tempPath, error);
+    }
+}
+
+VkResult PipelineCache::createGraphicsPipeline(const VkGraphicsPipelineCreateInfo& createInfo, VkPipeline& pipeline)
+{
+    return createPipeline(createInfo, pipeline, [this](const VkGraphicsPipelineCreateInfo& info, VkPipeline& result) {
+        return vkCreateGraphicsPipelines(device, cache, 1, &info, nullptr, &result);
+    });
+}
+
+VkResult PipelineCache::createComputePipeline(const VkComputePipelineCreateInfo& createInfo, VkPipeline& pipeline)
+{
+    return createPipeline(createInfo, pipeline, [this](const VkComputePipelineCreateInfo& info, VkPipeline& result) {
+        return vkCreateComputePipelines(device, cache, 1, &info, nullptr, &result);
+    });
+}
+
+// общая часть: feedback в цепочку pNext, замер времени, подсчет попаданий
+template <typename CreateInfo, typename CreateFunction>
+VkResult PipelineCache::createPipeline(const CreateInfo& createInfo, VkPipeline& pipeline, CreateFunction create)
+{
+    CreateInfo info = createInfo;
+
+    VkPipelineCreationFeedbackEXT pipelineFeedback{};
+    VkPipelineCreationFeedbackCreateInfoEXT feedbackInfo{};
+    if (creationFeedback)
+    {
+        feedbackInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+        feedbackInfo.pNext = info.pNext;
+        feedbackInfo.pPipelineCreationFeedback = &pipelineFeedback;
+        info.pNext = &feedbackInfo;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    VkResult result = create(info, pipeline);
+    double compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    counters.compileMs += compileMs;
+
+    if (result == VK_SUCCESS)
+    {
+        counters.pipelines++;
+        if (pipelineFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT)
+        {
+            if (pipelineFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT)
+            {
+                counters.hits++;
+            }
+            else
+            {
+                counters.misses++;
+            }
+        }
+    }
+    return result;
+}
+
+PipelineCacheStats PipelineCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+void PipelineCache::printStats(std::ostream& out) const
+{
+    PipelineCacheStats counters = stats();
+
+    out << "pipeline cache: ";
+    if (counters.loadedBytes > 0)
+    {
+        out << "loaded " << counters.loadedBytes << " bytes";
+    }
+    else if (!counters.rejectReason.empty())
+    {
+        out << "discarded (" << counters.rejectReason << ")";
+    }
+    else
+    {
+        out << "cold";
+    }
+
+    out << ", " << counters.pipelines << " pipelines in " << counters.compileMs << " ms";
+    if (counters.hits + counters.misses > 0)
+    {
+        out << ", hits " << counters.hits << ", misses " << counters.misses;
+    }
+    else
+    {
+        out << ", hits/misses unknown (no " << VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME << ")";
+    }
+    out << std::endl;
+}
+
+bool PipelineCache::validate(const std::vector<char>& file, size_t& dataOffset, size_t& dataSize)
+{
+    CacheFileHeader header{};
+    if (file.size() < sizeof(header))
+    {
+        counters.rejectReason = "truncated";
+        return false;
+    }
+    memcpy(&header, file.data(), sizeof(header));
+
+    if (header.magic != CACHE_FILE_MAGIC || header.version != CACHE_FILE_VERSION)
+    {
+        counters.rejectReason = "unknown format";
+        return false;
+    }
+    if (header.dataSize != file.size() - sizeof(header))
+    {
+        counters.rejectReason = "truncated";
+        return false;
+    }
+    if (header.checksum != fnv1a(file.data() + sizeof(header), static_cast<size_t>(header.dataSize)))
+    {
+        counters.rejectReason = "checksum mismatch";
+        return false;
+    }
+
+    // заголовок самого Vulkan: данные другого GPU или другой версии драйвера бесполезны, а некоторые драйверы на них падают
+    VkPipelineCacheHeaderVersionOne vkHeader{};
+    if (header.dataSize < sizeof(vkHeader))
+    {
+        counters.rejectReason = "truncated";
+        return false;
+    }
+    memcpy(&vkHeader, file.data() + sizeof(header), sizeof(vkHeader));
+
+    if (vkHeader.headerSize < sizeof(vkHeader) || vkHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+    {
+        counters.rejectReason = "unknown header version";
+        return false;
+    }
+    if (vkHeader.vendorID != deviceProperties.vendorID || vkHeader.deviceID != deviceProperties.deviceID)
+    {
+        counters.rejectReason = "different device";
+        return false;
+    }
+    if (memcmp(vkHeader.pipelineCacheUUID, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+    {
+        counters.rejectReason = "different driver";
+        return false;
+    }
+
+    dataOffset = sizeof(header);
+    dataSize = static_cast<size_t>(header.dataSize);
+    return true;
+}
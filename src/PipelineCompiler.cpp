@@ -0,0 +1,231 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "PipelineCompiler.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+template <typename T>
+std::vector<T> copyArray(const T* data, uint32_t count)
+{
+    return data != nullptr ? std::vector<T>(data, data + count) : std::vector<T>();
+}
+
+} // namespace
+
+GraphicsPipelineDesc::GraphicsPipelineDesc(const VkGraphicsPipelineCreateInfo& createInfo) : info(createInfo)
+{
+    if (createInfo.pNext != nullptr)
+    {
+        throw std::runtime_error("background pipeline compilation does not support pNext chains");
+    }
+
+    stages = copyArray(createInfo.pStages, createInfo.stageCount);
+    for (const auto& stage : stages)
+    {
+        if (stage.pSpecializationInfo != nullptr)
+        {
+            throw std::runtime_error("background pipeline compilation does not support specialization constants");
+        }
+    }
+
+    if (createInfo.pVertexInputState != nullptr)
+    {
+        vertexInput = *createInfo.pVertexInputState;
+        vertexBindings = copyArray(vertexInput.pVertexBindingDescriptions, vertexInput.vertexBindingDescriptionCount);
+        vertexAttributes = copyArray(vertexInput.pVertexAttributeDescriptions, vertexInput.vertexAttributeDescriptionCount);
+    }
+    if (createInfo.pInputAssemblyState != nullptr)
+    {
+        inputAssembly = *createInfo.pInputAssemblyState;
+    }
+    if (createInfo.pViewportState != nullptr)
+    {
+        viewportState = *createInfo.pViewportState;
+        viewports = copyArray(viewportState.pViewports, viewportState.viewportCount);
+        scissors = copyArray(viewportState.pScissors, viewportState.scissorCount);
+    }
+    if (createInfo.pRasterizationState != nullptr)
+    {
+        rasterizer = *createInfo.pRasterizationState;
+    }
+    if (createInfo.pMultisampleState != nullptr)
+    {
+        multisampling = *createInfo.pMultisampleState;
+        multisampling.pSampleMask = nullptr; // маски выборок проект не использует
+    }
+    if (createInfo.pDepthStencilState != nullptr)
+    {
+        hasDepthStencil = true;
+        depthStencil = *createInfo.pDepthStencilState;
+    }
+    if (createInfo.pColorBlendState != nullptr)
+    {
+        colorBlending = *createInfo.pColorBlendState;
+        colorBlendAttachments = copyArray(colorBlending.pAttachments, colorBlending.attachmentCount);
+    }
+    if (createInfo.pDynamicState != nullptr)
+    {
+        dynamicState = *createInfo.pDynamicState;
+        dynamicStates = copyArray(dynamicState.pDynamicStates, dynamicState.dynamicStateCount);
+    }
+}
+
+VkGraphicsPipelineCreateInfo GraphicsPipelineDesc::createInfo()
+{
+    vertexInput.pVertexBindingDescriptions = vertexBindings.data();
+    vertexInput.pVertexAttributeDescriptions = vertexAttributes.data();
+    viewportState.pViewports = viewports.empty() ? nullptr : viewports.data(); // пустой - viewport динамический
+    viewportState.pScissors = scissors.empty() ? nullptr : scissors.data();
+    colorBlending.pAttachments = colorBlendAttachments.data();
+    dynamicState.pDynamicStates = dynamicStates.data();
+
+    VkGraphicsPipelineCreateInfo result = info;
+    result.pStages = stages.data();
+    result.pVertexInputState = info.pVertexInputState != nullptr ? &vertexInput : nullptr;
+    result.pInputAssemblyState = info.pInputAssemblyState != nullptr ? &inputAssembly : nullptr;
+    result.pViewportState = info.pViewportState != nullptr ? &viewportState : nullptr;
+    result.pRasterizationState = info.pRasterizationState != nullptr ? &rasterizer : nullptr;
+    result.pMultisampleState = info.pMultisampleState != nullptr ? &multisampling : nullptr;
+    result.pDepthStencilState = hasDepthStencil ? &depthStencil : nullptr;
+    result.pColorBlendState = info.pColorBlendState != nullptr ? &colorBlending : nullptr;
+    result.pDynamicState = info.pDynamicState != nullptr ? &dynamicState : nullptr;
+    return result;
+}
+
+void PipelineCompiler::init(VkDevice device, PipelineCache& cache, uint32_t threadCount)
+{
+    this->device = device;
+    this->cache = &cache;
+    if (threadCount > 0)
+    {
+        pool = std::make_unique<ThreadPool>(threadCount);
+    }
+}
+
+void PipelineCompiler::destroy()
+{
+    // пул завершает всю очередь перед тем, как потоки выйдут
+    pool.reset();
+
+    for (auto& entry : entries)
+    {
+        if (entry.pipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(device, entry.pipeline, nullptr);
+        }
+    }
+    entries.clear();
+    pending = 0;
+}
+
+PipelineHandle PipelineCompiler::compileGraphics(const std::string& name, const VkGraphicsPipelineCreateInfo& createInfo)
+{
+    auto desc = std::make_unique<GraphicsPipelineDesc>(createInfo);
+
+    PipelineHandle handle;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        handle = static_cast<PipelineHandle>(entries.size());
+        entries.emplace_back();
+        entries.back().name = name;
+        entries.back().desc = std::move(desc);
+        entries.back().requested = Clock::now();
+        pending++;
+    }
+
+    if (pool != nullptr)
+    {
+        pool->submit([this, handle]() { compile(handle); });
+    }
+    else
+    {
+        compile(handle);
+    }
+    return handle;
+}
+
+void PipelineCompiler::compile(PipelineHandle handle)
+{
+    Entry* entry;
+    {
+        // сам deque может расти из другого потока, но элементы при этом не перемещаются
+        std::lock_guard<std::mutex> lock(mutex);
+        entry = &entries[handle];
+    }
+
+    VkGraphicsPipelineCreateInfo createInfo = entry->desc->createInfo();
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult result = cache->createGraphicsPipeline(createInfo, pipeline);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entry->pipeline = pipeline;
+        entry->result = result;
+        entry->status = result == VK_SUCCESS ? PipelineStatus::Ready : PipelineStatus::Failed;
+        entry->readyMs = std::chrono::duration<double, std::milli>(Clock::now() - entry->requested).count();
+        entry->desc.reset();
+        pending--;
+    }
+    compiled.notify_all();
+}
+
+PipelineStatus PipelineCompiler::status(PipelineHandle handle) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.at(handle).status;
+}
+
+VkPipeline PipelineCompiler::get(PipelineHandle handle) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const Entry& entry = entries.at(handle);
+    if (entry.status == PipelineStatus::Failed)
+    {
+        throw std::runtime_error("failed to create pipeline " + entry.name + " (VkResult " + std::to_string(entry.result) + ")");
+    }
+    return entry.pipeline;
+}
+
+VkPipeline PipelineCompiler::wait(PipelineHandle handle)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        compiled.wait(lock, [&]() { return entries.at(handle).status != PipelineStatus::Pending; });
+    }
+    return get(handle);
+}
+
+void PipelineCompiler::waitAll()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    compiled.wait(lock, [this]() { return pending == 0; });
+}
+
+uint32_t PipelineCompiler::pendingCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending;
+}
+
+void PipelineCompiler::printStats(std::ostream& out) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint32_t failed = 0;
+    double longestMs = 0.0;
+    for (const auto& entry : entries)
+    {
+        failed += entry.status == PipelineStatus::Failed ? 1 : 0;
+        longestMs = std::max(longestMs, entry.readyMs);
+    }
+
+    out << "pipeline compiler: " << entries.size() << " pipelines on "
+        << (pool != nullptr ? std::to_string(pool->size()) + " threads" : std::string("the calling thread"))
+        << ", " << pending << " pending, " << failed << " failed, longest request-to-ready " << longestMs << " ms" << std::endl;
+}
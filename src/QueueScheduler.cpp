@@ -0,0 +1,113 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "QueueScheduler.h"
+
+#include <stdexcept>
+
+void QueueScheduler::init(VkDevice device, uint32_t graphicsFamily, std::optional<uint32_t> computeFamily,
+                          std::optional<uint32_t> transferFamily)
+{
+    auto setup = [&](QueueKind kind, uint32_t family) {
+        Lane& lane = lanes[static_cast<size_t>(kind)];
+        lane.family = family;
+        vkGetDeviceQueue(device, family, 0, &lane.queue);
+        lane.timeline.init(device);
+        lane.active = true;
+    };
+
+    setup(QueueKind::Graphics, graphicsFamily);
+    if (computeFamily.has_value() && computeFamily.value() != graphicsFamily)
+    {
+        setup(QueueKind::Compute, computeFamily.value());
+    }
+    if (transferFamily.has_value() && transferFamily.value() != graphicsFamily)
+    {
+        setup(QueueKind::Transfer, transferFamily.value());
+    }
+}
+
+void QueueScheduler::destroy()
+{
+    for (auto& lane : lanes)
+    {
+        if (lane.active)
+        {
+            lane.timeline.destroy();
+            lane.active = false;
+        }
+    }
+}
+
+size_t QueueScheduler::lane(QueueKind kind) const
+{
+    size_t index = static_cast<size_t>(kind);
+    return lanes[index].active ? index : static_cast<size_t>(QueueKind::Graphics);
+}
+
+std::vector<uint32_t> QueueScheduler::uniqueFamilies() const
+{
+    std::vector<uint32_t> families;
+    for (const auto& lane : lanes)
+    {
+        if (lane.active)
+        {
+            families.push_back(lane.family);
+        }
+    }
+    return families;
+}
+
+uint64_t QueueScheduler::submit(QueueKind kind, const QueueSubmit& batch)
+{
+    Lane& target = lanes[lane(kind)];
+
+    // binary семафоры первыми, значения для них игнорируются, но массивы одной длины с семафорами
+    std::vector<VkSemaphore> waitSemaphores = batch.waitSemaphores;
+    std::vector<VkPipelineStageFlags> waitStages = batch.waitStages;
+    std::vector<uint64_t> waitValues(waitSemaphores.size(), 0);
+
+    for (const auto& wait : batch.timelineWaits)
+    {
+        // своя очередь исполняет submit по порядку - ждать собственный timeline незачем
+        if (wait.value == 0 || lane(wait.queue) == lane(kind))
+        {
+            continue;
+        }
+        waitSemaphores.push_back(lanes[lane(wait.queue)].timeline.handle());
+        waitStages.push_back(wait.stages);
+        waitValues.push_back(wait.value);
+    }
+
+    std::vector<VkSemaphore> signalSemaphores = batch.signalSemaphores;
+    std::vector<uint64_t> signalValues(signalSemaphores.size(), 0);
+
+    uint64_t value = target.timeline.next();
+    signalSemaphores.push_back(target.timeline.handle());
+    signalValues.push_back(value);
+
+    VkTimelineSemaphoreSubmitInfoKHR timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+    timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+    timelineInfo.pWaitSemaphoreValues = waitValues.data();
+    timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
+    timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = waitStages.data();
+    submitInfo.commandBufferCount = static_cast<uint32_t>(batch.commandBuffers.size());
+    submitInfo.pCommandBuffers = batch.commandBuffers.data();
+    submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+    submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+    if (vkQueueSubmit(target.queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to submit to queue!");
+    }
+    return value;
+}
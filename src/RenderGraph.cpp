@@ -0,0 +1,1155 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// доступы, которые что-то пишут: только их нужно делать доступными следующему проходу
+const VkAccessFlags WRITE_ACCESS = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+                                   | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT
+                                   | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+VkImageAspectFlags aspectOf(VkFormat format)
+{
+    switch (format)
+    {
+        case VK_FORMAT_D16_UNORM:
+        case VK_FORMAT_X8_D24_UNORM_PACK32:
+        case VK_FORMAT_D32_SFLOAT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT;
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        default:
+            return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+struct FlagName {
+    uint32_t flag;
+    const char* name;
+};
+
+const FlagName STAGE_NAMES[] = {
+    {VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, "TOP_OF_PIPE"},
+    {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, "DRAW_INDIRECT"},
+    {VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, "VERTEX_INPUT"},
+    {VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, "VERTEX_SHADER"},
+    {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, "FRAGMENT_SHADER"},
+    {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT, "EARLY_FRAGMENT_TESTS"},
+    {VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, "LATE_FRAGMENT_TESTS"},
+    {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, "COLOR_ATTACHMENT_OUTPUT"},
+    {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, "COMPUTE_SHADER"},
+    {VK_PIPELINE_STAGE_TRANSFER_BIT, "TRANSFER"},
+    {VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, "BOTTOM_OF_PIPE"},
+    {VK_PIPELINE_STAGE_HOST_BIT, "HOST"},
+    {VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, "ALL_GRAPHICS"},
+    {VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, "ALL_COMMANDS"},
+};
+
+const FlagName ACCESS_NAMES[] = {
+    {VK_ACCESS_INDIRECT_COMMAND_READ_BIT, "INDIRECT_COMMAND_READ"},
+    {VK_ACCESS_INDEX_READ_BIT, "INDEX_READ"},
+    {VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, "VERTEX_ATTRIBUTE_READ"},
+    {VK_ACCESS_UNIFORM_READ_BIT, "UNIFORM_READ"},
+    {VK_ACCESS_SHADER_READ_BIT, "SHADER_READ"},
+    {VK_ACCESS_SHADER_WRITE_BIT, "SHADER_WRITE"},
+    {VK_ACCESS_COLOR_ATTACHMENT_READ_BIT, "COLOR_ATTACHMENT_READ"},
+    {VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, "COLOR_ATTACHMENT_WRITE"},
+    {VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, "DEPTH_STENCIL_ATTACHMENT_READ"},
+    {VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, "DEPTH_STENCIL_ATTACHMENT_WRITE"},
+    {VK_ACCESS_TRANSFER_READ_BIT, "TRANSFER_READ"},
+    {VK_ACCESS_TRANSFER_WRITE_BIT, "TRANSFER_WRITE"},
+    {VK_ACCESS_HOST_READ_BIT, "HOST_READ"},
+    {VK_ACCESS_HOST_WRITE_BIT, "HOST_WRITE"},
+    {VK_ACCESS_MEMORY_READ_BIT, "MEMORY_READ"},
+    {VK_ACCESS_MEMORY_WRITE_BIT, "MEMORY_WRITE"},
+};
+
+template <size_t N>
+std::string flagNames(uint32_t flags, const FlagName (&names)[N])
+{
+    if (flags == 0)
+    {
+        return "0";
+    }
+    std::string result;
+    for (const FlagName& name : names)
+    {
+        if (flags & name.flag)
+        {
+            result += (result.empty() ? "" : "|") + std::string(name.name);
+            flags &= ~name.flag;
+        }
+    }
+    if (flags != 0)
+    {
+        std::ostringstream rest;
+        rest << "0x" << std::hex << flags;
+        result += (result.empty() ? "" : "|") + rest.str();
+    }
+    return result;
+}
+
+const char* layoutName(VkImageLayout layout)
+{
+    switch (layout)
+    {
+        case VK_IMAGE_LAYOUT_UNDEFINED: return "UNDEFINED";
+        case VK_IMAGE_LAYOUT_GENERAL: return "GENERAL";
+        case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL: return "COLOR_ATTACHMENT_OPTIMAL";
+        case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL: return "DEPTH_STENCIL_ATTACHMENT_OPTIMAL";
+        case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL: return "SHADER_READ_ONLY_OPTIMAL";
+        case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL: return "TRANSFER_SRC_OPTIMAL";
+        case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL: return "TRANSFER_DST_OPTIMAL";
+        case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR: return "PRESENT_SRC_KHR";
+        default: return "OTHER";
+    }
+}
+
+double mebibytes(VkDeviceSize bytes)
+{
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+} // namespace
+
+RenderGraph::ResourceId RenderGraph::addResource(Resource resource)
+{
+    uint32_t index = static_cast<uint32_t>(resources.size());
+    resources.push_back(std::move(resource));
+    return newVersion(index, NONE);
+}
+
+RenderGraph::ResourceId RenderGraph::newVersion(uint32_t resource, PassId producer)
+{
+    ResourceId latest = resources[resource].latest;
+
+    Version version;
+    version.resource = resource;
+    version.number = latest == NONE ? 0 : versions[latest].number + 1;
+    version.producer = producer;
+
+    ResourceId id = static_cast<ResourceId>(versions.size());
+    versions.push_back(version);
+    resources[resource].latest = id;
+    return id;
+}
+
+RenderGraph::ResourceId RenderGraph::createImage(const std::string& name, const ImageDesc& desc)
+{
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    return addResource(std::move(resource));
+}
+
+RenderGraph::ResourceId RenderGraph::importImage(const std::string& name, const ImageDesc& desc, const ResourceState& initial, const ResourceState& final)
+{
+    Resource resource;
+    resource.name = name;
+    resource.imported = true;
+    resource.desc = desc;
+    resource.initial = initial;
+    resource.final = final;
+    return addResource(std::move(resource));
+}
+
+RenderGraph::ResourceId RenderGraph::importBuffer(const std::string& name, const ResourceState& initial)
+{
+    Resource resource;
+    resource.name = name;
+    resource.image = false;
+    resource.imported = true;
+    resource.initial = initial;
+    return addResource(std::move(resource));
+}
+
+RenderGraph::PassId RenderGraph::addPass(const std::string& name, PassKind kind, std::function<void(VkCommandBuffer)> execute)
+{
+    Pass pass;
+    pass.name = name;
+    pass.kind = kind;
+    pass.execute = std::move(execute);
+    passes.push_back(std::move(pass));
+    return static_cast<PassId>(passes.size() - 1);
+}
+
+void RenderGraph::keepAlive(PassId pass)
+{
+    passes[pass].keepAlive = true;
+}
+
+void RenderGraph::read(PassId pass, ResourceId version, const Access& access)
+{
+    Access entry = access;
+    entry.input = version;
+    entry.reads = true;
+    versions[version].readers.push_back(pass);
+    passes[pass].accesses.push_back(entry);
+}
+
+RenderGraph::ResourceId RenderGraph::write(PassId pass, ResourceId version, Access access)
+{
+    uint32_t resource = versions[version].resource;
+    if (resources[resource].latest != version)
+    {
+        // две записи поверх одной версии - порядок между ними не определен
+        throw std::runtime_error("render graph " + name + ": " + resources[resource].name + " is written from an outdated version");
+    }
+    if (access.reads)
+    {
+        versions[version].readers.push_back(pass);
+    }
+    access.input = version;
+    access.output = newVersion(resource, pass);
+    passes[pass].accesses.push_back(access);
+    return access.output;
+}
+
+RenderGraph::ResourceId RenderGraph::colorAttachment(PassId pass, ResourceId image, VkAttachmentLoadOp load, VkClearColorValue clear)
+{
+    uint32_t resource = versions[image].resource;
+    if (passes[pass].kind != PassKind::Raster || !resources[resource].image)
+    {
+        throw std::runtime_error("render graph " + name + ": color attachment " + resources[resource].name + " needs a raster pass and an image");
+    }
+
+    Access access;
+    access.stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    access.access = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | (load == VK_ATTACHMENT_LOAD_OP_LOAD ? VK_ACCESS_COLOR_ATTACHMENT_READ_BIT : 0);
+    access.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    access.reads = load == VK_ATTACHMENT_LOAD_OP_LOAD;
+    ResourceId output = write(pass, image, access);
+    resources[resource].usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+    Attachment attachment;
+    attachment.resource = resource;
+    attachment.output = output;
+    attachment.load = load;
+    attachment.clear.color = clear;
+    passes[pass].attachments.push_back(attachment);
+    return output;
+}
+
+RenderGraph::ResourceId RenderGraph::depthAttachment(PassId pass, ResourceId image, VkAttachmentLoadOp load, float clearDepth)
+{
+    uint32_t resource = versions[image].resource;
+    if (passes[pass].kind != PassKind::Raster || !resources[resource].image)
+    {
+        throw std::runtime_error("render graph " + name + ": depth attachment " + resources[resource].name + " needs a raster pass and an image");
+    }
+    for (const Attachment& attachment : passes[pass].attachments)
+    {
+        if (attachment.depth)
+        {
+            throw std::runtime_error("render graph " + name + ": pass " + passes[pass].name + " has two depth attachments");
+        }
+    }
+
+    Access access;
+    access.stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    access.access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | (load == VK_ATTACHMENT_LOAD_OP_LOAD ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT : 0);
+    access.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    access.reads = load == VK_ATTACHMENT_LOAD_OP_LOAD;
+    ResourceId output = write(pass, image, access);
+    resources[resource].usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+
+    Attachment attachment;
+    attachment.resource = resource;
+    attachment.output = output;
+    attachment.load = load;
+    attachment.clear.depthStencil = {clearDepth, 0};
+    attachment.depth = true;
+    passes[pass].attachments.push_back(attachment);
+    return output;
+}
+
+void RenderGraph::sampleImage(PassId pass, ResourceId image, VkPipelineStageFlags stages)
+{
+    Access access;
+    access.stages = stages;
+    access.access = VK_ACCESS_SHADER_READ_BIT;
+    access.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    read(pass, image, access);
+    resources[versions[image].resource].usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+}
+
+RenderGraph::ResourceId RenderGraph::storageImage(PassId pass, ResourceId image, VkPipelineStageFlags stages)
+{
+    Access access;
+    access.stages = stages;
+    access.access = VK_ACCESS_SHADER_WRITE_BIT;
+    access.layout = VK_IMAGE_LAYOUT_GENERAL;
+    ResourceId output = write(pass, image, access);
+    resources[versions[image].resource].usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+    return output;
+}
+
+void RenderGraph::readBuffer(PassId pass, ResourceId buffer, VkPipelineStageFlags stages, VkAccessFlags access)
+{
+    Access entry;
+    entry.stages = stages;
+    entry.access = access;
+    read(pass, buffer, entry);
+}
+
+RenderGraph::ResourceId RenderGraph::writeBuffer(PassId pass, ResourceId buffer, VkPipelineStageFlags stages, VkAccessFlags access)
+{
+    Access entry;
+    entry.stages = stages;
+    entry.access = access;
+    return write(pass, buffer, entry);
+}
+
+void RenderGraph::compile(VkDevice device, DeviceAllocator& allocator)
+{
+    this->device = device;
+    this->allocator = &allocator;
+
+    cullPasses();
+    sortPasses();
+    computeLifetimes();
+    createTransientImages();
+    aliasMemory();
+    buildBarriers();
+    createRenderPasses();
+}
+
+// Нужны проходы, от которых по цепочке чтений зависят результаты кадра (последние версии импортированных
+// ресурсов) или проходы keepAlive. Остальные пишут то, что никто не прочитает
+void RenderGraph::cullPasses()
+{
+    std::vector<uint8_t> needed(passes.size(), 0);
+    std::vector<PassId> stack;
+    auto need = [&](PassId pass) {
+        if (pass != NONE && !needed[pass])
+        {
+            needed[pass] = 1;
+            stack.push_back(pass);
+        }
+    };
+
+    for (PassId pass = 0; pass < passes.size(); pass++)
+    {
+        if (passes[pass].keepAlive)
+        {
+            need(pass);
+        }
+    }
+    for (const Resource& resource : resources)
+    {
+        if (resource.imported)
+        {
+            need(versions[resource.latest].producer);
+        }
+    }
+
+    while (!stack.empty())
+    {
+        PassId pass = stack.back();
+        stack.pop_back();
+        for (const Access& access : passes[pass].accesses)
+        {
+            if (access.reads)
+            {
+                need(versions[access.input].producer);
+            }
+        }
+    }
+
+    for (PassId pass = 0; pass < passes.size(); pass++)
+    {
+        passes[pass].culled = !needed[pass];
+    }
+}
+
+// Топологическая сортировка по версиям: чтение после записи, запись после записи и после чтений прошлой версии.
+// Из готовых проходов первым идет раньше добавленный - без зависимостей порядок остается порядком добавления
+void RenderGraph::sortPasses()
+{
+    std::vector<std::vector<PassId>> dependents(passes.size());
+    std::vector<uint32_t> pending(passes.size(), 0);
+    auto edge = [&](PassId from, PassId to) {
+        if (from == NONE || from == to || passes[from].culled)
+        {
+            return;
+        }
+        dependents[from].push_back(to);
+        pending[to]++;
+    };
+
+    uint32_t live = 0;
+    for (PassId pass = 0; pass < passes.size(); pass++)
+    {
+        if (passes[pass].culled)
+        {
+            continue;
+        }
+        live++;
+        for (const Access& access : passes[pass].accesses)
+        {
+            edge(versions[access.input].producer, pass);
+            if (access.output != NONE)
+            {
+                for (PassId reader : versions[access.input].readers)
+                {
+                    edge(reader, pass);
+                }
+            }
+        }
+    }
+
+    std::priority_queue<PassId, std::vector<PassId>, std::greater<PassId>> ready;
+    for (PassId pass = 0; pass < passes.size(); pass++)
+    {
+        if (!passes[pass].culled && pending[pass] == 0)
+        {
+            ready.push(pass);
+        }
+    }
+
+    order.clear();
+    while (!ready.empty())
+    {
+        PassId pass = ready.top();
+        ready.pop();
+        order.push_back(pass);
+        for (PassId dependent : dependents[pass])
+        {
+            if (--pending[dependent] == 0)
+            {
+                ready.push(dependent);
+            }
+        }
+    }
+
+    if (order.size() != live)
+    {
+        throw std::runtime_error("render graph " + name + ": passes depend on each other in a cycle");
+    }
+}
+
+// время жизни временного image - от первого до последнего выполняемого прохода, который его касается.
+// Память под ним досталась от другого image, поэтому первое обращение обязано его перезаписать
+void RenderGraph::computeLifetimes()
+{
+    for (uint32_t position = 0; position < order.size(); position++)
+    {
+        for (const Access& access : passes[order[position]].accesses)
+        {
+            Resource& resource = resources[versions[access.input].resource];
+            if (resource.imported || !resource.image)
+            {
+                continue;
+            }
+            if (resource.firstUse == NONE)
+            {
+                if (access.reads)
+                {
+                    throw std::runtime_error("render graph " + name + ": transient image " + resource.name + " is read before it is written");
+                }
+                resource.firstUse = position;
+            }
+            resource.lastUse = position;
+        }
+    }
+}
+
+void RenderGraph::createTransientImages()
+{
+    for (Resource& resource : resources)
+    {
+        if (resource.imported || !resource.image || resource.firstUse == NONE)
+        {
+            continue;
+        }
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = resource.desc.format;
+        imageInfo.extent = {resource.desc.extent.width, resource.desc.extent.height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = resource.usage;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(device, &imageInfo, nullptr, &resource.handle) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create render graph image " + resource.name + "!");
+        }
+        vkGetImageMemoryRequirements(device, resource.handle, &resource.requirements);
+    }
+}
+
+// Жадно, от больших images к маленьким: image ложится в первый участок с подходящим типом памяти,
+// где ни одно время жизни не пересекается с его; не нашлось - свой участок размером с него
+void RenderGraph::aliasMemory()
+{
+    std::vector<uint32_t> transient;
+    for (uint32_t index = 0; index < resources.size(); index++)
+    {
+        if (resources[index].handle != VK_NULL_HANDLE && !resources[index].imported)
+        {
+            transient.push_back(index);
+        }
+    }
+    std::stable_sort(transient.begin(), transient.end(), [this](uint32_t a, uint32_t b) {
+        return resources[a].requirements.size > resources[b].requirements.size;
+    });
+
+    for (uint32_t index : transient)
+    {
+        Resource& resource = resources[index];
+        uint32_t chosen = NONE;
+        for (uint32_t h = 0; h < heaps.size() && chosen == NONE; h++)
+        {
+            Heap& heap = heaps[h];
+            if ((heap.requirements.memoryTypeBits & resource.requirements.memoryTypeBits) == 0
+                || resource.requirements.size > heap.requirements.size)
+            {
+                continue;
+            }
+            bool overlaps = false;
+            for (uint32_t other : heap.resources)
+            {
+                overlaps = overlaps || !(resource.lastUse < resources[other].firstUse || resources[other].lastUse < resource.firstUse);
+            }
+            if (!overlaps)
+            {
+                chosen = h;
+            }
+        }
+
+        if (chosen == NONE)
+        {
+            heaps.emplace_back();
+            heaps.back().requirements = resource.requirements;
+            chosen = static_cast<uint32_t>(heaps.size() - 1);
+        }
+        Heap& heap = heaps[chosen];
+        heap.requirements.alignment = std::max(heap.requirements.alignment, resource.requirements.alignment);
+        heap.requirements.memoryTypeBits &= resource.requirements.memoryTypeBits;
+        heap.resources.push_back(index);
+        resource.heap = chosen;
+    }
+
+    for (Heap& heap : heaps)
+    {
+        std::sort(heap.resources.begin(), heap.resources.end(), [this](uint32_t a, uint32_t b) {
+            return resources[a].firstUse < resources[b].firstUse;
+        });
+        heap.memory = allocator->allocate(heap.requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, ResourceKind::Optimal);
+
+        for (size_t i = 0; i < heap.resources.size(); i++)
+        {
+            Resource& resource = resources[heap.resources[i]];
+            // первый в участке идет после последнего из прошлого кадра: память одна на все кадры в полете
+            resource.aliasPrevious = heap.resources[i > 0 ? i - 1 : heap.resources.size() - 1];
+            vkBindImageMemory(device, resource.handle, heap.memory.memory, heap.memory.offset);
+
+            VkImageViewCreateInfo viewInfo{};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = resource.handle;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = resource.desc.format;
+            viewInfo.subresourceRange.aspectMask = aspectOf(resource.desc.format);
+            viewInfo.subresourceRange.levelCount = 1;
+            viewInfo.subresourceRange.layerCount = 1;
+
+            if (vkCreateImageView(device, &viewInfo, nullptr, &resource.view) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to create render graph image view " + resource.name + "!");
+            }
+        }
+    }
+}
+
+// Проходы по порядку с отслеживанием состояния каждого ресурса: последняя запись (стадии и доступ) и чтения
+// после нее. Запись и смена layout ждут и запись, и чтения; чтение - только запись, и то если еще не видит ее.
+// Временные images общие для всех кадров в полете, поэтому кадр проходится дважды: первый проход дает состояния
+// на конце прошлого кадра, их ждет первое обращение к памяти участка во втором
+void RenderGraph::buildBarriers()
+{
+    std::vector<TrackedState> initial(resources.size());
+    for (uint32_t index = 0; index < resources.size(); index++)
+    {
+        if (resources[index].imported)
+        {
+            initial[index].layout = resources[index].initial.layout;
+            initial[index].writeStages = resources[index].initial.stages;
+            initial[index].writeAccess = resources[index].initial.access & WRITE_ACCESS;
+        }
+    }
+
+    std::vector<TrackedState> previousFrame;
+    std::vector<TrackedState> states;
+    for (int run = 0; run < 2; run++)
+    {
+        previousFrame = std::move(states);
+        states = initial;
+        for (PassId id : order)
+        {
+            Pass& pass = passes[id];
+            pass.barriers = BarrierBatch{};
+            for (const Access& access : pass.accesses)
+            {
+                uint32_t resource = versions[access.input].resource;
+                addBarrier(pass.barriers, resource, states[resource], access, states, previousFrame);
+            }
+        }
+    }
+
+    finalBarriers = BarrierBatch{};
+    for (uint32_t index = 0; index < resources.size(); index++)
+    {
+        const Resource& resource = resources[index];
+        if (resource.imported && resource.image && resource.final.layout != VK_IMAGE_LAYOUT_UNDEFINED
+            && resource.final.layout != states[index].layout)
+        {
+            Access access;
+            access.input = resource.latest;
+            access.stages = resource.final.stages;
+            access.access = resource.final.access;
+            access.layout = resource.final.layout;
+            addBarrier(finalBarriers, index, states[index], access, states, previousFrame);
+        }
+    }
+}
+
+void RenderGraph::addBarrier(BarrierBatch& batch, uint32_t resource, TrackedState& state, const Access& access,
+                             const std::vector<TrackedState>& states, const std::vector<TrackedState>& previousFrame) const
+{
+    const Resource& target = resources[resource];
+    bool writes = access.output != NONE;
+    bool transition = target.image && access.layout != state.layout;
+    VkPipelineStageFlags dstStages = access.stages != 0 ? access.stages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+
+    if (!writes && !transition)
+    {
+        bool visible = (access.access & ~state.readAccess) == 0 && (access.stages & ~state.readStages) == 0;
+        if (!visible && state.writeStages != 0)
+        {
+            batch.srcStages |= state.writeStages;
+            batch.dstStages |= dstStages;
+            if (state.writeAccess != 0)
+            {
+                batch.barriers.push_back({resource, state.layout, state.layout, state.writeAccess, access.access});
+            }
+        }
+        state.readStages |= access.stages;
+        state.readAccess |= access.access;
+        return;
+    }
+
+    VkPipelineStageFlags srcStages = state.writeStages | state.readStages;
+    VkAccessFlags srcAccess = state.writeAccess;
+
+    // первое обращение к временному image: ждать последних обращений к той же памяти - прошлого хозяина
+    // в этом кадре или, для первого в участке, последнего хозяина в прошлом кадре (он мог быть еще в очереди)
+    bool firstUse = state.writeStages == 0 && state.readStages == 0;
+    bool fromPreviousFrame = target.aliasPrevious != NONE && resources[target.aliasPrevious].firstUse >= target.firstUse;
+    if (!target.imported && firstUse && target.aliasPrevious != NONE && (!fromPreviousFrame || !previousFrame.empty()))
+    {
+        const TrackedState& previous = fromPreviousFrame ? previousFrame[target.aliasPrevious] : states[target.aliasPrevious];
+        srcStages |= previous.writeStages | previous.readStages;
+        batch.memoryBarrier = true;
+        batch.memorySrcAccess |= previous.writeAccess;
+        batch.memoryDstAccess |= access.access;
+    }
+
+    if (transition || srcStages != 0)
+    {
+        batch.srcStages |= srcStages != 0 ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        batch.dstStages |= dstStages;
+        if (transition || srcAccess != 0)
+        {
+            batch.barriers.push_back({resource, state.layout, target.image ? access.layout : state.layout, srcAccess, access.access});
+        }
+    }
+
+    if (target.image)
+    {
+        state.layout = access.layout;
+    }
+    if (writes)
+    {
+        state.writeStages = access.stages;
+        state.writeAccess = access.access & WRITE_ACCESS;
+        state.readStages = 0;
+        state.readAccess = 0;
+    }
+    else
+    {
+        // смена layout ради чтения: барьер сделал запись видимой только этим стадиям. Читатели на других
+        // стадиях ждут и сам переход, и исходную запись, чтобы ее доступ был допустим в srcStages
+        state.writeStages = srcStages | dstStages;
+        state.writeAccess = srcAccess;
+        state.readStages = access.stages;
+        state.readAccess = access.access;
+    }
+}
+
+// Layout attachment внутри render pass не меняется (initial = final = layout subpass): переходы и зависимости
+// между проходами - барьеры графа. STORE только если версию кто-то читает дальше или ресурс импортирован
+void RenderGraph::createRenderPasses()
+{
+    for (PassId id : order)
+    {
+        Pass& pass = passes[id];
+        if (pass.kind != PassKind::Raster)
+        {
+            continue;
+        }
+        if (pass.attachments.empty())
+        {
+            throw std::runtime_error("render graph " + name + ": raster pass " + pass.name + " has no attachments");
+        }
+
+        std::vector<VkAttachmentDescription> descriptions;
+        std::vector<VkAttachmentReference> colorReferences;
+        VkAttachmentReference depthReference{};
+        bool hasDepth = false;
+
+        for (const Attachment& attachment : pass.attachments)
+        {
+            const Resource& resource = resources[attachment.resource];
+            bool stored = resource.imported;
+            for (PassId reader : versions[attachment.output].readers)
+            {
+                stored = stored || !passes[reader].culled;
+            }
+            VkImageLayout layout = attachment.depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+            VkAttachmentDescription description{};
+            description.format = resource.desc.format;
+            description.samples = VK_SAMPLE_COUNT_1_BIT;
+            description.loadOp = attachment.load;
+            description.storeOp = stored ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            description.initialLayout = layout;
+            description.finalLayout = layout;
+
+            VkAttachmentReference reference{};
+            reference.attachment = static_cast<uint32_t>(descriptions.size());
+            reference.layout = layout;
+            descriptions.push_back(description);
+            if (attachment.depth)
+            {
+                depthReference = reference;
+                hasDepth = true;
+            }
+            else
+            {
+                colorReferences.push_back(reference);
+            }
+        }
+
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
+        subpass.pColorAttachments = colorReferences.data();
+        subpass.pDepthStencilAttachment = hasDepth ? &depthReference : nullptr;
+
+        VkRenderPassCreateInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassInfo.attachmentCount = static_cast<uint32_t>(descriptions.size());
+        renderPassInfo.pAttachments = descriptions.data();
+        renderPassInfo.subpassCount = 1;
+        renderPassInfo.pSubpasses = &subpass;
+
+        if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &pass.renderPass) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create render pass " + pass.name + "!");
+        }
+    }
+}
+
+void RenderGraph::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    for (VkFramebuffer framebuffer : releaseFramebuffers())
+    {
+        vkDestroyFramebuffer(device, framebuffer, nullptr);
+    }
+    for (Pass& pass : passes)
+    {
+        if (pass.renderPass != VK_NULL_HANDLE)
+        {
+            vkDestroyRenderPass(device, pass.renderPass, nullptr);
+            pass.renderPass = VK_NULL_HANDLE;
+        }
+    }
+    for (Resource& resource : resources)
+    {
+        if (resource.imported)
+        {
+            continue;
+        }
+        if (resource.view != VK_NULL_HANDLE)
+        {
+            vkDestroyImageView(device, resource.view, nullptr);
+            resource.view = VK_NULL_HANDLE;
+        }
+        if (resource.handle != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(device, resource.handle, nullptr);
+            resource.handle = VK_NULL_HANDLE;
+        }
+    }
+    for (Heap& heap : heaps)
+    {
+        allocator->free(heap.memory);
+    }
+    heaps.clear();
+    device = VK_NULL_HANDLE;
+}
+
+void RenderGraph::bindImage(ResourceId image, VkImage handle, VkImageView view, VkExtent2D extent)
+{
+    Resource& resource = resources[versions[image].resource];
+    if (!resource.imported || !resource.image)
+    {
+        throw std::runtime_error("render graph " + name + ": " + resource.name + " is not an imported image");
+    }
+    resource.handle = handle;
+    resource.view = view;
+    resource.desc.extent = extent;
+}
+
+void RenderGraph::bindBuffer(ResourceId buffer, VkBuffer handle)
+{
+    Resource& resource = resources[versions[buffer].resource];
+    if (!resource.imported || resource.image)
+    {
+        throw std::runtime_error("render graph " + name + ": " + resource.name + " is not an imported buffer");
+    }
+    resource.buffer = handle;
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer)
+{
+    for (PassId id : order)
+    {
+        Pass& pass = passes[id];
+        recordBarriers(commandBuffer, pass.barriers);
+        if (pass.execute)
+        {
+            pass.execute(commandBuffer);
+        }
+    }
+    recordBarriers(commandBuffer, finalBarriers);
+}
+
+void RenderGraph::recordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch)
+{
+    if (batch.empty())
+    {
+        return;
+    }
+
+    imageBarriers.clear();
+    bufferBarriers.clear();
+    for (const Barrier& barrier : batch.barriers)
+    {
+        const Resource& resource = resources[barrier.resource];
+        if (resource.image)
+        {
+            if (resource.handle == VK_NULL_HANDLE)
+            {
+                throw std::runtime_error("render graph " + name + ": image " + resource.name + " is not bound");
+            }
+            VkImageMemoryBarrier imageBarrier{};
+            imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            imageBarrier.srcAccessMask = barrier.srcAccess;
+            imageBarrier.dstAccessMask = barrier.dstAccess;
+            imageBarrier.oldLayout = barrier.oldLayout;
+            imageBarrier.newLayout = barrier.newLayout;
+            imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.image = resource.handle;
+            imageBarrier.subresourceRange.aspectMask = aspectOf(resource.desc.format);
+            imageBarrier.subresourceRange.levelCount = 1;
+            imageBarrier.subresourceRange.layerCount = 1;
+            imageBarriers.push_back(imageBarrier);
+        }
+        else
+        {
+            if (resource.buffer == VK_NULL_HANDLE)
+            {
+                throw std::runtime_error("render graph " + name + ": buffer " + resource.name + " is not bound");
+            }
+            VkBufferMemoryBarrier bufferBarrier{};
+            bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            bufferBarrier.srcAccessMask = barrier.srcAccess;
+            bufferBarrier.dstAccessMask = barrier.dstAccess;
+            bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bufferBarrier.buffer = resource.buffer;
+            bufferBarrier.offset = 0;
+            bufferBarrier.size = VK_WHOLE_SIZE;
+            bufferBarriers.push_back(bufferBarrier);
+        }
+    }
+
+    VkMemoryBarrier memoryBarrier{};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.srcAccessMask = batch.memorySrcAccess;
+    memoryBarrier.dstAccessMask = batch.memoryDstAccess;
+
+    vkCmdPipelineBarrier(commandBuffer, batch.srcStages, batch.dstStages, 0,
+                         batch.memoryBarrier ? 1 : 0, &memoryBarrier,
+                         static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+                         static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+}
+
+VkFramebuffer RenderGraph::currentFramebuffer(Pass& pass, VkExtent2D& extent)
+{
+    extent = resources[pass.attachments.front().resource].desc.extent;
+    attachmentViews.clear();
+    for (const Attachment& attachment : pass.attachments)
+    {
+        const Resource& resource = resources[attachment.resource];
+        if (resource.view == VK_NULL_HANDLE)
+        {
+            throw std::runtime_error("render graph " + name + ": attachment " + resource.name + " is not bound");
+        }
+        attachmentViews.push_back(resource.view);
+    }
+
+    auto found = pass.framebuffers.find(attachmentViews);
+    if (found != pass.framebuffers.end())
+    {
+        return found->second;
+    }
+
+    VkFramebufferCreateInfo framebufferInfo{};
+    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.renderPass = pass.renderPass;
+    framebufferInfo.attachmentCount = static_cast<uint32_t>(attachmentViews.size());
+    framebufferInfo.pAttachments = attachmentViews.data();
+    framebufferInfo.width = extent.width;
+    framebufferInfo.height = extent.height;
+    framebufferInfo.layers = 1;
+
+    VkFramebuffer framebuffer;
+    if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create framebuffer!");
+    }
+    pass.framebuffers.emplace(attachmentViews, framebuffer);
+    return framebuffer;
+}
+
+VkFramebuffer RenderGraph::framebuffer(PassId pass)
+{
+    VkExtent2D extent;
+    return currentFramebuffer(passes[pass], extent);
+}
+
+void RenderGraph::beginRenderPass(VkCommandBuffer commandBuffer, PassId id, VkSubpassContents contents)
+{
+    Pass& pass = passes[id];
+    VkExtent2D extent;
+    VkFramebuffer framebuffer = currentFramebuffer(pass, extent);
+
+    clearValues.clear();
+    for (const Attachment& attachment : pass.attachments)
+    {
+        clearValues.push_back(attachment.clear);
+    }
+
+    VkRenderPassBeginInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderPass = pass.renderPass;
+    renderPassInfo.framebuffer = framebuffer;
+    renderPassInfo.renderArea.offset = {0, 0};
+    renderPassInfo.renderArea.extent = extent;
+    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+    renderPassInfo.pClearValues = clearValues.data();
+
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+}
+
+void RenderGraph::endRenderPass(VkCommandBuffer commandBuffer)
+{
+    vkCmdEndRenderPass(commandBuffer);
+}
+
+std::vector<VkFramebuffer> RenderGraph::releaseFramebuffers()
+{
+    std::vector<VkFramebuffer> released;
+    for (Pass& pass : passes)
+    {
+        for (const auto& entry : pass.framebuffers)
+        {
+            released.push_back(entry.second);
+        }
+        pass.framebuffers.clear();
+    }
+    return released;
+}
+
+RenderGraph::Stats RenderGraph::stats() const
+{
+    Stats stats;
+    stats.passes = static_cast<uint32_t>(order.size());
+    stats.culledPasses = static_cast<uint32_t>(passes.size() - order.size());
+
+    auto countBatch = [&stats](const BarrierBatch& batch) {
+        if (!batch.empty())
+        {
+            stats.barrierBatches++;
+            stats.barriers += static_cast<uint32_t>(batch.barriers.size()) + (batch.memoryBarrier ? 1 : 0);
+        }
+    };
+    for (PassId id : order)
+    {
+        countBatch(passes[id].barriers);
+    }
+    countBatch(finalBarriers);
+
+    for (const Resource& resource : resources)
+    {
+        if (!resource.imported && resource.heap != NONE)
+        {
+            stats.transientImages++;
+            stats.transientBytes += resource.requirements.size;
+        }
+    }
+    stats.heaps = static_cast<uint32_t>(heaps.size());
+    for (const Heap& heap : heaps)
+    {
+        stats.aliasedBytes += heap.requirements.size;
+    }
+    return stats;
+}
+
+void RenderGraph::dumpBatch(std::ostream& out, const BarrierBatch& batch) const
+{
+    if (batch.empty())
+    {
+        return;
+    }
+    out << "       barrier " << flagNames(batch.srcStages, STAGE_NAMES) << " -> " << flagNames(batch.dstStages, STAGE_NAMES) << "\n";
+    if (batch.memoryBarrier)
+    {
+        out << "         memory (aliasing) " << flagNames(batch.memorySrcAccess, ACCESS_NAMES)
+            << " -> " << flagNames(batch.memoryDstAccess, ACCESS_NAMES) << "\n";
+    }
+    for (const Barrier& barrier : batch.barriers)
+    {
+        const Resource& resource = resources[barrier.resource];
+        out << "         " << resource.name << " " << flagNames(barrier.srcAccess, ACCESS_NAMES)
+            << " -> " << flagNames(barrier.dstAccess, ACCESS_NAMES);
+        if (resource.image && barrier.oldLayout != barrier.newLayout)
+        {
+            out << ", " << layoutName(barrier.oldLayout) << " -> " << layoutName(barrier.newLayout);
+        }
+        out << "\n";
+    }
+}
+
+void RenderGraph::dump(std::ostream& out) const
+{
+    Stats summary = stats();
+    out << "render graph " << name << ": " << summary.passes << " passes, " << summary.culledPasses << " culled, "
+        << summary.barrierBatches << " barrier batches (" << summary.barriers << " barriers)\n";
+
+    for (size_t position = 0; position < order.size(); position++)
+    {
+        const Pass& pass = passes[order[position]];
+        out << "  " << position << ". " << pass.name << (pass.kind == PassKind::Raster ? " (raster)" : " (compute)") << "\n";
+        dumpBatch(out, pass.barriers);
+
+        std::string reads;
+        std::string writes;
+        for (const Access& access : pass.accesses)
+        {
+            const Version& input = versions[access.input];
+            if (access.output == NONE)
+            {
+                reads += " " + resources[input.resource].name + "#" + std::to_string(input.number);
+            }
+            else
+            {
+                writes += " " + resources[input.resource].name + "#" + std::to_string(versions[access.output].number);
+            }
+        }
+        if (!reads.empty())
+        {
+            out << "       reads" << reads << "\n";
+        }
+        if (!writes.empty())
+        {
+            out << "       writes" << writes << "\n";
+        }
+    }
+    if (!finalBarriers.empty())
+    {
+        out << "  end of frame\n";
+        dumpBatch(out, finalBarriers);
+    }
+
+    for (const Pass& pass : passes)
+    {
+        if (pass.culled)
+        {
+            out << "  culled: " << pass.name << "\n";
+        }
+    }
+
+    if (summary.transientImages > 0)
+    {
+        out << std::fixed << std::setprecision(2)
+            << "  transient images: " << summary.transientImages << ", " << mebibytes(summary.transientBytes) << " MiB separately, "
+            << mebibytes(summary.aliasedBytes) << " MiB aliased in " << summary.heaps << " heaps ("
+            << mebibytes(summary.transientBytes - summary.aliasedBytes) << " MiB saved)\n";
+        for (size_t h = 0; h < heaps.size(); h++)
+        {
+            out << "    heap " << h << " (" << mebibytes(heaps[h].requirements.size) << " MiB):";
+            for (uint32_t index : heaps[h].resources)
+            {
+                out << " " << resources[index].name << " [" << resources[index].firstUse << "-" << resources[index].lastUse << "]";
+            }
+            out << "\n";
+        }
+        out << std::defaultfloat;
+    }
+    out.flush();
+}
+
+void RenderGraph::writeJson(std::ostream& out) const
+{
+    Stats summary = stats();
+    out << "{\"passes\": [";
+    for (size_t position = 0; position < order.size(); position++)
+    {
+        out << (position > 0 ? ", " : "") << "\"" << passes[order[position]].name << "\"";
+    }
+    out << "], \"culledPasses\": " << summary.culledPasses
+        << ", \"barrierBatches\": " << summary.barrierBatches
+        << ", \"barriers\": " << summary.barriers
+        << ", \"transientImages\": " << summary.transientImages
+        << ", \"heaps\": " << summary.heaps
+        << ", \"transientBytes\": " << summary.transientBytes
+        << ", \"aliasedBytes\": " << summary.aliasedBytes << "}";
+}
@@ -0,0 +1,120 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "SceneGraph.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+uint32_t SceneGraph::addNode(uint32_t parent, const glm::mat4& local)
+{
+    uint32_t node = static_cast<uint32_t>(parents.size());
+    if (parent != SCENE_NO_PARENT && parent >= node)
+    {
+        throw std::runtime_error("scene graph parent must be added before its children");
+    }
+
+    // прямой порядок сохраняется, если родитель - предыдущий узел или один из его предков
+    if (preorder && parent != SCENE_NO_PARENT && node > 0)
+    {
+        uint32_t ancestor = node - 1;
+        while (ancestor != SCENE_NO_PARENT && ancestor != parent)
+        {
+            ancestor = parents[ancestor];
+        }
+        preorder = ancestor == parent;
+    }
+
+    parents.push_back(parent);
+    locals.push_back(local);
+    worlds.push_back(parent == SCENE_NO_PARENT ? local : worlds[parent] * local);
+    subtreeEnd.push_back(node + 1);
+    dirty.push_back(0);
+    changedFlags.push_back(0);
+
+    if (preorder)
+    {
+        for (uint32_t ancestor = parent; ancestor != SCENE_NO_PARENT; ancestor = parents[ancestor])
+        {
+            subtreeEnd[ancestor] = node + 1;
+        }
+    }
+    return node;
+}
+
+void SceneGraph::setLocal(uint32_t node, const glm::mat4& local)
+{
+    locals[node] = local;
+    if (!dirty[node])
+    {
+        dirty[node] = 1;
+        dirtyNodes.push_back(node);
+    }
+}
+
+size_t SceneGraph::update()
+{
+    changed.clear();
+    if (dirtyNodes.empty())
+    {
+        return 0;
+    }
+
+    std::sort(dirtyNodes.begin(), dirtyNodes.end());
+    if (preorder)
+    {
+        updateRanges();
+    }
+    else
+    {
+        updateScan();
+    }
+
+    for (uint32_t node : dirtyNodes)
+    {
+        dirty[node] = 0;
+    }
+    dirtyNodes.clear();
+    return changed.size();
+}
+
+// поддерево помеченного узла - [node, subtreeEnd[node]), все его узлы меняются целиком.
+// Помеченные внутри уже пройденного поддерева пропускаются
+void SceneGraph::updateRanges()
+{
+    uint32_t processedEnd = 0;
+    for (uint32_t root : dirtyNodes)
+    {
+        if (root < processedEnd)
+        {
+            continue;
+        }
+        for (uint32_t node = root; node < subtreeEnd[root]; node++)
+        {
+            uint32_t parent = parents[node];
+            worlds[node] = parent == SCENE_NO_PARENT ? locals[node] : worlds[parent] * locals[node];
+            changed.push_back(node);
+        }
+        processedEnd = subtreeEnd[root];
+    }
+}
+
+// без прямого порядка потомки могут быть где угодно правее: узел меняется, если помечен он сам или изменился родитель
+void SceneGraph::updateScan()
+{
+    for (uint32_t node = dirtyNodes.front(); node < parents.size(); node++)
+    {
+        uint32_t parent = parents[node];
+        if (dirty[node] || (parent != SCENE_NO_PARENT && changedFlags[parent]))
+        {
+            worlds[node] = parent == SCENE_NO_PARENT ? locals[node] : worlds[parent] * locals[node];
+            changedFlags[node] = 1;
+            changed.push_back(node);
+        }
+    }
+    for (uint32_t node : changed)
+    {
+        changedFlags[node] = 0;
+    }
+}
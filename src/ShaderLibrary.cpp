@@ -0,0 +1,114 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "ShaderLibrary.h"
+#include "MappedFile.h"
+
+#ifdef VULKAN_LEARN_EMBED_SHADERS
+#include "EmbeddedShaders.h"
+#endif
+
+#include <stdexcept>
+
+namespace {
+
+const uint32_t SPIRV_MAGIC = 0x07230203;
+const size_t SPIRV_HEADER_SIZE = 5 * sizeof(uint32_t);
+
+uint64_t hashCode(const uint32_t* code, size_t size)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(code);
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    // размер тоже часть ключа: дешевая защита от совпадения хэшей у файлов разной длины
+    return hash ^ (static_cast<uint64_t>(size) * 0x9E3779B97F4A7C15ull);
+}
+
+} // namespace
+
+void ShaderLibrary::init(VkDevice device, const std::string& shaderDir)
+{
+    this->device = device;
+    this->shaderDir = shaderDir;
+}
+
+void ShaderLibrary::destroy()
+{
+    for (auto& [hash, module] : modulesByHash)
+    {
+        vkDestroyShaderModule(device, module, nullptr);
+    }
+    modulesByHash.clear();
+    modulesByName.clear();
+}
+
+VkShaderModule ShaderLibrary::getModule(const std::string& name)
+{
+    auto cached = modulesByName.find(name);
+    if (cached != modulesByName.end())
+    {
+        counters.cacheHits++;
+        return cached->second;
+    }
+
+#ifdef VULKAN_LEARN_EMBED_SHADERS
+    for (size_t i = 0; i < EMBEDDED_SHADER_COUNT; i++)
+    {
+        if (name == EMBEDDED_SHADERS[i].name)
+        {
+            counters.embeddedUsed++;
+            return createModule(name, EMBEDDED_SHADERS[i].code, EMBEDDED_SHADERS[i].size);
+        }
+    }
+#endif
+
+    // отображение нужно только до vkCreateShaderModule: драйвер копирует код себе
+    MappedFile file(shaderDir + "/" + name);
+    counters.filesMapped++;
+    return createModule(name, static_cast<const uint32_t*>(file.data()), file.size());
+}
+
+void ShaderLibrary::printStats(std::ostream& out) const
+{
+    out << "shaders: " << counters.modulesCreated << " modules (" << counters.filesMapped << " mapped, "
+        << counters.embeddedUsed << " embedded), " << counters.cacheHits << " cache hits" << std::endl;
+}
+
+VkShaderModule ShaderLibrary::createModule(const std::string& name, const uint32_t* code, size_t size)
+{
+    // vkCreateShaderModule с мусором - неопределенное поведение, проверяем хотя бы заголовок
+    if (size < SPIRV_HEADER_SIZE || size % sizeof(uint32_t) != 0 || code[0] != SPIRV_MAGIC)
+    {
+        throw std::runtime_error("invalid SPIR-V: " + name);
+    }
+
+    uint64_t hash = hashCode(code, size);
+    auto sameCode = modulesByHash.find(hash);
+    if (sameCode != modulesByHash.end())
+    {
+        counters.cacheHits++;
+        modulesByName[name] = sameCode->second;
+        return sameCode->second;
+    }
+
+    VkShaderModuleCreateInfo createInfo{};
+    createInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = size;
+    createInfo.pCode    = code;
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create shader module");
+    }
+
+    counters.modulesCreated++;
+    modulesByHash[hash] = shaderModule;
+    modulesByName[name] = shaderModule;
+    return shaderModule;
+}
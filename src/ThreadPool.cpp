@@ -0,0 +1,79 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(uint32_t threadCount)
+{
+    workers.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+std::future<void> ThreadPool::submit(std::function<void()> task)
+{
+    std::packaged_task<void()> packaged(std::move(task));
+    std::future<void> result = packaged.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push(std::move(packaged));
+    }
+    taskAvailable.notify_one();
+    return result;
+}
+
+void ThreadPool::parallelFor(uint32_t count, const std::function<void(uint32_t)>& body)
+{
+    std::vector<std::future<void>> pending;
+    pending.reserve(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        pending.push_back(submit([&body, i]() { body(i); }));
+    }
+
+    // сначала дожидаемся всех: body и захваченные им данные должны пережить последнюю задачу
+    for (auto& task : pending)
+    {
+        task.wait();
+    }
+    for (auto& task : pending)
+    {
+        task.get();
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    for (;;)
+    {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty())
+            {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
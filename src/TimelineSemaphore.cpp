@@ -0,0 +1,85 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "TimelineSemaphore.h"
+
+#include <stdexcept>
+
+void TimelineSemaphore::init(VkDevice device)
+{
+    this->device = device;
+
+    waitSemaphores = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(vkGetDeviceProcAddr(device, "vkWaitSemaphoresKHR"));
+    getSemaphoreCounterValue = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(
+            vkGetDeviceProcAddr(device, "vkGetSemaphoreCounterValueKHR"));
+    if (waitSemaphores == nullptr || getSemaphoreCounterValue == nullptr)
+    {
+        throw std::runtime_error("VK_KHR_timeline_semaphore functions are not available!");
+    }
+
+    VkSemaphoreTypeCreateInfoKHR typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+
+    if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create timeline semaphore!");
+    }
+
+    lastValue = 0;
+    completed = 0;
+}
+
+void TimelineSemaphore::destroy()
+{
+    if (semaphore != VK_NULL_HANDLE)
+    {
+        vkDestroySemaphore(device, semaphore, nullptr);
+        semaphore = VK_NULL_HANDLE;
+    }
+}
+
+uint64_t TimelineSemaphore::completedValue()
+{
+    if (completed < lastValue)
+    {
+        if (getSemaphoreCounterValue(device, semaphore, &completed) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to read timeline semaphore value!");
+        }
+    }
+    return completed;
+}
+
+bool TimelineSemaphore::wait(uint64_t value, uint64_t timeout)
+{
+    if (value <= completed)
+    {
+        return true;
+    }
+
+    VkSemaphoreWaitInfoKHR waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &semaphore;
+    waitInfo.pValues = &value;
+
+    VkResult result = waitSemaphores(device, &waitInfo, timeout);
+    if (result == VK_TIMEOUT)
+    {
+        return false;
+    }
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to wait for timeline semaphore!");
+    }
+
+    completed = value > completed ? value : completed;
+    return true;
+}
@@ -0,0 +1,403 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "TransformSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <glm/gtc/matrix_transform.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSFORM_SSE
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace {
+
+// AVX2 и FMA в CPUID, и ОС сохраняет регистры YMM (XGETBV)
+bool cpuSupportsAvx2()
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 1);
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+float maxColumnLength(const glm::mat4& matrix)
+{
+    return std::max(glm::length(glm::vec3(matrix[0])), std::max(glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2]))));
+}
+
+// матрица вращения единичного кватерниона
+glm::mat4 rotationMatrix(float x, float y, float z, float w)
+{
+    glm::mat4 rotation(1.0f);
+    rotation[0] = glm::vec4(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y), 0.0f);
+    rotation[1] = glm::vec4(2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x), 0.0f);
+    rotation[2] = glm::vec4(2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y), 0.0f);
+    return rotation;
+}
+
+} // namespace
+
+const char* transformKernelName(TransformKernel kernel)
+{
+    switch (kernel)
+    {
+        case TransformKernel::Scalar: return "scalar";
+        case TransformKernel::Sse:    return "sse";
+        case TransformKernel::Avx2:   return "avx2";
+    }
+    return "unknown";
+}
+
+TransformKernel parseTransformKernel(const std::string& name)
+{
+    for (TransformKernel kernel : {TransformKernel::Scalar, TransformKernel::Sse, TransformKernel::Avx2})
+    {
+        if (name == transformKernelName(kernel))
+        {
+            return kernel;
+        }
+    }
+    throw std::runtime_error("unknown transform kernel: " + name + " (expected scalar, sse or avx2)");
+}
+
+bool transformKernelSupported(TransformKernel kernel)
+{
+    switch (kernel)
+    {
+        case TransformKernel::Scalar:
+            return true;
+        case TransformKernel::Sse:
+#ifdef TRANSFORM_SSE
+            return true;
+#else
+            return false;
+#endif
+        case TransformKernel::Avx2:
+        {
+            static const bool supported = transformAvx2Compiled() && cpuSupportsAvx2();
+            return supported;
+        }
+    }
+    return false;
+}
+
+TransformKernel bestTransformKernel()
+{
+    for (TransformKernel kernel : {TransformKernel::Avx2, TransformKernel::Sse})
+    {
+        if (transformKernelSupported(kernel))
+        {
+            return kernel;
+        }
+    }
+    return TransformKernel::Scalar;
+}
+
+void TransformSystem::resize(size_t objectCount)
+{
+    count = objectCount;
+    size_t padded = (objectCount + TRANSFORM_BATCH - 1) / TRANSFORM_BATCH * TRANSFORM_BATCH;
+    for (auto* array : {&positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ, &rotationW, &scale})
+    {
+        array->resize(padded, 0.0f);
+    }
+}
+
+void TransformSystem::set(size_t index, const glm::vec3& position, const glm::vec3& axis, float angle, float objectScale)
+{
+    float halfSin = std::sin(angle * 0.5f);
+    positionX[index] = position.x;
+    positionY[index] = position.y;
+    positionZ[index] = position.z;
+    rotationX[index] = axis.x * halfSin;
+    rotationY[index] = axis.y * halfSin;
+    rotationZ[index] = axis.z * halfSin;
+    rotationW[index] = std::cos(angle * 0.5f);
+    scale[index] = objectScale;
+}
+
+void TransformSystem::setParent(const glm::mat4& parentTransform)
+{
+    parent = parentTransform;
+}
+
+void TransformSystem::setLocal(const glm::mat4& localTransform, const glm::vec4& localBounds)
+{
+    local = localTransform;
+    bounds = localBounds;
+}
+
+size_t TransformSystem::update(const glm::vec4 planes[6], TransformKernel kernel, ThreadPool* pool,
+                               std::vector<uint32_t>& visible, std::vector<glm::mat4>* world) const
+{
+    if (!transformKernelSupported(kernel))
+    {
+        throw std::runtime_error(std::string("transform kernel is not supported on this CPU: ") + transformKernelName(kernel));
+    }
+
+    TransformView view{};
+    view.positionX = positionX.data();
+    view.positionY = positionY.data();
+    view.positionZ = positionZ.data();
+    view.rotationX = rotationX.data();
+    view.rotationY = rotationY.data();
+    view.rotationZ = rotationZ.data();
+    view.rotationW = rotationW.data();
+    view.scale = scale.data();
+    std::memcpy(view.parent, &parent, sizeof(view.parent));
+    std::memcpy(view.local, &local, sizeof(view.local));
+    std::memcpy(view.bounds, &bounds, sizeof(view.bounds));
+    view.radiusScale = maxColumnLength(parent) * maxColumnLength(local);
+    std::memcpy(view.planes, planes, sizeof(view.planes));
+
+    auto cullRange = transformCullScalar;
+    if (kernel == TransformKernel::Sse)
+    {
+        cullRange = transformCullSse;
+    }
+    else if (kernel == TransformKernel::Avx2)
+    {
+        cullRange = transformCullAvx2;
+    }
+
+    if (visible.size() < count)
+    {
+        visible.resize(count);
+    }
+    if (world != nullptr && world->size() < count)
+    {
+        world->resize(count);
+    }
+
+    // каждый кусок пишет свои результаты с собственного начала, потом куски сдвигаются вплотную
+    uint32_t chunkCount = static_cast<uint32_t>((count + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    std::vector<size_t> chunkVisible(chunkCount);
+    auto processChunk = [&](uint32_t chunk) {
+        size_t begin = chunk * CHUNK_SIZE;
+        size_t end = std::min(count, begin + CHUNK_SIZE);
+        float* chunkWorld = world != nullptr ? &(*world)[begin][0][0] : nullptr;
+        chunkVisible[chunk] = cullRange(view, begin, end, visible.data() + begin, chunkWorld);
+    };
+
+    if (pool != nullptr && chunkCount > 1)
+    {
+        pool->parallelFor(chunkCount, processChunk);
+    }
+    else
+    {
+        for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+        {
+            processChunk(chunk);
+        }
+    }
+
+    size_t total = 0;
+    for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        size_t begin = chunk * CHUNK_SIZE;
+        if (total != begin)
+        {
+            std::memmove(visible.data() + total, visible.data() + begin, chunkVisible[chunk] * sizeof(uint32_t));
+            if (world != nullptr)
+            {
+                std::memmove(world->data() + total, world->data() + begin, chunkVisible[chunk] * sizeof(glm::mat4));
+            }
+        }
+        total += chunkVisible[chunk];
+    }
+    return total;
+}
+
+// Эталон: та же матрица, что у makeInstance() - translate * rotate * scale, по одному объекту через glm
+size_t transformCullScalar(const TransformView& view, size_t begin, size_t end, uint32_t* visible, float* world)
+{
+    glm::mat4 parent;
+    glm::mat4 local;
+    std::memcpy(&parent, view.parent, sizeof(parent));
+    std::memcpy(&local, view.local, sizeof(local));
+    glm::vec4 center(view.bounds[0], view.bounds[1], view.bounds[2], 1.0f);
+
+    size_t visibleCount = 0;
+    for (size_t i = begin; i < end; i++)
+    {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(view.positionX[i], view.positionY[i], view.positionZ[i]));
+        model = model * rotationMatrix(view.rotationX[i], view.rotationY[i], view.rotationZ[i], view.rotationW[i]);
+        model = glm::scale(model, glm::vec3(view.scale[i]));
+        glm::mat4 transform = parent * model * local;
+
+        glm::vec3 worldCenter = glm::vec3(transform * center);
+        float radius = view.bounds[3] * view.scale[i] * view.radiusScale;
+        bool inside = true;
+        for (int p = 0; p < 6; p++)
+        {
+            inside = inside && view.planes[p][0] * worldCenter.x + view.planes[p][1] * worldCenter.y
+                               + view.planes[p][2] * worldCenter.z + view.planes[p][3] >= -radius;
+        }
+
+        if (inside)
+        {
+            if (world != nullptr)
+            {
+                std::memcpy(world + visibleCount * 16, &transform, sizeof(transform));
+            }
+            visible[visibleCount++] = static_cast<uint32_t>(i);
+        }
+    }
+    return visibleCount;
+}
+
+#ifdef TRANSFORM_SSE
+// 4 объекта на регистр. Центр сферы считается без полной матрицы: parent * (R * s * (local * c) + t),
+// полная матрица нужна только видимым и только если ее просят
+size_t transformCullSse(const TransformView& view, size_t begin, size_t end, uint32_t* visible, float* world)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+
+    // local * c - общая для всех точка
+    float localCenter[4];
+    for (int row = 0; row < 4; row++)
+    {
+        localCenter[row] = view.local[row] * view.bounds[0] + view.local[4 + row] * view.bounds[1]
+                           + view.local[8 + row] * view.bounds[2] + view.local[12 + row];
+    }
+    const __m128 radiusScale = _mm_set1_ps(view.bounds[3] * view.radiusScale);
+
+    size_t visibleCount = 0;
+    for (size_t i = begin; i < end; i += 4)
+    {
+        __m128 px = _mm_loadu_ps(view.positionX + i);
+        __m128 py = _mm_loadu_ps(view.positionY + i);
+        __m128 pz = _mm_loadu_ps(view.positionZ + i);
+        __m128 qx = _mm_loadu_ps(view.rotationX + i);
+        __m128 qy = _mm_loadu_ps(view.rotationY + i);
+        __m128 qz = _mm_loadu_ps(view.rotationZ + i);
+        __m128 qw = _mm_loadu_ps(view.rotationW + i);
+        __m128 s = _mm_loadu_ps(view.scale + i);
+
+        // R * s, r[column][row]
+        __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+        __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+        __m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+        __m128 s2 = _mm_mul_ps(s, two);
+        __m128 r[3][3];
+        r[0][0] = _mm_sub_ps(s, _mm_mul_ps(s2, _mm_add_ps(yy, zz)));
+        r[0][1] = _mm_mul_ps(s2, _mm_add_ps(xy, wz));
+        r[0][2] = _mm_mul_ps(s2, _mm_sub_ps(xz, wy));
+        r[1][0] = _mm_mul_ps(s2, _mm_sub_ps(xy, wz));
+        r[1][1] = _mm_sub_ps(s, _mm_mul_ps(s2, _mm_add_ps(xx, zz)));
+        r[1][2] = _mm_mul_ps(s2, _mm_add_ps(yz, wx));
+        r[2][0] = _mm_mul_ps(s2, _mm_add_ps(xz, wy));
+        r[2][1] = _mm_mul_ps(s2, _mm_sub_ps(yz, wx));
+        r[2][2] = _mm_sub_ps(s, _mm_mul_ps(s2, _mm_add_ps(xx, yy)));
+        __m128 t[3] = {px, py, pz};
+
+        // M * (local * c), затем parent
+        __m128 model[3];
+        for (int row = 0; row < 3; row++)
+        {
+            model[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r[0][row], _mm_set1_ps(localCenter[0])),
+                                               _mm_mul_ps(r[1][row], _mm_set1_ps(localCenter[1]))),
+                                    _mm_add_ps(_mm_mul_ps(r[2][row], _mm_set1_ps(localCenter[2])),
+                                               _mm_mul_ps(t[row], _mm_set1_ps(localCenter[3]))));
+        }
+        __m128 center[3];
+        for (int row = 0; row < 3; row++)
+        {
+            center[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(view.parent[row]), model[0]),
+                                                _mm_mul_ps(_mm_set1_ps(view.parent[4 + row]), model[1])),
+                                     _mm_add_ps(_mm_mul_ps(_mm_set1_ps(view.parent[8 + row]), model[2]),
+                                                _mm_set1_ps(view.parent[12 + row] * localCenter[3])));
+        }
+        __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(s, radiusScale));
+
+        __m128 inside = _mm_cmpeq_ps(one, one);
+        for (int p = 0; p < 6; p++)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(center[0], _mm_set1_ps(view.planes[p][0])),
+                                                    _mm_mul_ps(center[1], _mm_set1_ps(view.planes[p][1]))),
+                                         _mm_add_ps(_mm_mul_ps(center[2], _mm_set1_ps(view.planes[p][2])),
+                                                    _mm_set1_ps(view.planes[p][3])));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+        if (end - i < 4)
+        {
+            mask &= (1 << (end - i)) - 1;
+        }
+        if (mask == 0)
+        {
+            continue;
+        }
+
+        // полная матрица parent * [R * s | t] * local для видимых: w[4 * column + row]
+        alignas(16) float matrix[16][4];
+        if (world != nullptr)
+        {
+            for (int column = 0; column < 4; column++)
+            {
+                const float* l = view.local + 4 * column;
+                __m128 a[3];
+                for (int row = 0; row < 3; row++)
+                {
+                    a[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r[0][row], _mm_set1_ps(l[0])), _mm_mul_ps(r[1][row], _mm_set1_ps(l[1]))),
+                                        _mm_add_ps(_mm_mul_ps(r[2][row], _mm_set1_ps(l[2])), _mm_mul_ps(t[row], _mm_set1_ps(l[3]))));
+                }
+                for (int row = 0; row < 4; row++)
+                {
+                    __m128 value = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(view.parent[row]), a[0]),
+                                                         _mm_mul_ps(_mm_set1_ps(view.parent[4 + row]), a[1])),
+                                              _mm_add_ps(_mm_mul_ps(_mm_set1_ps(view.parent[8 + row]), a[2]),
+                                                         _mm_set1_ps(view.parent[12 + row] * l[3])));
+                    _mm_store_ps(matrix[4 * column + row], value);
+                }
+            }
+        }
+
+        for (int lane = 0; lane < 4; lane++)
+        {
+            if ((mask >> lane) & 1)
+            {
+                if (world != nullptr)
+                {
+                    for (int element = 0; element < 16; element++)
+                    {
+                        world[visibleCount * 16 + element] = matrix[element][lane];
+                    }
+                }
+                visible[visibleCount++] = static_cast<uint32_t>(i + lane);
+            }
+        }
+    }
+    return visibleCount;
+}
+#else
+size_t transformCullSse(const TransformView& view, size_t begin, size_t end, uint32_t* visible, float* world)
+{
+    return transformCullScalar(view, begin, end, visible, world);
+}
+#endif
@@ -0,0 +1,152 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+// Собирается с -mavx2 -mfma (/arch:AVX2), см. CMakeLists.txt. Вызывается только после проверки CPUID
+// (transformKernelSupported), поэтому здесь нельзя подключать glm и STL - см. TransformKernels.h
+
+#include "TransformKernels.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+bool transformAvx2Compiled()
+{
+    return true;
+}
+
+// тот же расчет, что в transformCullSse, по 8 объектов и с FMA
+size_t transformCullAvx2(const TransformView& view, size_t begin, size_t end, uint32_t* visible, float* world)
+{
+    const __m256 two = _mm256_set1_ps(2.0f);
+
+    float localCenter[4];
+    for (int row = 0; row < 4; row++)
+    {
+        localCenter[row] = view.local[row] * view.bounds[0] + view.local[4 + row] * view.bounds[1]
+                           + view.local[8 + row] * view.bounds[2] + view.local[12 + row];
+    }
+    const __m256 radiusScale = _mm256_set1_ps(view.bounds[3] * view.radiusScale);
+
+    size_t visibleCount = 0;
+    for (size_t i = begin; i < end; i += TRANSFORM_BATCH)
+    {
+        __m256 qx = _mm256_loadu_ps(view.rotationX + i);
+        __m256 qy = _mm256_loadu_ps(view.rotationY + i);
+        __m256 qz = _mm256_loadu_ps(view.rotationZ + i);
+        __m256 qw = _mm256_loadu_ps(view.rotationW + i);
+        __m256 s = _mm256_loadu_ps(view.scale + i);
+        __m256 t[3] = {_mm256_loadu_ps(view.positionX + i), _mm256_loadu_ps(view.positionY + i), _mm256_loadu_ps(view.positionZ + i)};
+
+        // R * s, r[column][row]
+        __m256 s2 = _mm256_mul_ps(s, two);
+        __m256 xx = _mm256_mul_ps(qx, qx), yy = _mm256_mul_ps(qy, qy), zz = _mm256_mul_ps(qz, qz);
+        __m256 xy = _mm256_mul_ps(qx, qy), xz = _mm256_mul_ps(qx, qz), yz = _mm256_mul_ps(qy, qz);
+        __m256 wx = _mm256_mul_ps(qw, qx), wy = _mm256_mul_ps(qw, qy), wz = _mm256_mul_ps(qw, qz);
+        __m256 r[3][3];
+        r[0][0] = _mm256_fnmadd_ps(s2, _mm256_add_ps(yy, zz), s);
+        r[0][1] = _mm256_mul_ps(s2, _mm256_add_ps(xy, wz));
+        r[0][2] = _mm256_mul_ps(s2, _mm256_sub_ps(xz, wy));
+        r[1][0] = _mm256_mul_ps(s2, _mm256_sub_ps(xy, wz));
+        r[1][1] = _mm256_fnmadd_ps(s2, _mm256_add_ps(xx, zz), s);
+        r[1][2] = _mm256_mul_ps(s2, _mm256_add_ps(yz, wx));
+        r[2][0] = _mm256_mul_ps(s2, _mm256_add_ps(xz, wy));
+        r[2][1] = _mm256_mul_ps(s2, _mm256_sub_ps(yz, wx));
+        r[2][2] = _mm256_fnmadd_ps(s2, _mm256_add_ps(xx, yy), s);
+
+        // центр сферы: parent * (M * (local * c))
+        __m256 model[3];
+        for (int row = 0; row < 3; row++)
+        {
+            __m256 value = _mm256_mul_ps(t[row], _mm256_set1_ps(localCenter[3]));
+            value = _mm256_fmadd_ps(r[0][row], _mm256_set1_ps(localCenter[0]), value);
+            value = _mm256_fmadd_ps(r[1][row], _mm256_set1_ps(localCenter[1]), value);
+            model[row] = _mm256_fmadd_ps(r[2][row], _mm256_set1_ps(localCenter[2]), value);
+        }
+        __m256 center[3];
+        for (int row = 0; row < 3; row++)
+        {
+            __m256 value = _mm256_set1_ps(view.parent[12 + row] * localCenter[3]);
+            value = _mm256_fmadd_ps(_mm256_set1_ps(view.parent[row]), model[0], value);
+            value = _mm256_fmadd_ps(_mm256_set1_ps(view.parent[4 + row]), model[1], value);
+            center[row] = _mm256_fmadd_ps(_mm256_set1_ps(view.parent[8 + row]), model[2], value);
+        }
+        __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_mul_ps(s, radiusScale));
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; p++)
+        {
+            __m256 distance = _mm256_set1_ps(view.planes[p][3]);
+            distance = _mm256_fmadd_ps(center[0], _mm256_set1_ps(view.planes[p][0]), distance);
+            distance = _mm256_fmadd_ps(center[1], _mm256_set1_ps(view.planes[p][1]), distance);
+            distance = _mm256_fmadd_ps(center[2], _mm256_set1_ps(view.planes[p][2]), distance);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+        }
+
+        int mask = _mm256_movemask_ps(inside);
+        if (end - i < TRANSFORM_BATCH)
+        {
+            mask &= (1 << (end - i)) - 1;
+        }
+        if (mask == 0)
+        {
+            continue;
+        }
+
+        alignas(32) float matrix[16][TRANSFORM_BATCH];
+        if (world != nullptr)
+        {
+            for (int column = 0; column < 4; column++)
+            {
+                const float* l = view.local + 4 * column;
+                __m256 a[3];
+                for (int row = 0; row < 3; row++)
+                {
+                    __m256 value = _mm256_mul_ps(t[row], _mm256_set1_ps(l[3]));
+                    value = _mm256_fmadd_ps(r[0][row], _mm256_set1_ps(l[0]), value);
+                    value = _mm256_fmadd_ps(r[1][row], _mm256_set1_ps(l[1]), value);
+                    a[row] = _mm256_fmadd_ps(r[2][row], _mm256_set1_ps(l[2]), value);
+                }
+                for (int row = 0; row < 4; row++)
+                {
+                    __m256 value = _mm256_set1_ps(view.parent[12 + row] * l[3]);
+                    value = _mm256_fmadd_ps(_mm256_set1_ps(view.parent[row]), a[0], value);
+                    value = _mm256_fmadd_ps(_mm256_set1_ps(view.parent[4 + row]), a[1], value);
+                    value = _mm256_fmadd_ps(_mm256_set1_ps(view.parent[8 + row]), a[2], value);
+                    _mm256_store_ps(matrix[4 * column + row], value);
+                }
+            }
+        }
+
+        for (size_t lane = 0; lane < TRANSFORM_BATCH; lane++)
+        {
+            if ((mask >> lane) & 1)
+            {
+                if (world != nullptr)
+                {
+                    for (int element = 0; element < 16; element++)
+                    {
+                        world[visibleCount * 16 + element] = matrix[element][lane];
+                    }
+                }
+                visible[visibleCount++] = static_cast<uint32_t>(i + lane);
+            }
+        }
+    }
+    return visibleCount;
+}
+
+#else
+
+// компилятор без AVX2: transformKernelSupported() этот путь не выберет
+bool transformAvx2Compiled()
+{
+    return false;
+}
+
+size_t transformCullAvx2(const TransformView& view, size_t begin, size_t end, uint32_t* visible, float* world)
+{
+    return transformCullScalar(view, begin, end, visible, world);
+}
+
+#endif
@@ -4,11 +4,54 @@
 
 #include "TriangleVulkan.h"
 
+TriangleVulkan::TriangleVulkan(const AppOptions& options) : options(options), vertexLayout(VertexLayout::get(options.vertexFormat, options.splitVertexStreams))
+{
+    // без swap chain расширение VK_KHR_swapchain не нужно, и устройство без него тоже подходит
+    if (options.headless)
+    {
+        deviceExtensions.clear();
+    }
+}
+
 void TriangleVulkan::run()
 {
-    initWindow();
+    // только CPU: ни окно, ни устройство не нужны
+    if (options.vertexFormatReport)
+    {
+        vertexFormatReport();
+        return;
+    }
+    if (options.transformBenchmark)
+    {
+        transformBenchmark();
+        return;
+    }
+
+    if (!options.headless)
+    {
+        startup.step("initWindow", [this]() { initWindow(); });
+    }
     initVulkan();
-    mainLoop();
+    if (options.renderGraphReport)
+    {
+        renderGraphReport();
+    }
+    else if (options.recordScaling)
+    {
+        recordScalingBenchmark();
+    }
+    else if (options.resizeStress)
+    {
+        resizeStressTest();
+    }
+    else if (options.benchmark)
+    {
+        benchmarkLoop();
+    }
+    else
+    {
+        mainLoop();
+    }
     cleanup();
 }
 
@@ -23,41 +66,769 @@ void TriangleVulkan::initWindow()
 }
 
 void TriangleVulkan::mainLoop() {
-    while (!glfwWindowShouldClose(window)) {
+    auto lastLog = std::chrono::steady_clock::now();
+    auto logGpuStats = [&]() {
+        if (options.gpuTiming && std::chrono::steady_clock::now() - lastLog >= std::chrono::seconds(1))
+        {
+            printGpuStats();
+            lastLog = std::chrono::steady_clock::now();
+        }
+    };
+
+    if (options.headless)
+    {
+        for (uint32_t frame = 0; frame < options.frameCount; frame++)
+        {
+            drawFrame();
+            logGpuStats();
+        }
+    }
+    else
+    {
+        uint32_t frame = 0;
+        while (!glfwWindowShouldClose(window) && (options.frameCount == 0 || frame < options.frameCount)) {
+            glfwPollEvents();
+            drawFrame();
+            logGpuStats();
+            frame++;
+        }
+    }
+
+    vkDeviceWaitIdle(device);
+}
+
+// прогрев, затем замер фиксированного количества кадров или фиксированного времени
+void TriangleVulkan::benchmarkLoop()
+{
+    auto windowOpen = [this]() {
+        if (options.headless)
+        {
+            return true;
+        }
         glfwPollEvents();
+        return !glfwWindowShouldClose(window);
+    };
+
+    // загрузка геометрии и компиляция pipeline не должны попасть в измерения, даже если прогрев отключен
+    uploadManager.wait(geometryUpload);
+    pipelineCompiler.waitAll();
+
+    // прогрев: драйвер докомпилирует шейдеры, кэши заполнены, частоты GPU поднялись
+    for (uint32_t frame = 0; frame < options.warmupFrames && windowOpen(); frame++)
+    {
+        drawFrame();
+    }
+
+    frameProfiler.reset();
+    frameProfiler.setRecording(true);
+
+    auto start = std::chrono::steady_clock::now();
+    double elapsedSeconds = 0.0;
+    uint32_t frame = 0;
+
+    while (windowOpen())
+    {
+        if (options.benchmarkSeconds > 0.0 ? elapsedSeconds >= options.benchmarkSeconds : frame >= options.frameCount)
+        {
+            break;
+        }
+
+        frameProfiler.beginFrame();
+        drawFrame();
+        frameProfiler.endFrame();
+
+        frame++;
+        elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // кадры в полете тоже входят в измеренное время
+    vkDeviceWaitIdle(device);
+    elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    frameProfiler.setRecording(false);
+
+    writeReport([&](std::ostream& out) { writeBenchmarkReport(out, elapsedSeconds); });
+}
+
+// Размер окна меняется каждые несколько кадров, swap chain пересоздается на ходу.
+// Интересен худший кадр: при ожидании всего устройства на каждом resize он в разы хуже медианы
+void TriangleVulkan::resizeStressTest()
+{
+    const int MIN_SIZE = 320;
+    const int SIZE_STEPS = 16;
+    const int STEP = 40;
+    const uint32_t FRAMES_PER_RESIZE = 2;
+
+    uploadManager.wait(geometryUpload);
+    pipelineCompiler.waitAll();
+
+    std::vector<double> samples;
+    samples.reserve(options.frameCount);
+    uint32_t recreationsBefore = swapChainRecreations;
+
+    for (uint32_t frame = 0; frame < options.frameCount && !glfwWindowShouldClose(window); frame++)
+    {
+        if (frame % FRAMES_PER_RESIZE == 0)
+        {
+            // "пила" размеров: окно то растет, то сжимается, как при перетаскивании края
+            int step = static_cast<int>(frame / FRAMES_PER_RESIZE) % (2 * SIZE_STEPS);
+            int offset = (step < SIZE_STEPS ? step : 2 * SIZE_STEPS - step) * STEP;
+            glfwSetWindowSize(window, MIN_SIZE + offset, MIN_SIZE + offset * 3 / 4);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        glfwPollEvents(); // framebufferResizeCallback
         drawFrame();
+        auto end = std::chrono::steady_clock::now();
+
+        samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
     }
 
     vkDeviceWaitIdle(device);
+
+    uint32_t recreations = swapChainRecreations - recreationsBefore;
+    TimingStats stats = computeTimingStats(std::move(samples));
+
+    const VkPhysicalDeviceProperties& properties = deviceCaps.properties;
+
+    writeReport([&](std::ostream& out) {
+        out << "{\n"
+            << "  \"device\": \"" << jsonEscape(properties.deviceName) << "\",\n"
+            << "  \"frames\": " << stats.count << ",\n"
+            << "  \"swapchainRecreations\": " << recreations << ",\n"
+            << "  \"worstFrameMs\": " << stats.max << ",\n"
+            << "  \"frameMs\": ";
+        writeTimingStatsJson(out, stats);
+        out << "\n}" << std::endl;
+    });
+}
+
+// Запись одного и того же кадра без отправки: сначала в одном потоке прямо в primary (threads = 0),
+// затем secondary буферами на 1...N потоках. GPU не участвует, меряется только CPU время записи
+void TriangleVulkan::recordScalingBenchmark()
+{
+    uint32_t maxThreads = options.recordThreads > 0 ? options.recordThreads : std::max(1u, std::thread::hardware_concurrency());
+    uint32_t iterations = options.frameCount;
+
+    // буферы не должны быть в полете, пока их перезаписываем; запись без готового pipeline меряла бы не то
+    uploadManager.wait(geometryUpload);
+    pipelineCompiler.waitAll();
+    vkDeviceWaitIdle(device);
+    destroyParallelRecording();
+
+    // запись читает смещения объектов в кольце - заполняем их один раз, как это сделал бы drawFrame()
+    updateUniformBuffer(currentFrame);
+    updateScene();
+    updateObjectUniforms(currentFrame);
+    if (options.meshlets && !options.gpuDriven)
+    {
+        cullMeshlets();
+    }
+
+    std::vector<std::pair<uint32_t, TimingStats>> results;
+    for (uint32_t threads = 0; threads <= maxThreads; threads++)
+    {
+        if (threads > 0)
+        {
+            createParallelRecording(threads);
+        }
+
+        std::vector<double> samples;
+        samples.reserve(iterations);
+        for (uint32_t i = 0; i < options.warmupFrames + iterations; i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            recordCommandBuffer(commandBuffers[currentFrame], 0);
+            auto end = std::chrono::steady_clock::now();
+
+            if (i >= options.warmupFrames)
+            {
+                samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            }
+        }
+        results.emplace_back(threads, computeTimingStats(std::move(samples)));
+
+        destroyParallelRecording();
+    }
+
+    const VkPhysicalDeviceProperties& properties = deviceCaps.properties;
+
+    writeReport([&](std::ostream& out) {
+        out << "{\n"
+            << "  \"device\": \"" << jsonEscape(properties.deviceName) << "\",\n"
+            << "  \"objects\": " << drawList.size() << ",\n"
+            << "  \"iterations\": " << iterations << ",\n"
+            << "  \"recordScaling\": [\n";
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            out << "    {\"threads\": " << results[i].first << ", \"recordMs\": ";
+            writeTimingStatsJson(out, results[i].second);
+            out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}" << std::endl;
+    });
+}
+
+// Сравнение форматов вершин на CPU: размер буфера, скорость кодирования (SSE2 против скалярного пути)
+// и ошибка квантования. Вершины - из --mesh или синтетическая сфера на 1M вершин. Выборку вершин на GPU
+// меряет обычный бенчмарк: --benchmark --gpu-timing --vertex-format F (поле draws и vertex в JSON)
+void TriangleVulkan::vertexFormatReport()
+{
+    uint32_t iterations = options.frameCount > 0 ? options.frameCount : 10;
+
+    std::vector<Vertex> synthetic;
+    const Vertex* source = nullptr;
+    size_t vertexCount = 0;
+    if (!options.meshPath.empty())
+    {
+        loadMeshFile();
+        source = static_cast<const Vertex*>(meshFile->vertexData());
+        vertexCount = meshFile->header().vertexCount;
+    }
+    else
+    {
+        // точки Фибоначчи на слегка неровной сфере, цвет - из направления
+        synthetic.resize(1u << 20);
+        for (size_t i = 0; i < synthetic.size(); i++)
+        {
+            float t = (static_cast<float>(i) + 0.5f) / static_cast<float>(synthetic.size());
+            float z = 1.0f - 2.0f * t;
+            float ring = std::sqrt(1.0f - z * z);
+            float angle = static_cast<float>(i) * 2.39996323f;
+            glm::vec3 direction(ring * std::cos(angle), ring * std::sin(angle), z);
+            synthetic[i].pos = direction * (1.0f + 0.05f * std::sin(angle * 7.0f)) * 3.0f + glm::vec3(10.0f, -2.0f, 0.5f);
+            synthetic[i].color = direction * 0.5f + glm::vec3(0.5f);
+        }
+        source = synthetic.data();
+        vertexCount = synthetic.size();
+    }
+
+    auto measure = [&](const std::function<void()>& encode) {
+        std::vector<double> samples;
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            encode();
+            samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        return computeTimingStats(std::move(samples));
+    };
+
+    QuantizationBounds bounds = QuantizationBounds::compute(source, vertexCount);
+    std::vector<PackedVertex> packed(vertexCount);
+
+    struct FormatResult {
+        VertexFormat format;
+        TimingStats scalar;
+        TimingStats simd;
+        float maxError = 0.0f;
+    };
+    std::vector<FormatResult> results;
+    for (VertexFormat format : {VertexFormat::Half, VertexFormat::Snorm16})
+    {
+        FormatResult result{format};
+        result.scalar = measure([&]() { encodeVertices(source, vertexCount, format, bounds, packed.data(), false); });
+        result.simd = measure([&]() { encodeVertices(source, vertexCount, format, bounds, packed.data(), true); });
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            result.maxError = std::max(result.maxError, glm::length(decodePosition(packed[i], format, bounds) - source[i].pos));
+        }
+        results.push_back(result);
+    }
+
+    // в Vertex нет нормалей - для оценки октаэдрического кодирования берем направления от центра меша
+    std::vector<glm::vec3> normals(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        glm::vec3 direction = source[i].pos - bounds.center;
+        float length = glm::length(direction);
+        normals[i] = length > 0.0f ? direction / length : glm::vec3(0.0f, 0.0f, 1.0f);
+    }
+    std::vector<uint32_t> octNormals(vertexCount);
+    TimingStats octScalar = measure([&]() { encodeNormalsOct16(normals.data(), vertexCount, octNormals.data(), false); });
+    TimingStats octSimd = measure([&]() { encodeNormalsOct16(normals.data(), vertexCount, octNormals.data(), true); });
+    float maxAngle = 0.0f;
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        float cosine = std::clamp(glm::dot(normals[i], decodeNormalOct16(octNormals[i])), -1.0f, 1.0f);
+        maxAngle = std::max(maxAngle, std::acos(cosine));
+    }
+
+    writeReport([&](std::ostream& out) {
+        out << "{\n"
+            << "  \"vertices\": " << vertexCount << ",\n"
+            << "  \"iterations\": " << iterations << ",\n"
+            << "  \"quantizationExtent\": " << bounds.extent << ",\n"
+            << "  \"formats\": [\n"
+            << "    {\"format\": \"float32\", \"stride\": " << sizeof(Vertex) << ", \"bytes\": " << vertexCount * sizeof(Vertex) << "},\n";
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const FormatResult& result = results[i];
+            uint32_t stride = VertexLayout::get(result.format).stride();
+            out << "    {\"format\": \"" << vertexFormatName(result.format) << "\", \"stride\": " << stride
+                << ", \"bytes\": " << vertexCount * stride
+                << ", \"maxPositionError\": " << result.maxError
+                << ", \"encodeScalarMs\": ";
+            writeTimingStatsJson(out, result.scalar);
+            out << ", \"encodeSimdMs\": ";
+            writeTimingStatsJson(out, result.simd);
+            out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ],\n"
+            << "  \"normals\": {\"float32Bytes\": " << vertexCount * sizeof(glm::vec3)
+            << ", \"oct16Bytes\": " << vertexCount * sizeof(uint32_t)
+            << ", \"maxAngleDegrees\": " << glm::degrees(maxAngle)
+            << ", \"encodeScalarMs\": ";
+        writeTimingStatsJson(out, octScalar);
+        out << ", \"encodeSimdMs\": ";
+        writeTimingStatsJson(out, octSimd);
+        out << "}\n}" << std::endl;
+    });
+
+    meshFile.reset();
+}
+
+// Пересчет матриц и отсечение для 10k, 100k и 1M объектов: скалярный путь glm против SSE и AVX2,
+// в одном потоке и на пуле. Объекты - сетка 8 x 8 вокруг центра, камера как в updateUniformBuffer(),
+// так что часть объектов отсекается. Только CPU, Vulkan не создается
+void TriangleVulkan::transformBenchmark()
+{
+    glm::mat4 view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    glm::mat4 proj = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 10.0f);
+    proj[1][1] *= -1;
+    glm::vec4 planes[6];
+    extractFrustumPlanes(proj * view, planes);
+
+    ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()) - 1);
+
+    std::vector<TransformKernel> kernels;
+    for (TransformKernel kernel : {TransformKernel::Scalar, TransformKernel::Sse, TransformKernel::Avx2})
+    {
+        if (transformKernelSupported(kernel))
+        {
+            kernels.push_back(kernel);
+        }
+    }
+
+    struct Result {
+        size_t objects;
+        TransformKernel kernel;
+        uint32_t threads;
+        size_t visible;
+        TimingStats stats;
+    };
+    std::vector<Result> results;
+
+    std::vector<uint32_t> visible;
+    std::vector<glm::mat4> world;
+    for (size_t objectCount : {10000u, 100000u, 1000000u})
+    {
+        TransformSystem transforms;
+        transforms.resize(objectCount);
+        size_t side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(objectCount))));
+        float cell = 8.0f / static_cast<float>(side);
+        for (size_t i = 0; i < objectCount; i++)
+        {
+            glm::vec3 position(-4.0f + cell * (static_cast<float>(i % side) + 0.5f), -4.0f + cell * (static_cast<float>(i / side) + 0.5f), 0.0f);
+            transforms.set(i, position, glm::vec3(0.0f, 0.0f, 1.0f), static_cast<float>(i) * 0.01f, cell * 0.4f);
+        }
+        transforms.setParent(glm::rotate(glm::mat4(1.0f), glm::radians(30.0f), glm::vec3(0.0f, 0.0f, 1.0f)));
+        transforms.setLocal(glm::mat4(1.0f), glm::vec4(0.0f, 0.0f, 0.0f, 0.70710678f));
+
+        // ~20M объектов на замер, не меньше 5 итераций
+        uint32_t iterations = options.frameCount > 0 ? options.frameCount : static_cast<uint32_t>(std::max<size_t>(5, 20000000 / objectCount));
+        for (TransformKernel kernel : kernels)
+        {
+            for (ThreadPool* threads : {static_cast<ThreadPool*>(nullptr), &pool})
+            {
+                size_t visibleCount = transforms.update(planes, kernel, threads, visible, &world); // прогрев и размер буферов
+                std::vector<double> samples;
+                samples.reserve(iterations);
+                for (uint32_t i = 0; i < iterations; i++)
+                {
+                    auto start = std::chrono::steady_clock::now();
+                    transforms.update(planes, kernel, threads, visible, &world);
+                    auto end = std::chrono::steady_clock::now();
+                    samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+                }
+                results.push_back({objectCount, kernel, threads != nullptr ? threads->size() : 1, visibleCount,
+                                   computeTimingStats(std::move(samples))});
+            }
+        }
+    }
+
+    writeReport([&](std::ostream& out) {
+        out << "{\n"
+            << "  \"kernels\": [";
+        for (size_t i = 0; i < kernels.size(); i++)
+        {
+            out << "\"" << transformKernelName(kernels[i]) << "\"" << (i + 1 < kernels.size() ? ", " : "");
+        }
+        out << "],\n"
+            << "  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const Result& result = results[i];
+            out << "    {\"objects\": " << result.objects << ", \"kernel\": \"" << transformKernelName(result.kernel)
+                << "\", \"threads\": " << result.threads << ", \"visible\": " << result.visible
+                << ", \"nsPerObject\": " << result.stats.p50 * 1e6 / static_cast<double>(result.objects) << ", \"ms\": ";
+            writeTimingStatsJson(out, result.stats);
+            out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}" << std::endl;
+    });
+}
+
+// Граф кадра и пример отложенного рендера с временными images: порядок, барьеры и сколько памяти
+// сэкономило наложение. В кадре временных images нет, поэтому aliasing видно только на примере.
+// Проходы примера ничего не записывают - граф только компилируется, но images и память создаются настоящие
+void TriangleVulkan::renderGraphReport()
+{
+    RenderGraph sample("sample");
+    VkExtent2D half{std::max(swapChainExtent.width / 2, 1u), std::max(swapChainExtent.height / 2, 1u)};
+    VkExtent2D quarter{std::max(swapChainExtent.width / 4, 1u), std::max(swapChainExtent.height / 4, 1u)};
+
+    RenderGraph::ResourceId shadowMap = sample.createImage("shadowMap", {VK_FORMAT_D32_SFLOAT, {2048, 2048}});
+    RenderGraph::ResourceId depth = sample.createImage("depth", {VK_FORMAT_D32_SFLOAT, swapChainExtent});
+    RenderGraph::ResourceId hdr = sample.createImage("hdr", {VK_FORMAT_R16G16B16A16_SFLOAT, swapChainExtent});
+    RenderGraph::ResourceId bloomHalf = sample.createImage("bloomHalf", {VK_FORMAT_R16G16B16A16_SFLOAT, half});
+    RenderGraph::ResourceId bloomQuarter = sample.createImage("bloomQuarter", {VK_FORMAT_R16G16B16A16_SFLOAT, quarter});
+    RenderGraph::ResourceId bloomUp = sample.createImage("bloomUp", {VK_FORMAT_R16G16B16A16_SFLOAT, half});
+    RenderGraph::ResourceId debugOut = sample.createImage("debugOut", {VK_FORMAT_R8G8B8A8_UNORM, swapChainExtent});
+    RenderGraph::ResourceId backbuffer = sample.importImage(
+        "backbuffer", {swapChainImageFormat, swapChainExtent}, {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0},
+        {options.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0});
+
+    const VkPipelineStageFlags fragment = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    const VkPipelineStageFlags compute = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+    // debugView добавлен первым и читает depth, но его результат никто не читает - он будет выброшен
+    RenderGraph::PassId debugView = sample.addPass("debugView", RenderGraph::PassKind::Raster, nullptr);
+    RenderGraph::PassId shadows = sample.addPass("shadows", RenderGraph::PassKind::Raster, nullptr);
+    RenderGraph::PassId prepass = sample.addPass("depthPrepass", RenderGraph::PassKind::Raster, nullptr);
+    RenderGraph::PassId lighting = sample.addPass("lighting", RenderGraph::PassKind::Raster, nullptr);
+    RenderGraph::PassId down = sample.addPass("bloomDownsample", RenderGraph::PassKind::Compute, nullptr);
+    RenderGraph::PassId down2 = sample.addPass("bloomDownsample2", RenderGraph::PassKind::Compute, nullptr);
+    RenderGraph::PassId up = sample.addPass("bloomUpsample", RenderGraph::PassKind::Compute, nullptr);
+    RenderGraph::PassId tonemap = sample.addPass("tonemap", RenderGraph::PassKind::Raster, nullptr);
+
+    shadowMap = sample.depthAttachment(shadows, shadowMap, VK_ATTACHMENT_LOAD_OP_CLEAR);
+    depth = sample.depthAttachment(prepass, depth, VK_ATTACHMENT_LOAD_OP_CLEAR);
+
+    sample.sampleImage(debugView, depth, fragment);
+    sample.colorAttachment(debugView, debugOut, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+
+    hdr = sample.colorAttachment(lighting, hdr, VK_ATTACHMENT_LOAD_OP_CLEAR);
+    sample.depthAttachment(lighting, depth, VK_ATTACHMENT_LOAD_OP_LOAD);
+    sample.sampleImage(lighting, shadowMap, fragment);
+
+    sample.sampleImage(down, hdr, compute);
+    bloomHalf = sample.storageImage(down, bloomHalf, compute);
+    sample.sampleImage(down2, bloomHalf, compute);
+    bloomQuarter = sample.storageImage(down2, bloomQuarter, compute);
+    sample.sampleImage(up, bloomQuarter, compute);
+    bloomUp = sample.storageImage(up, bloomUp, compute);
+
+    sample.sampleImage(tonemap, hdr, fragment);
+    sample.sampleImage(tonemap, bloomUp, fragment);
+    sample.colorAttachment(tonemap, backbuffer, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+
+    sample.compile(device, allocator);
+    frameGraph.dump(std::clog);
+    sample.dump(std::clog);
+
+    writeReport([&](std::ostream& out) {
+        out << "{\n"
+            << "  \"frame\": ";
+        frameGraph.writeJson(out);
+        out << ",\n"
+            << "  \"sample\": ";
+        sample.writeJson(out);
+        out << "\n}" << std::endl;
+    });
+    sample.destroy();
+}
+
+// отчет в stdout или в файл --benchmark-out
+void TriangleVulkan::writeReport(const std::function<void(std::ostream&)>& write)
+{
+    if (options.benchmarkOutput.empty())
+    {
+        write(std::cout);
+    }
+    else
+    {
+        std::ofstream file(options.benchmarkOutput);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("failed to open benchmark output file: " + options.benchmarkOutput);
+        }
+        write(file);
+    }
+}
+
+void TriangleVulkan::writeBenchmarkReport(std::ostream& out, double elapsedSeconds)
+{
+    const VkPhysicalDeviceProperties& properties = deviceCaps.properties;
+
+    size_t frames = frameProfiler.recordedFrames();
+
+    out << "{\n"
+        << "  \"device\": \"" << jsonEscape(properties.deviceName) << "\",\n"
+        << "  \"vendorID\": " << properties.vendorID << ",\n"
+        << "  \"deviceID\": " << properties.deviceID << ",\n"
+        << "  \"driverVersion\": " << properties.driverVersion << ",\n"
+        << "  \"mode\": \"" << (options.headless ? "headless" : "windowed") << "\",\n"
+        << "  \"extent\": [" << swapChainExtent.width << ", " << swapChainExtent.height << "],\n"
+        << "  \"framesInFlight\": " << MAX_FRAMES_IN_FLIGHT << ",\n"
+        << "  \"objects\": " << drawList.size() << ",\n"
+        << "  \"recordThreads\": " << recordSlotCount << ",\n"
+        << "  \"instanced\": " << (options.instanced ? "true" : "false") << ",\n"
+        << "  \"pushConstants\": " << (options.pushConstants ? "true" : "false") << ",\n"
+        << "  \"sync\": \"" << (options.timelineSync ? "timeline" : "binary") << "\",\n"
+        << "  \"asyncQueues\": {\"compute\": " << (asyncCulling ? "true" : "false")
+        << ", \"transfer\": " << (options.timelineSync && queueScheduler.isDedicated(QueueKind::Transfer) ? "true" : "false") << "},\n"
+        << "  \"vertex\": {\"format\": \"" << vertexFormatName(vertexLayout.format) << "\", \"streams\": " << vertexLayout.bindings.size()
+        << ", \"stride\": " << vertexLayout.stride()
+        << ", \"bufferBytes\": " << vertexBufferSize << "},\n"
+        << "  \"meshlets\": ";
+    if (options.meshlets)
+    {
+        // доля видимых известна только у CPU отсечения - compute не возвращает счетчики на CPU
+        out << "{\"count\": " << meshlets.size() << ", \"visibleFraction\": ";
+        if (meshletsTested > 0)
+        {
+            out << static_cast<double>(meshletsVisible) / static_cast<double>(meshletsTested);
+        }
+        else
+        {
+            out << "null";
+        }
+        out << "}";
+    }
+    else
+    {
+        out << "false";
+    }
+    out << ",\n"
+        << "  \"cpuCulling\": ";
+    if (options.cpuCulling)
+    {
+        out << "{\"kernel\": \"" << transformKernelName(transformKernel) << "\", \"threads\": " << cullPool->size()
+            << ", \"visibleFraction\": " << (cpuCullTested > 0 ? static_cast<double>(cpuCullVisible) / static_cast<double>(cpuCullTested) : 0.0) << "}";
+    }
+    else
+    {
+        out << "false";
+    }
+    // средние за кадр: статичная сцена - нули, копия буфера целиком (первые кадры) тоже входит в байты
+    double sceneFrameCount = sceneFrames > 0 ? static_cast<double>(sceneFrames) : 1.0;
+    out << ",\n"
+        << "  \"scene\": {\"nodes\": " << scene.size() << ", \"preorder\": " << (scene.isPreorder() ? "true" : "false")
+        << ", \"dirtyNodesPerFrame\": " << static_cast<double>(sceneDirtyNodes) / sceneFrameCount
+        << ", \"uploadBytesPerFrame\": " << static_cast<double>(instanceUploadBytes) / sceneFrameCount << "},\n"
+        << "  \"renderGraph\": ";
+    frameGraph.writeJson(out);
+    out << ",\n"
+        << "  \"gpuDriven\": " << (options.gpuDriven ? (drawIndirectCountSupported ? "\"indirectCount\"" : "\"indirect\"") : "false") << ",\n"
+        << "  \"warmupFrames\": " << options.warmupFrames << ",\n"
+        << "  \"frames\": " << frames << ",\n"
+        << "  \"seconds\": " << elapsedSeconds << ",\n"
+        << "  \"fps\": " << (elapsedSeconds > 0.0 ? static_cast<double>(frames) / elapsedSeconds : 0.0) << ",\n"
+        << "  \"startup\": ";
+    startup.writeJson(out);
+    out << ",\n";
+
+    AllocatorStats memory = allocator.stats();
+    out << "  \"memory\": {\"bytesUsed\": " << memory.bytesUsed
+        << ", \"bytesReserved\": " << memory.bytesReserved
+        << ", \"allocations\": " << memory.allocationCount
+        << ", \"blocks\": " << memory.blockCount << "},\n"
+        << "  ";
+    frameProfiler.writeJson(out);
+    out << "\n}" << std::endl;
+}
+
+void TriangleVulkan::printGpuStats()
+{
+    const GpuFrameStats& stats = gpuProfiler.lastStats();
+    if (!stats.valid)
+    {
+        return;
+    }
+
+    std::cout << "GPU: render pass " << stats.renderPassMs << " ms, draws " << stats.totalDrawMs() << " ms";
+    if (stats.hasPipelineStatistics)
+    {
+        std::cout << ", VS invocations " << stats.vertexShaderInvocations
+                  << ", clipping primitives " << stats.clippingPrimitives
+                  << ", FS invocations " << stats.fragmentShaderInvocations;
+    }
+    std::cout << std::endl;
 }
 
 void TriangleVulkan::initVulkan()
 {
-    createInstance();           // Получить расширения, заполнить VkApplicationInfo, VkInstanceCreateInfo, создать Instance
-    setupDebugMessenger();
-    createSurface();            // Создать окно и связать его с поверхностью (Surface) для рендеринга
+    // Последовательно: от instance и device зависит все остальное
+    startup.step("createInstance", [this]() { createInstance(); });         // Получить расширения, заполнить VkApplicationInfo, VkInstanceCreateInfo, создать Instance
+    startup.step("setupDebugMessenger", [this]() { setupDebugMessenger(); });
+    if (!options.headless)
+    {
+        startup.step("createSurface", [this]() { createSurface(); });       // Создать окно и связать его с поверхностью (Surface) для рендеринга
+    }
+
+    startup.step("pickPhysicalDevice", [this]() { pickPhysicalDevice(); });   // Выбрать физическое устройство и один раз запросить его возможности
+    startup.step("createLogicalDevice", [this]() { createLogicalDevice(); }); // Создать логическое устройство на основе выбранного физического устройства и семейства очередей
+    startup.step("initAllocator", [this]() { allocator.init(device, deviceCaps); }); // Память под буферы/images раздается из больших блоков
+    startup.step("initQueues", [this]() {
+        if (options.timelineSync)
+        {
+            // timeline на каждую очередь; без --async-queues все виды работы идут в graphics очередь
+            queueScheduler.init(device, familyIndices.graphicsFamily.value(),
+                                options.asyncQueues ? familyIndices.computeFamily : std::nullopt,
+                                options.asyncQueues ? familyIndices.transferFamily : std::nullopt);
+            uploadManager.init(device, allocator, queueScheduler.queue(QueueKind::Transfer), queueScheduler.family(QueueKind::Transfer),
+                               &queueScheduler.timeline(QueueKind::Transfer), familyIndices.graphicsFamily.value());
+            if (options.asyncQueues)
+            {
+                auto describe = [this](QueueKind kind) {
+                    return queueScheduler.isDedicated(kind) ? "family " + std::to_string(queueScheduler.family(kind)) : std::string("shared with graphics");
+                };
+                std::clog << "async queues: compute " << describe(QueueKind::Compute)
+                          << ", transfer " << describe(QueueKind::Transfer) << std::endl;
+            }
+        }
+        else
+        {
+            uploadManager.init(device, allocator, graphicsQueue, familyIndices.graphicsFamily.value());
+        }
+    });
+
+    // Дальше граф: swap chain и все, что зависит от surface, - в основном потоке,
+    // чтение кэша и SPIR-V, компиляция pipeline и загрузки - параллельно на рабочих потоках.
+    // Каждый из ShaderLibrary, PipelineCache и UploadManager используется одной цепочкой задач за раз,
+    // DeviceAllocator защищен своим mutex
+    using TaskId = InitGraph::TaskId;
+    const bool MAIN_THREAD = true;
+
+    TaskId cache = startup.add("pipelineCache.init", [this]() {
+        pipelineCache.init(device, deviceCaps, options.pipelineCachePath, pipelineFeedbackSupported); // Прочитать кэш pipeline прошлого запуска
+        pipelineCompiler.init(device, pipelineCache, options.pipelineThreads); // потоки компиляции пишут в этот кэш
+    });
+    TaskId shaders = startup.add("preloadShaders", [this]() { preloadShaders(); });
+    TaskId setLayout = startup.add("createDescriptorSetLayout", [this]() { createDescriptorSetLayout(); }); // описать вулкану какие наборы данных будут передаваться в шейдер
+
+    TaskId swapChainTask = startup.add(options.headless ? "createOffscreenTargets" : "createSwapChain", [this]() {
+        if (options.headless)
+        {
+            createOffscreenTargets(); // Создать собственные VkImage вместо images из SwapChain
+        }
+        else
+        {
+            createSwapChain();        // Создать SwapChain на основе поддерживаемых форматов
+        }
+    }, {}, MAIN_THREAD);
+    startup.add("createImageViews", [this]() { createImageViews(); }, {swapChainTask}, MAIN_THREAD);
+    // render pass основного прохода нужен pipeline; framebuffers граф создает при первом кадре
+    TaskId frameGraphTask = startup.add("createFrameGraph", [this]() { createFrameGraph(); }, {swapChainTask}, MAIN_THREAD);
+
+    // Прочитать шейдеры из библиотеки, настроить информацию о pipeline и создать графический pipeline
+    TaskId pipelines = startup.add("createGraphicsPipeline", [this]() { createGraphicsPipeline(); },
+                                   {cache, shaders, setLayout, frameGraphTask});
+
+    TaskId mesh = startup.add("loadMesh", [this]() { loadMesh(); }); // заголовок .vmesh: размеры, тип индексов, границы
+    TaskId geometry = startup.add("uploadGeometry", [this]() {
+        createVertexBuffer();     // мы хотим отправлять данные о вершинах разом, а не по одному
+        createIndexBuffer();
+        uploadManager.flush();    // отправить копирования вершин/индексов одним батчем; кадры в той же очереди увидят их после барьера
+        meshFile.reset();         // данные уже в staging или в отправленных батчах - отображение больше не нужно
+        std::vector<uint8_t>().swap(vertexData);
+    }, {mesh});
+    TaskId objects = startup.add("createObjectBuffers", [this]() {
+        createDrawList();          // Объекты, которые рисуются каждый кадр (до буферов, которые от них зависят)
+        createUniformBuffer();
+        createObjectUniformRing(); // uniform данные каждого объекта, привязываются dynamic offset
+        if (options.instanced)
+        {
+            createInstanceBuffers(); // transform и цвет каждой копии меша
+        }
+    }, {mesh});
+
+    // буферы объектов и indirect команд, compute pipeline отсечения: загрузка после геометрии, pipeline после графических
+    if (options.gpuDriven)
+    {
+        startup.add("createCullingResources", [this]() { createCullingResources(); }, {geometry, objects, pipelines});
+    }
+    startup.add("createDescriptorSets", [this]() {
+        createDescriptorPool();   // дескриптор pool состоит из дескриптор sets
+        createDescriptorSets();   // набор данных для шейдера соответствующий дескриптор layout
+    }, {setLayout, objects});
+
+    startup.add("createCommandBuffers", [this]() {
+        createCommandPool();      // Command Pool для управления очередями команд на основе индекса семейства очередей
+        createCommandBuffers();   // Command Buffer для записи команд рендеринга
+        if (options.recordThreads > 0)
+        {
+            createParallelRecording(options.recordThreads); // Пулы команд и secondary буферы на каждый поток записи
+        }
+    });
+    startup.add("createSyncObjects", [this]() { createSyncObjects(); }); // семафоры и fence для синхронизации кадров
 
-    pickPhysicalDevice();        // Выбрать физическое устройство, поддерживающее нужные расширения, включая поддержку SwapChain и семейств очередей
-    createLogicalDevice();       // Создать логическое устройство на основе выбранного физического устройства и семейства очередей
+    if (options.gpuTiming)
+    {
+        startup.add("gpuProfiler.init", [this]() {
+            gpuProfiler.init(device, deviceCaps, familyIndices.graphicsFamily.value(), MAX_FRAMES_IN_FLIGHT, options.pipelineStatistics);
+        });
+    }
+
+    if (options.serialInit)
+    {
+        startup.run(nullptr);
+    }
+    else
+    {
+        ThreadPool initPool(std::max(2u, std::thread::hardware_concurrency()) - 1);
+        startup.run(&initPool);
+    }
 
-    createSwapChain();           // Создать SwapChain на основе поддерживаемых форматов
-    createImageViews();          // Создать Image Views на основе изображений из SwapChain для рендеринга
-    createRenderPass();          // создать Render Pass
-    createDescriptorSetLayout(); // описать вулкану какие наборы данных будут передаваться в шейдер (юниформы, текстуры)
+    if (options.gpuTiming && !gpuProfiler.isEnabled())
+    {
+        std::cerr << "GPU timing requested, but the graphics queue does not support timestamps" << std::endl;
+    }
 
-    createGraphicsPipeline();    // Прочитать шейдеры, создать шейдерные модули, настроить информацию о pipeline и создать графический pipeline
-    createFramebuffers();        // Создать Framebuffers для каждого images из SwapChain
-    createCommandPool();         // Создать Command Pool для управления очередями команд на основе индекса семейства очередей
+    // в stderr: stdout может быть занят JSON отчетом бенчмарка
+    allocator.printStats(std::clog);
+    uploadManager.printStats(std::clog);
+    shaderLibrary.printStats(std::clog);
+    if (options.startupReport)
+    {
+        startup.printReport(std::clog);
+    }
+}
 
-    createVertexBuffer();        // мы хотим отправлять данные о вершинах разом, а не по одному
-    createIndexBuffer();         // мы хотим отправлять данные о вершинах разом, а не по одному
+// Все модули, которые понадобятся pipeline этого запуска: файлы читаются параллельно со swap chain,
+// а createGraphicsPipeline/createCullingResources получают уже готовые модули из кэша библиотеки
+void TriangleVulkan::preloadShaders()
+{
+    shaderLibrary.init(device, options.shaderDir);
 
-    createUniformBuffer();       // мы хотим отправлять данные о вершинах разом, а не по одному
-    createDescriptorPool();      // дескриптор pool состоит из дескриптор sets
-    createDescriptorSets();      // набор данных для шейдера соответствующий дескриптор layout
+    std::vector<std::string> names = {"shader.vert.spv", "shader.frag.spv"};
+    if (options.instanced)
+    {
+        names.push_back("instanced.vert.spv");
+    }
+    if (options.pushConstants)
+    {
+        names.push_back("push.vert.spv");
+    }
+    if (options.gpuDriven)
+    {
+        names.push_back("cull.comp.spv");
+    }
 
-    createCommandBuffers();      // Создать Command Buffer для записи команд рендеринга на основе commandPool
-    createSyncObjects();         // Создать семафоры для синхронизации между очередями на основе VkSemaphore
+    for (const auto& name : names)
+    {
+        shaderLibrary.getModule(name);
+    }
 }
 
 void TriangleVulkan::createInstance()
@@ -114,16 +885,43 @@ void TriangleVulkan::createSurface()
 
 std::vector<const char*> TriangleVulkan::checkGlfwExtension()
 {
-    uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    std::vector<const char*> extensions;
 
-    std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    // в headless режиме GLFW не инициализирован и surface расширения не нужны
+    if (!options.headless)
+    {
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions;
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
 
     if (enableValidationLayers) {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
     }
 
+    // instance 1.0: VK_KHR_timeline_semaphore устройства требует VK_KHR_get_physical_device_properties2 у instance
+    if (options.timelineSync)
+    {
+        uint32_t extensionCount = 0;
+        vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> available(extensionCount);
+        vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, available.data());
+
+        bool found = std::any_of(available.begin(), available.end(), [](const VkExtensionProperties& extension) {
+            return std::strcmp(extension.extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0;
+        });
+        if (found)
+        {
+            extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+        }
+        else
+        {
+            std::cerr << "VK_KHR_get_physical_device_properties2 is not supported by this instance, falling back to --sync binary" << std::endl;
+            options.timelineSync = false;
+        }
+    }
+
     return extensions;
 }
 
@@ -162,11 +960,20 @@ void TriangleVulkan::pickPhysicalDevice()
             physicalDevice = device;
             break;
         }
+    }
 
-        if (physicalDevice == VK_NULL_HANDLE)
-        {
-            throw std::runtime_error("failed to find a suitable GPU");
-        }
+    // проверка после перебора всех устройств: первое неподходящее (например lavapipe рядом с GPU) не должно ронять выбор
+    if (physicalDevice == VK_NULL_HANDLE)
+    {
+        throw std::runtime_error("failed to find a suitable GPU");
+    }
+
+    // дальше устройство не меняется: его свойства, семейства очередей и форматы surface больше не запрашиваем
+    deviceCaps = DeviceCaps::query(physicalDevice);
+    familyIndices = findQueueFamilies(physicalDevice);
+    if (!options.headless)
+    {
+        swapChainSupport = queueSwapChainSupport(physicalDevice);
     }
 }
 
@@ -174,9 +981,9 @@ bool TriangleVulkan::isDeviceSuitable(const VkPhysicalDevice& device)
 {
     QueueFamilyIndices indices = findQueueFamilies(device);
     bool extensionSupported = checkDeviceExtensionSupport(device);
-    bool swapChainSupported = false;
+    bool swapChainSupported = options.headless; // в headless режиме swap chain не нужен
 
-    if (extensionSupported)
+    if (extensionSupported && !options.headless)
     {
         SwapChainSupportDetails swapChainSupport  = queueSwapChainSupport(device);
         swapChainSupported = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
@@ -200,25 +1007,42 @@ QueueFamilyIndices TriangleVulkan::findQueueFamilies(const VkPhysicalDevice& dev
     for (const auto& queueFamily : queueFamilies)
     {
         // проверяем, поддерживает ли конкретное семейство очередей графические операции
-        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        if ((queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) && !indices.graphicsFamily.has_value())
         {
             indices.graphicsFamily = i;
         }
 
-        // проверяем, поддерживает ли конкретное семейство очередей возможность вывода на экран(surface)
-        VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+        // выделенные семейства: compute без графики (async compute), transfer без графики и compute (DMA)
+        bool graphics = (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+        bool compute = (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+        bool transfer = (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) != 0;
+        if (compute && !graphics && !indices.computeFamily.has_value())
+        {
+            indices.computeFamily = i;
+        }
+        if (transfer && !graphics && !compute && !indices.transferFamily.has_value())
+        {
+            indices.transferFamily = i;
+        }
 
-        if (presentSupport)
+        // проверяем, поддерживает ли конкретное семейство очередей возможность вывода на экран(surface)
+        VkBool32 presentSupport = false;
+        if (options.headless)
         {
-            indices.presentFamily = i;
+            // surface нет, выводить некуда: "present" очередью считаем графическую
+            presentSupport = (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+        }
+        else
+        {
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
         }
 
-        if (indices.isComplete())
+        if (presentSupport && !indices.presentFamily.has_value())
         {
-            break;
+            indices.presentFamily = i;
         }
 
+        // не останавливаемся на первом подходящем: выделенные семейства обычно идут после графического
         i++;
     }
 
@@ -247,7 +1071,7 @@ void TriangleVulkan::printVkExtensions(const std::vector<VkExtensionProperties>
 
 void TriangleVulkan::createLogicalDevice()
 {
-    QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+    const QueueFamilyIndices& indices = familyIndices;
 
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(), indices.presentFamily.value()};
@@ -264,15 +1088,104 @@ void TriangleVulkan::createLogicalDevice()
     }
 
     VkPhysicalDeviceFeatures deviceFeatures{}; // ?
+    const VkPhysicalDeviceFeatures& supportedFeatures = deviceCaps.features;
+
+    // pipeline statistics запросы - опциональная возможность устройства, включаем только если попросили
+    if (options.pipelineStatistics)
+    {
+        if (supportedFeatures.pipelineStatisticsQuery)
+        {
+            deviceFeatures.pipelineStatisticsQuery = VK_TRUE;
+        }
+        else
+        {
+            std::cerr << "pipeline statistics queries are not supported by this device" << std::endl;
+            options.pipelineStatistics = false;
+        }
+    }
+
+    // GPU-driven: indirect команды ссылаются на InstanceData через firstInstance - без drawIndirectFirstInstance никак
+    if (options.gpuDriven)
+    {
+        if (supportedFeatures.drawIndirectFirstInstance)
+        {
+            deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
+            // без multiDrawIndirect drawCount > 1 нельзя - тогда по одному vkCmdDrawIndexedIndirect на объект
+            multiDrawIndirectSupported = supportedFeatures.multiDrawIndirect == VK_TRUE;
+            deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+        }
+        else
+        {
+            std::cerr << "drawIndirectFirstInstance is not supported by this device, falling back to --instanced" << std::endl;
+            options.gpuDriven = false;
+            // один instanced draw не учитывает видимость кластеров (см. проверку --meshlets в parseAppOptions)
+            if (options.meshlets)
+            {
+                std::cerr << "--meshlets cannot be combined with --instanced, meshlets are disabled" << std::endl;
+                options.meshlets = false;
+            }
+        }
+    }
+
+    // обязательные расширения + необязательные, которые есть у устройства
+    std::vector<const char*> enabledExtensions = deviceExtensions;
+    pipelineFeedbackSupported = deviceCaps.hasExtension(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+    if (pipelineFeedbackSupported)
+    {
+        enabledExtensions.push_back(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+    }
+    drawIndirectCountSupported = options.gpuDriven && deviceCaps.hasExtension(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    if (drawIndirectCountSupported)
+    {
+        enabledExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    }
+
+    // timeline семафоры: у устройства с расширением фича timelineSemaphore обязательна, но ее надо включить
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{};
+    timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+    timelineFeatures.timelineSemaphore = VK_TRUE;
+    if (options.timelineSync)
+    {
+        if (deviceCaps.hasExtension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME))
+        {
+            enabledExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+        }
+        else
+        {
+            std::cerr << "VK_KHR_timeline_semaphore is not supported by this device, falling back to --sync binary" << std::endl;
+            options.timelineSync = false;
+        }
+    }
+
+    // выделенные очереди синхронизируются timeline семафорами - без них остаемся на одной очереди
+    if (options.asyncQueues && !options.timelineSync)
+    {
+        options.asyncQueues = false;
+    }
+    if (options.asyncQueues)
+    {
+        for (auto family : {indices.computeFamily, indices.transferFamily})
+        {
+            if (family.has_value() && uniqueQueueFamilies.insert(family.value()).second)
+            {
+                VkDeviceQueueCreateInfo queueCreateInfo{};
+                queueCreateInfo.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+                queueCreateInfo.queueFamilyIndex = family.value();
+                queueCreateInfo.queueCount       = 1;
+                queueCreateInfo.pQueuePriorities = &queuePriority;
+                queueCreateInfos.push_back(queueCreateInfo);
+            }
+        }
+    }
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    createInfo.enabledExtensionCount   = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    createInfo.pNext                   = options.timelineSync ? &timelineFeatures : nullptr;
+    createInfo.enabledExtensionCount   = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
     createInfo.queueCreateInfoCount    = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos       = queueCreateInfos.data();
     createInfo.pEnabledFeatures        = &deviceFeatures;
-    createInfo.enabledExtensionCount   = static_cast<uint32_t>(deviceExtensions.size());
     createInfo.enabledLayerCount       = 0;
 
     if (vkCreateDevice(physicalDevice, &createInfo, nullptr, &device) != VK_SUCCESS)
@@ -286,6 +1199,14 @@ void TriangleVulkan::createLogicalDevice()
     // по индексу который сохранил при проверке
     vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphicsQueue);
     vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
+
+    // функции расширений не экспортируются загрузчиком напрямую
+    if (drawIndirectCountSupported)
+    {
+        cmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+                vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR"));
+        drawIndirectCountSupported = cmdDrawIndexedIndirectCount != nullptr;
+    }
 }
 
 //проверяем, поддерживает ли устройство все необходимые расширения(swap chain) для работы
@@ -410,16 +1331,33 @@ void TriangleVulkan::recreateSwapChain()
         glfwWaitEvents();
     }
 
-    vkDeviceWaitIdle(device);
-    cleanupSwapChain();
-    createSwapChain();
+    // без vkDeviceWaitIdle: кадры в полете продолжают работать со старыми объектами,
+    // а те удаляются, когда завершится последний уже отправленный кадр
+    VkSwapchainKHR oldSwapChain = swapChain;
+    std::vector<VkImageView> oldImageViews = swapChainImageViews;
+    std::vector<VkFramebuffer> oldFramebuffers = frameGraph.releaseFramebuffers(); // новые граф создаст под новые views
+
+    createSwapChain(); // oldSwapchain = текущая swap chain
     createImageViews();
-    createFramebuffers();
+    swapChainRecreations++;
+
+    deletionQueue.push(submittedFrames, [this, oldSwapChain, oldImageViews, oldFramebuffers]() {
+        for (auto framebuffer : oldFramebuffers)
+        {
+            vkDestroyFramebuffer(device, framebuffer, nullptr);
+        }
+        for (auto imageView : oldImageViews)
+        {
+            vkDestroyImageView(device, imageView, nullptr);
+        }
+        vkDestroySwapchainKHR(device, oldSwapChain, nullptr);
+    });
 }
 
 void TriangleVulkan::createSwapChain()
 {
-    SwapChainSupportDetails swapChainSupport  = queueSwapChainSupport(physicalDevice);
+    // форматы и present modes surface сохранены при выборе устройства; от размера окна зависят только capabilities
+    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, &swapChainSupport.capabilities);
     VkSurfaceFormatKHR surfaceFormat = chooseSwapChainFormats(swapChainSupport.formats);
     VkPresentModeKHR presentMode = chooseSwapChainPresent(swapChainSupport.presentModes);
     VkExtent2D extent = chooseSwapChainExtent(swapChainSupport.capabilities);
@@ -445,7 +1383,7 @@ void TriangleVulkan::createSwapChain()
     createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT; // для каких операций будут использоваться images, полученные из swap chain
 
     // затем нужно указать как обрабатывать images
-    QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+    const QueueFamilyIndices& indices = familyIndices;
     uint32_t queueFamilyIndices[] = {indices.graphicsFamily.value(), indices.presentFamily.value()};
 
     if (indices.graphicsFamily != indices.presentFamily)
@@ -471,13 +1409,17 @@ void TriangleVulkan::createSwapChain()
 
     // Если swap chain станет недействительной, например, из-за изменения размера окна
     // ее нужно будет воссоздать с нуля и в поле oldSwapChain указать ссылку на старую swap chain
-   // createInfo.oldSwapchain = swapChain; // я не понимаю как это говно работает
+    // старая swap chain остается валидной: кадры в полете дорисуют и покажут ее images,
+    // а драйвер может переиспользовать ее ресурсы. Удаляет ее recreateSwapChain() через очередь удаления
+    createInfo.oldSwapchain = swapChain;
 
-    if (vkCreateSwapchainKHR(device, &createInfo, nullptr, &swapChain) != VK_SUCCESS)
+    VkSwapchainKHR newSwapChain = VK_NULL_HANDLE;
+    if (vkCreateSwapchainKHR(device, &createInfo, nullptr, &newSwapChain) != VK_SUCCESS)
     {
 
         throw std::runtime_error("\nfailed to create swap chain!");
     }
+    swapChain = newSwapChain;
 
     // потом нужно получить Images в swapChain
     vkGetSwapchainImagesKHR(device,swapChain,&imageCount,nullptr);
@@ -489,13 +1431,64 @@ void TriangleVulkan::createSwapChain()
     swapChainExtent = extent;
 }
 
-void TriangleVulkan::createGraphicsPipeline()
+// Headless: те же роли, что у images из swap chain, но VkImage и память создаем сами.
+// Дальше createImageViews/граф кадра/drawFrame работают с ними как с обычными swapChainImages
+void TriangleVulkan::createOffscreenTargets()
+{
+    swapChainImageFormat = OFFSCREEN_FORMAT;
+    swapChainExtent = { static_cast<uint32_t>(WIDTH), static_cast<uint32_t>(HEIGHT) };
+
+    // по одному image на кадр в полете - acquire не нужен, индекс image совпадает с currentFrame
+    swapChainImages.resize(MAX_FRAMES_IN_FLIGHT);
+    offscreenImagesMemory.resize(MAX_FRAMES_IN_FLIGHT);
+
+    for (size_t i = 0; i < swapChainImages.size(); i++)
+    {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = swapChainImageFormat;
+        imageInfo.extent = { swapChainExtent.width, swapChainExtent.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT; // TRANSFER_SRC - чтобы кадр можно было скопировать для проверки
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(device, &imageInfo, nullptr, &swapChainImages[i]) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create offscreen image!");
+        }
+
+        VkMemoryRequirements memRequirements{};
+        vkGetImageMemoryRequirements(device, swapChainImages[i], &memRequirements);
+
+        offscreenImagesMemory[i] = allocator.allocate(memRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, ResourceKind::Optimal);
+        vkBindImageMemory(device, swapChainImages[i], offscreenImagesMemory[i].memory, offscreenImagesMemory[i].offset);
+    }
+}
+
+void TriangleVulkan::cleanupOffscreenTargets()
 {
-    auto vertShaderCode  = readFile("../shaders/vert.spv");
-    auto fragShaderCode  = readFile("../shaders/frag.spv");
+    for (auto imageView : swapChainImageViews)
+    {
+        vkDestroyImageView(device, imageView, nullptr);
+    }
+
+    for (size_t i = 0; i < swapChainImages.size(); i++)
+    {
+        vkDestroyImage(device, swapChainImages[i], nullptr);
+        allocator.free(offscreenImagesMemory[i]);
+    }
+}
 
-    VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-    VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+void TriangleVulkan::createGraphicsPipeline()
+{
+    // модули берутся из кэша библиотеки: при повторном создании pipeline файлы не читаются заново
+    VkShaderModule vertShaderModule = shaderLibrary.getModule("shader.vert.spv");
+    VkShaderModule fragShaderModule = shaderLibrary.getModule("shader.frag.spv");
 
     VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
     vertShaderStageInfo.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -512,15 +1505,15 @@ void TriangleVulkan::createGraphicsPipeline()
     VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo,fragShaderStageInfo};
 
     // настройка вершинного буфера
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions();
+    const auto& bindingDescriptions = vertexLayout.bindings;
+    const auto& attributeDescriptions = vertexLayout.attributes;
 
     // описывает формат данных вершин, которые передаются в вершинный шейдер
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount   = 1;
+    vertexInputInfo.vertexBindingDescriptionCount   = static_cast<uint32_t>(bindingDescriptions.size());
     vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.pVertexBindingDescriptions      = &bindingDescription;
+    vertexInputInfo.pVertexBindingDescriptions      = bindingDescriptions.data();
     vertexInputInfo.pVertexAttributeDescriptions    = attributeDescriptions.data();
 
     // какая геометрия образуется из вершин и разрешен ли рестарт геометрии для таких геометрий,
@@ -604,6 +1597,14 @@ void TriangleVulkan::createGraphicsPipeline()
     pipelineLayoutInfo.setLayoutCount         = 1;
     pipelineLayoutInfo.pSetLayouts            = &descriptorSetLayout;
 
+    // push constants - небольшой блок данных прямо в командном буфере, без памяти и дескрипторов
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags              = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset                  = 0;
+    pushConstantRange.size                    = sizeof(DrawPushConstants);
+
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges    = &pushConstantRange;
 
     if (vkCreatePipelineLayout(device,&pipelineLayoutInfo,nullptr,&pipelineLayout) != VK_SUCCESS)
     {
@@ -626,89 +1627,80 @@ void TriangleVulkan::createGraphicsPipeline()
     pipelineInfo.renderPass             = renderPass;
     pipelineInfo.subpass                = 0;
 
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create graphics pipeline!");
-    }
-
-    vkDestroyShaderModule(device,vertShaderModule,nullptr);
-    vkDestroyShaderModule(device,fragShaderModule,nullptr);
-}
+    // компиляция уходит в пул: create info копируется, кадры рисуют, как только pipeline готов
+    graphicsPipeline = pipelineCompiler.compileGraphics("graphics", pipelineInfo);
 
-std::vector<char> TriangleVulkan::readFile(const std::string &fileName)
-{
-    // Смысл установки указателя чтения на конец файла в том, что таким образом мы можем
-    // вычислить размер файла и заранее выделить память под буфер.
-    std::ifstream file(fileName,std::ios::ate | std::ios::binary);
-    if(!file.is_open())
+    // вариант для instancing: другой вершинный шейдер и второй binding, остальное состояние то же
+    if (options.instanced)
     {
-        throw std::runtime_error("failed to open file");
+        std::vector<VkVertexInputBindingDescription> instancedBindings = bindingDescriptions;
+        instancedBindings.insert(instancedBindings.end(), InstanceVertexInput::bindings.begin(), InstanceVertexInput::bindings.end());
+
+        std::vector<VkVertexInputAttributeDescription> instancedAttributes = attributeDescriptions;
+        instancedAttributes.insert(instancedAttributes.end(), InstanceVertexInput::attributes.begin(), InstanceVertexInput::attributes.end());
+
+        vertexInputInfo.vertexBindingDescriptionCount   = static_cast<uint32_t>(instancedBindings.size());
+        vertexInputInfo.pVertexBindingDescriptions      = instancedBindings.data();
+        vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(instancedAttributes.size());
+        vertexInputInfo.pVertexAttributeDescriptions    = instancedAttributes.data();
+
+        shaderStages[0].module = shaderLibrary.getModule("instanced.vert.spv");
+
+        instancedPipeline = pipelineCompiler.compileGraphics("instanced", pipelineInfo);
     }
 
-    size_t fileSize = (size_t)file.tellg();
-    std::vector<char> buffer(fileSize);
+    // вариант с push constants: вершины те же, другой вершинный шейдер
+    if (options.pushConstants)
+    {
+        shaderStages[0].module = shaderLibrary.getModule("push.vert.spv");
 
-    file.seekg(0); // Затем мы можем вернуть указатель в начало файла и считать все байты за один вызов:
-    file.read(buffer.data(),fileSize);
-    file.close();
-    return buffer;
+        pushConstantPipeline = pipelineCompiler.compileGraphics("pushConstants", pipelineInfo);
+    }
 }
 
-VkShaderModule TriangleVulkan::createShaderModule(const std::vector<char>& code)
+// Кадр как граф: [отсечение в compute] -> основной проход в swap chain image. Раньше это был render pass
+// с одной subpass dependency и finalLayout; теперь переход UNDEFINED -> COLOR_ATTACHMENT_OPTIMAL, барьер
+// compute -> DRAW_INDIRECT и переход в PRESENT_SRC/TRANSFER_SRC граф выводит из объявлений проходов
+void TriangleVulkan::createFrameGraph()
 {
-    VkShaderModuleCreateInfo createInfo{};
-    createInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = code.size();
-    createInfo.pCode    = reinterpret_cast<const uint32_t*>(code.data());
+    // submit ждет imageAvailable на стадии COLOR_ATTACHMENT_OUTPUT - переход layout цепляется за это ожидание.
+    // PRESENT_SRC_KHR существует только с VK_KHR_swapchain, offscreen image оставляем готовым к чтению/копированию
+    RenderGraph::ResourceState acquired{VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0};
+    RenderGraph::ResourceState presented{options.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0};
+    backbufferResource = frameGraph.importImage("backbuffer", {swapChainImageFormat, swapChainExtent}, acquired, presented);
+
+    if (options.gpuDriven)
+    {
+        // буферы слота кадра: к началу кадра его прошлое чтение завершено (fence/timeline), барьер на входе не нужен
+        drawCommandsResource = frameGraph.importBuffer("drawCommands", {});
+        drawCountResource = frameGraph.importBuffer("drawCount", {});
+
+        // то же условие, что asyncCulling в createCullingResources(): тогда отсечение уходит отдельным submit
+        if (!(options.timelineSync && queueScheduler.isDedicated(QueueKind::Compute)))
+        {
+            RenderGraph::PassId cull = frameGraph.addPass("cull", RenderGraph::PassKind::Compute,
+                                                          [this](VkCommandBuffer commandBuffer) { recordCulling(commandBuffer); });
+            drawCommandsResource = frameGraph.writeBuffer(cull, drawCommandsResource, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+            drawCountResource = frameGraph.writeBuffer(cull, drawCountResource, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                       VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+        }
+    }
 
-    VkShaderModule shaderModule;
-    if (vkCreateShaderModule(device,&createInfo,nullptr,&shaderModule) != VK_SUCCESS)
+    mainPass = frameGraph.addPass("main", RenderGraph::PassKind::Raster, [this](VkCommandBuffer commandBuffer) { recordMainPass(commandBuffer); });
+    frameGraph.colorAttachment(mainPass, backbufferResource, VK_ATTACHMENT_LOAD_OP_CLEAR, {{0.0f, 0.0f, 0.0f, 1.0f}});
+    if (options.gpuDriven)
     {
-        throw std::runtime_error("failed to create shader module");
+        frameGraph.readBuffer(mainPass, drawCommandsResource, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+        frameGraph.readBuffer(mainPass, drawCountResource, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
     }
-    return shaderModule;
-}
 
-// ????
-void TriangleVulkan::createRenderPass()
-{
-    VkAttachmentDescription colorAttachment{};
-    colorAttachment.format = swapChainImageFormat;
-    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    VkAttachmentReference colorAttachmentRef{};
-    colorAttachmentRef.attachment = 0;
-    colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    VkSubpassDescription subpass{};
-    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount = 1;
-    subpass.pColorAttachments = &colorAttachmentRef;
-
-    VkSubpassDependency dependency{};
-    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-    dependency.dstSubpass = 0;
-    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.srcAccessMask = 0;
-    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-    VkRenderPassCreateInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassInfo.attachmentCount = 1;
-    renderPassInfo.pAttachments = &colorAttachment;
-    renderPassInfo.subpassCount = 1;
-    renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
-
-    if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create render pass!");
+    frameGraph.compile(device, allocator);
+    renderPass = frameGraph.renderPass(mainPass);
+
+    if (options.renderGraphDump)
+    {
+        frameGraph.dump(std::clog);
     }
 }
 
@@ -734,364 +1726,1443 @@ void TriangleVulkan::createImageViews()
         createInfo.subresourceRange.baseArrayLayer = 0;
         createInfo.subresourceRange.layerCount = 1;
 
-        if (vkCreateImageView(device, &createInfo, nullptr, &swapChainImageViews[i]) != VK_SUCCESS)
+        if (vkCreateImageView(device, &createInfo, nullptr, &swapChainImageViews[i]) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create image views!");
+        }
+    }
+}
+
+// ????
+void TriangleVulkan::createCommandPool()
+{
+    const QueueFamilyIndices& queueFamilyIndices = familyIndices;
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create command pool!");
+    }
+}
+
+// ????
+void TriangleVulkan::createCommandBuffers()
+{
+    commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = (uint32_t) commandBuffers.size();
+
+    if (vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate command buffers!");
+    }
+}
+
+// ????
+void TriangleVulkan::drawFrame()
+{
+    // убедиться, что предыдущий кадр завершился.
+    frameProfiler.beginPhase(FramePhase::FenceWait);
+    if (options.timelineSync)
+    {
+        queueScheduler.timeline(QueueKind::Graphics).wait(frameTimelineValues[currentFrame]);
+    }
+    else
+    {
+        vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    }
+    frameProfiler.endPhase(FramePhase::FenceWait);
+
+    // кадр этого слота завершен - вместе с ним все отправленное раньше, его ресурсы можно удалять
+    deletionQueue.collect(frameNumbers[currentFrame]);
+
+    // fence сигнален - запросы этого кадра в полете уже записаны GPU, читаем без ожидания
+    if (gpuProfiler.collect(currentFrame))
+    {
+        frameProfiler.addGpuFrame(gpuProfiler.lastStats());
+    }
+
+    uint32_t imageIndex;
+    if (options.headless)
+    {
+        // offscreen image на каждый кадр в полете: раз fence кадра сигнален, его image свободен
+        imageIndex = currentFrame;
+    }
+    else
+    {
+        frameProfiler.beginPhase(FramePhase::Acquire);
+        VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+        frameProfiler.endPhase(FramePhase::Acquire);
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            recreateSwapChain();
+            return;
+        }
+        else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+            throw std::runtime_error("failed to acquire swap chain image!");
+        }
+    }
+
+    frameProfiler.beginPhase(FramePhase::UpdateUniforms);
+    updateUniformBuffer(currentFrame);
+    updateScene();
+    updateObjectUniforms(currentFrame);
+    updateInstanceBuffer(currentFrame);
+    if (options.meshlets && !options.gpuDriven)
+    {
+        cullMeshlets();
+    }
+    frameProfiler.endPhase(FramePhase::UpdateUniforms);
+
+    if (!options.timelineSync)
+    {
+        vkResetFences(device, 1, &inFlightFences[currentFrame]);
+    }
+
+    // буферы, которые transfer очередь уже отдала: acquire запишется в начало командного буфера кадра
+    frameAcquireBarriers = uploadManager.takeAcquireBarriers();
+
+    frameProfiler.beginPhase(FramePhase::Record);
+    vkResetCommandBuffer(commandBuffers[currentFrame], /*VkCommandBufferResetFlagBits*/ 0);
+    recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
+    frameProfiler.endPhase(FramePhase::Record);
+
+    VkSemaphore waitSemaphores[] = { imageAvailableSemaphores[currentFrame] };
+    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+    VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
+
+    frameProfiler.beginPhase(FramePhase::Submit);
+    if (options.timelineSync)
+    {
+        QueueSubmit batch;
+        batch.commandBuffers.push_back(commandBuffers[currentFrame]);
+
+        // в headless режиме нет ни acquire, ни present - ждать и сигналить binary семафоры некому
+        if (!options.headless)
+        {
+            batch.waitSemaphores.push_back(waitSemaphores[0]);
+            batch.waitStages.push_back(waitStages[0]);
+            batch.signalSemaphores.push_back(signalSemaphores[0]);
+        }
+
+        // загрузки еще в полете - ждать ровно их значение, и только там, где читаются буферы
+        batch.timelineWaits.push_back({QueueKind::Transfer, uploadManager.pendingTimelineValue(), UPLOAD_CONSUMER_STAGES});
+
+        // отсечение в async compute очереди: команды нужны только стадии DRAW_INDIRECT
+        if (asyncCulling)
+        {
+            batch.timelineWaits.push_back({QueueKind::Compute, submitAsyncCulling(), VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT});
+        }
+
+        frameTimelineValues[currentFrame] = queueScheduler.submit(QueueKind::Graphics, batch);
+    }
+    else
+    {
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        // в headless режиме нет ни acquire, ни present - ждать и сигналить семафоры некому
+        submitInfo.waitSemaphoreCount = options.headless ? 0 : 1;
+        submitInfo.pWaitSemaphores = waitSemaphores;
+        submitInfo.pWaitDstStageMask = waitStages;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
+        submitInfo.signalSemaphoreCount = options.headless ? 0 : 1;
+        submitInfo.pSignalSemaphores = signalSemaphores;
+
+        if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit draw command buffer!");
+        }
+    }
+    frameProfiler.endPhase(FramePhase::Submit);
+    frameNumbers[currentFrame] = ++submittedFrames;
+
+    if (options.headless)
+    {
+        currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        return;
+    }
+
+    VkPresentInfoKHR presentInfo{};
+    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = signalSemaphores;
+
+    VkSwapchainKHR swapChains[] = {swapChain};
+    presentInfo.swapchainCount = 1;
+    presentInfo.pSwapchains = swapChains;
+    presentInfo.pImageIndices = &imageIndex;
+
+    frameProfiler.beginPhase(FramePhase::Present);
+    VkResult result = vkQueuePresentKHR(presentQueue, &presentInfo);
+    frameProfiler.endPhase(FramePhase::Present);
+
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized)
+    {
+        framebufferResized = false;
+        recreateSwapChain();
+    }
+    else if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to present swap chain image!");
+    }
+
+    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+}
+
+void TriangleVulkan::framebufferResizeCallback(GLFWwindow *window, int width, int height) {
+    auto app = reinterpret_cast<TriangleVulkan*>(glfwGetWindowUserPointer(window));
+    app->framebufferResized = true;
+}
+
+// ????
+void TriangleVulkan::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
+    frameGraph.bindImage(backbufferResource, swapChainImages[imageIndex], swapChainImageViews[imageIndex], swapChainExtent);
+    if (options.gpuDriven)
+    {
+        frameGraph.bindBuffer(drawCommandsResource, drawCommandBuffers[currentFrame]);
+        frameGraph.bindBuffer(drawCountResource, drawCountBuffers[currentFrame]);
+    }
+
+    // secondary буферы пишутся потоками пула до начала primary - primary только исполняет их
+    // GPU-driven кадр - один indirect draw, делить между потоками нечего
+    recordParallel = recordPool != nullptr && !options.gpuDriven;
+    drawPipeline = selectDrawPipeline(); // один раз на кадр: все куски списка рисуют одним pipeline
+    frameSecondaryBuffers.clear();
+    if (recordParallel)
+    {
+        recordSecondaryBuffers(frameSecondaryBuffers);
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording command buffer!");
+    }
+
+    gpuProfiler.beginFrame(commandBuffer, currentFrame);
+
+    // вторая половина передачи владения: srcStageMask совпадает со стадиями, на которых submit ждет загрузки
+    if (!frameAcquireBarriers.empty())
+    {
+        vkCmdPipelineBarrier(commandBuffer, UPLOAD_CONSUMER_STAGES, UPLOAD_CONSUMER_STAGES, 0,
+                             0, nullptr, static_cast<uint32_t>(frameAcquireBarriers.size()), frameAcquireBarriers.data(), 0, nullptr);
+        frameAcquireBarriers.clear();
+    }
+
+    // отсечение (если оно в этой очереди), основной проход и барьеры между ними - в порядке графа
+    frameGraph.execute(commandBuffer);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+}
+
+// Проход "main" графа кадра: барьеры перед ним уже записаны, render pass открывается здесь,
+// чтобы timestamps профайлера остались снаружи
+void TriangleVulkan::recordMainPass(VkCommandBuffer commandBuffer)
+{
+    gpuProfiler.beginRenderPass(commandBuffer, currentFrame);
+
+    if (recordParallel)
+    {
+        // внутри такого render pass в primary допустим только vkCmdExecuteCommands.
+        // Pipeline statistics здесь не собираются: запрос из primary наследуется secondary только с inheritedQueries
+        frameGraph.beginRenderPass(commandBuffer, mainPass, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        if (!frameSecondaryBuffers.empty())
+        {
+            vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(frameSecondaryBuffers.size()), frameSecondaryBuffers.data());
+        }
+    }
+    else
+    {
+        frameGraph.beginRenderPass(commandBuffer, mainPass, VK_SUBPASS_CONTENTS_INLINE);
+        gpuProfiler.beginStatistics(commandBuffer, currentFrame);
+        recordDrawRange(commandBuffer, 0, visibleDrawCount, true);
+        gpuProfiler.endStatistics(commandBuffer, currentFrame);
+    }
+
+    frameGraph.endRenderPass(commandBuffer);
+    gpuProfiler.endRenderPass(commandBuffer, currentFrame);
+}
+
+// Pipeline режима отрисовки, если он уже скомпилирован. Пока нет - базовый: тот же layout и вершины,
+// но данные объектов берутся из первой записи кольца (объекты рисуются поверх друг друга).
+// Нет и базового - VK_NULL_HANDLE, кадр без draw. Кадр никогда не ждет компиляцию
+VkPipeline TriangleVulkan::selectDrawPipeline()
+{
+    PipelineHandle wanted = graphicsPipeline;
+    if (options.instanced)
+    {
+        wanted = instancedPipeline;
+    }
+    else if (options.pushConstants)
+    {
+        wanted = pushConstantPipeline;
+    }
+
+    VkPipeline pipeline = pipelineCompiler.get(wanted);
+    if (pipeline != VK_NULL_HANDLE)
+    {
+        return pipeline;
+    }
+
+    pipeline = pipelineCompiler.get(graphicsPipeline);
+    if (pipeline != VK_NULL_HANDLE)
+    {
+        fallbackFrames++;
+    }
+    else
+    {
+        skippedDrawFrames++;
+    }
+    return pipeline;
+}
+
+// Состояние не наследуется между command buffers, поэтому каждый кусок списка сам привязывает pipeline и буферы
+void TriangleVulkan::recordDrawRange(VkCommandBuffer commandBuffer, size_t begin, size_t end, bool timed)
+{
+    // ни один pipeline еще не скомпилирован: render pass только очищает кадр
+    if (drawPipeline == VK_NULL_HANDLE)
+    {
+        return;
+    }
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, drawPipeline);
+
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = (float)swapChainExtent.width;
+    viewport.height = (float)swapChainExtent.height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.offset = {0, 0};
+    scissor.extent = swapChainExtent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    // Привязка вершинного буфера
+    // при раздельных потоках - несколько binding в одном буфере, каждый со своего смещения
+    vkCmdBindVertexBuffers(commandBuffer, 0, static_cast<uint32_t>(vertexStreamBuffers.size()),
+                           vertexStreamBuffers.data(), vertexStreamOffsets.data());
+    vkCmdBindIndexBuffer(commandBuffer,indexBuffer,0,indexType);
+
+    // Отрисовка
+    if (options.instanced)
+    {
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame],
+                                1, &objectUniformOffsets[0]);
+
+        if (begin == end)
+        {
+            return;
+        }
+
+        // весь кусок списка - один draw: объекты [begin, end) это instances с firstInstance = begin
+        VkDeviceSize instanceOffset = 0;
+        vkCmdBindVertexBuffers(commandBuffer, INSTANCE_BINDING, 1, &instanceBuffers[currentFrame], &instanceOffset);
+
+        if (options.gpuDriven)
+        {
+            recordIndirectDraws(commandBuffer);
+            return;
+        }
+
+        if (timed)
+        {
+            gpuProfiler.beginDraw(commandBuffer, currentFrame);
+        }
+        vkCmdDrawIndexed(commandBuffer, drawList[begin].indexCount, static_cast<uint32_t>(end - begin),
+                         drawList[begin].firstIndex, drawList[begin].vertexOffset, static_cast<uint32_t>(begin));
+        if (timed)
+        {
+            gpuProfiler.endDraw(commandBuffer, currentFrame);
+        }
+        return;
+    }
+
+    if (options.pushConstants)
+    {
+        // set привязывается один раз: кольцо держит одну запись, которую push.vert не читает
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame],
+                                1, &objectUniformOffsets[0]);
+
+        for (size_t k = begin; k < end; k++)
+        {
+            size_t i = visibleDraws[k];
+            const DrawItem& item = drawList[i];
+
+            // данные объекта пишутся прямо в командный буфер - ни записи в mapped память, ни смены дескрипторов
+            DrawPushConstants pushConstants{};
+            pushConstants.model = options.cpuCulling ? visibleWorlds[k] : sceneTransform * instances[item.objectIndex].transform;
+            pushConstants.materialIndex = item.objectIndex % MATERIAL_COUNT;
+            vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(pushConstants), &pushConstants);
+
+            if (timed)
+            {
+                gpuProfiler.beginDraw(commandBuffer, currentFrame);
+            }
+            recordItemDraws(commandBuffer, i);
+            if (timed)
+            {
+                gpuProfiler.endDraw(commandBuffer, currentFrame);
+            }
+        }
+        return;
+    }
+
+    for (size_t k = begin; k < end; k++)
+    {
+        size_t i = visibleDraws[k];
+
+        // тот же descriptor set, только смещение в кольце - данные именно этого объекта
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame],
+                                1, &objectUniformOffsets[k]);
+
+        // timestamps пишет только однопоточный путь: GpuProfiler раздает номера запросов без блокировок
+        if (timed)
+        {
+            gpuProfiler.beginDraw(commandBuffer, currentFrame);
+        }
+        recordItemDraws(commandBuffer, i);
+        if (timed)
+        {
+            gpuProfiler.endDraw(commandBuffer, currentFrame);
+        }
+    }
+}
+
+// Один объект: весь меш или только видимые кластеры, найденные cullMeshlets()
+void TriangleVulkan::recordItemDraws(VkCommandBuffer commandBuffer, size_t index)
+{
+    const DrawItem& item = drawList[index];
+    if (!options.meshlets)
+    {
+        vkCmdDrawIndexed(commandBuffer, item.indexCount, 1, item.firstIndex, item.vertexOffset, item.objectIndex);
+        return;
+    }
+
+    for (size_t d = meshletDrawOffsets[index]; d < meshletDrawOffsets[index + 1]; d++)
+    {
+        vkCmdDrawIndexed(commandBuffer, meshletDraws[d].indexCount, 1, item.firstIndex + meshletDraws[d].firstIndex,
+                         item.vertexOffset, item.objectIndex);
+    }
+}
+
+void TriangleVulkan::createDrawList()
+{
+    drawList.resize(options.objectCount);
+    instances.resize(options.objectCount);
+    for (uint32_t i = 0; i < options.objectCount; i++)
+    {
+        drawList[i] = {meshIndexCount, 0, 0, i};
+        instances[i] = makeInstance(i, 0.0f); // transform и цвет объекта, и для instancing, и для отдельных draw
+    }
+    buildScene();
+
+    visibleDraws.resize(drawList.size());
+    for (uint32_t i = 0; i < visibleDraws.size(); i++)
+    {
+        visibleDraws[i] = i;
+    }
+    visibleDrawCount = drawList.size();
+
+    if (options.cpuCulling)
+    {
+        // те же translate * rotate * scale, что у makeInstance(), только в SoA
+        objectTransforms.resize(drawList.size());
+        for (uint32_t i = 0; i < options.objectCount; i++)
+        {
+            glm::vec3 position;
+            float scale;
+            gridPlacement(i, position, scale);
+            objectTransforms.set(i, position, glm::vec3(0.0f, 0.0f, 1.0f), static_cast<float>(i) * 0.01f, scale);
+        }
+        objectTransforms.setLocal(meshTransform, meshBounds);
+
+        transformKernel = options.transformKernel.value_or(bestTransformKernel());
+        cullPool = std::make_unique<ThreadPool>(std::max(2u, std::thread::hardware_concurrency()) - 1);
+        std::clog << "cpu culling: " << transformKernelName(transformKernel) << " kernel, " << cullPool->size() << " threads" << std::endl;
+    }
+}
+
+// Матрицы model всех объектов и frustum отсечение за один проход (TransformSystem): в кадр попадают
+// только видимые, их матрицы сразу идут в кольцо или push constants
+void TriangleVulkan::cullObjects()
+{
+    glm::vec4 planes[6];
+    extractFrustumPlanes(lastUbo.proj * lastUbo.view, planes);
+
+    objectTransforms.setParent(sceneTransform);
+    visibleDrawCount = objectTransforms.update(planes, transformKernel, cullPool.get(), visibleDraws, &visibleWorlds);
+    cpuCullTested += drawList.size();
+    cpuCullVisible += visibleDrawCount;
+}
+
+void TriangleVulkan::createParallelRecording(uint32_t threadCount)
+{
+    const QueueFamilyIndices& queueFamilyIndices = familyIndices;
+
+    recordSlotCount = threadCount;
+    recordSlots.resize(MAX_FRAMES_IN_FLIGHT * recordSlotCount);
+
+    for (auto& slot : recordSlots)
+    {
+        // пул сбрасывается целиком перед записью кадра, отдельные буферы не сбрасываются
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+
+        if (vkCreateCommandPool(device, &poolInfo, nullptr, &slot.pool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create command pool!");
+        }
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = slot.pool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocInfo.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(device, &allocInfo, &slot.commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate secondary command buffer!");
+        }
+    }
+
+    recordPool = std::make_unique<ThreadPool>(threadCount);
+}
+
+void TriangleVulkan::destroyParallelRecording()
+{
+    recordPool.reset();
+
+    for (auto& slot : recordSlots)
+    {
+        vkDestroyCommandPool(device, slot.pool, nullptr);
+    }
+    recordSlots.clear();
+    recordSlotCount = 0;
+}
+
+// Каждый поток пишет непрерывный кусок drawList в свой secondary буфер.
+// Пул слота принадлежит одной задаче за раз, поэтому внешняя синхронизация VkCommandPool не нужна
+void TriangleVulkan::recordSecondaryBuffers(std::vector<VkCommandBuffer>& recorded)
+{
+    // делится только то, что рисуется в этом кадре; пусто (все отсечено) - ни одного secondary
+    size_t sliceSize = std::max<size_t>(1, (visibleDrawCount + recordSlotCount - 1) / recordSlotCount);
+    uint32_t sliceCount = static_cast<uint32_t>((visibleDrawCount + sliceSize - 1) / sliceSize);
+    RecordSlot* frameSlots = &recordSlots[currentFrame * recordSlotCount];
+    VkFramebuffer framebuffer = frameGraph.framebuffer(mainPass); // до пула: граф создает framebuffer при первом обращении
+
+    recordPool->parallelFor(sliceCount, [&](uint32_t slice) {
+        RecordSlot& slot = frameSlots[slice];
+        vkResetCommandPool(device, slot.pool, 0);
+
+        // secondary буфер целиком внутри render pass: ему нужны render pass, subpass и framebuffer
+        VkCommandBufferInheritanceInfo inheritanceInfo{};
+        inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritanceInfo.renderPass = renderPass;
+        inheritanceInfo.subpass = 0;
+        inheritanceInfo.framebuffer = framebuffer;
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+        if (vkBeginCommandBuffer(slot.commandBuffer, &beginInfo) != VK_SUCCESS) {
+            throw std::runtime_error("failed to begin recording secondary command buffer!");
+        }
+
+        size_t begin = slice * sliceSize;
+        recordDrawRange(slot.commandBuffer, begin, std::min(visibleDrawCount, begin + sliceSize), false);
+
+        if (vkEndCommandBuffer(slot.commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to record secondary command buffer!");
+        }
+    });
+
+    recorded.resize(sliceCount);
+    for (uint32_t slice = 0; slice < sliceCount; slice++)
+    {
+        recorded[slice] = frameSlots[slice].commandBuffer;
+    }
+}
+
+// ????
+void TriangleVulkan::createSyncObjects()
+{
+    imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+    renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+    inFlightFences.resize(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+    frameTimelineValues.assign(MAX_FRAMES_IN_FLIGHT, 0); // 0 уже достигнут - первый кадр не ждет
+    frameNumbers.assign(MAX_FRAMES_IN_FLIGHT, 0);
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    // как я понял для каждого кадра создается отдельные объекты синхронизации
+    for(size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        // с timeline семафором fence кадров не нужны
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
+            vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
+            (!options.timelineSync && vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS))
+        {
+            throw std::runtime_error("failed to create synchronization objects for a frame!");
+        }
+    }
+}
+
+void TriangleVulkan::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                                  VkBuffer &buffer, DeviceAllocation &bufferMemory, bool concurrent)
+{
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size; // Размер буфера
+    bufferInfo.usage = usage;    // Тип использования
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;      // Только одна очередь
+
+    // буфер, который каждый кадр читают/пишут разные семейства очередей: без передачи владения туда-обратно
+    std::vector<uint32_t> families = queueScheduler.uniqueFamilies();
+    if (concurrent && families.size() > 1)
+    {
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(families.size());
+        bufferInfo.pQueueFamilyIndices = families.data();
+    }
+
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create vertex buffer!");
+    }
+
+    // Запрос памяти для буфера
+    VkMemoryRequirements memRequirements{};
+    vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+
+    // Участок из общего блока памяти вместо отдельного vkAllocateMemory на каждый буфер
+    bufferMemory = allocator.allocate(memRequirements, properties, ResourceKind::Linear);
+
+    // Связываем буфер с памятью
+    vkBindBufferMemory(device, buffer, bufferMemory.memory, bufferMemory.offset);
+}
+
+void TriangleVulkan::destroyBuffer(VkBuffer buffer, DeviceAllocation &bufferMemory)
+{
+    vkDestroyBuffer(device, buffer, nullptr);
+    allocator.free(bufferMemory);
+}
+
+// Создание буфера
+// Меш из .vmesh или встроенный квадрат. Из файла читается только заголовок: размеры, тип индексов
+// и сфера вокруг меша посчитаны конвертером, вершины и индексы копируются позже прямо из отображения
+void TriangleVulkan::loadMesh()
+{
+    const Vertex* source = vertices.data();
+    size_t vertexCount = vertices.size();
+
+    if (options.meshPath.empty())
+    {
+        meshIndexCount = static_cast<uint32_t>(indices.size());
+        indexType = VK_INDEX_TYPE_UINT16;
+
+        float radius = 0.0f;
+        for (const auto& vertex : vertices)
+        {
+            radius = std::max(radius, glm::length(vertex.pos));
+        }
+        meshBounds = glm::vec4(0.0f, 0.0f, 0.0f, radius);
+    }
+    else
+    {
+        loadMeshFile();
+        source = static_cast<const Vertex*>(meshFile->vertexData());
+        vertexCount = meshFile->header().vertexCount;
+    }
+
+    vertexBufferSize = vertexCount * vertexLayout.stride();
+    vertexStreamOffsets.clear();
+    for (size_t binding = 0; binding < vertexLayout.bindings.size(); binding++)
+    {
+        vertexStreamOffsets.push_back(vertexLayout.streamOffset(binding, vertexCount));
+    }
+
+    if (options.meshlets)
+    {
+        buildMeshClusters(source, vertexCount);
+    }
+
+    // float32 с чередованием - вершины копируются как есть, без промежуточного буфера
+    const void* interleaved = source;
+    std::vector<PackedVertex> packed;
+    if (vertexLayout.format != VertexFormat::Float32)
+    {
+        // Сжатый формат: позиции в [-1, 1] внутри границ меша. Обратное преобразование уходит в meshTransform,
+        // а сфера для отсечения пересчитывается в пространство буфера - шейдеры и отсечение не меняются
+        QuantizationBounds bounds = QuantizationBounds::compute(source, vertexCount);
+        packed.resize(vertexCount);
+        encodeVertices(source, vertexCount, vertexLayout.format, bounds, packed.data());
+        interleaved = packed.data();
+
+        meshTransform = meshTransform * bounds.dequantizeTransform();
+        meshBounds = glm::vec4((glm::vec3(meshBounds) - bounds.center) / bounds.extent, meshBounds.w / bounds.extent);
+        for (Meshlet& meshlet : meshlets)
+        {
+            // масштаб один на все оси - оси конусов не меняются
+            meshlet.boundingSphere = glm::vec4((glm::vec3(meshlet.boundingSphere) - bounds.center) / bounds.extent,
+                                               meshlet.boundingSphere.w / bounds.extent);
+        }
+        meshletCuller.init(meshlets);
+    }
+
+    if (vertexLayout.split)
+    {
+        vertexData.resize(vertexBufferSize);
+        deinterleaveVertices(interleaved, vertexCount, VertexLayout::get(vertexLayout.format), vertexLayout, vertexData.data());
+    }
+    else if (!packed.empty())
+    {
+        vertexData.resize(vertexBufferSize);
+        std::memcpy(vertexData.data(), packed.data(), vertexBufferSize);
+    }
+
+    if (vertexLayout.format != VertexFormat::Float32 || vertexLayout.split)
+    {
+        std::clog << "vertex format " << vertexFormatName(vertexLayout.format) << (vertexLayout.split ? ", split streams" : "")
+                  << ": " << vertexCount * sizeof(Vertex) / 1024 << " KiB -> " << vertexBufferSize / 1024 << " KiB" << std::endl;
+    }
+}
+
+// Кластеры строятся по исходным float32 позициям: границы точнее, чем по сжатым
+void TriangleVulkan::buildMeshClusters(const Vertex* source, size_t vertexCount)
+{
+    const void* meshIndices = indices.data();
+    uint32_t indexSize = sizeof(indices[0]);
+    if (meshFile)
+    {
+        meshIndices = meshFile->indexData();
+        indexSize = meshFile->header().indexSize;
+    }
+
+    meshlets = buildMeshlets(meshIndices, indexSize, meshIndexCount, source, vertexCount);
+    meshletCuller.init(meshlets);
+
+    size_t cullable = std::count_if(meshlets.begin(), meshlets.end(), [](const Meshlet& meshlet) { return meshlet.cone.w > 0.0f; });
+    std::clog << "meshlets: " << meshlets.size() << " clusters for " << meshIndexCount / 3 << " triangles, "
+              << cullable << " with a normal cone" << std::endl;
+}
+
+// Видимые кластеры каждого объекта для записи команд. Плоскости и камера переводятся в пространство
+// вершинного буфера объекта, поэтому сами кластеры не трансформируются
+void TriangleVulkan::cullMeshlets()
+{
+    meshletDraws.clear();
+    meshletDrawOffsets.resize(drawList.size() + 1);
+
+    glm::mat4 viewProj = lastUbo.proj * lastUbo.view;
+    glm::vec4 eye = glm::inverse(lastUbo.view)[3];
+    for (size_t i = 0; i < drawList.size(); i++)
+    {
+        glm::mat4 model = sceneTransform * instances[drawList[i].objectIndex].transform;
+        glm::vec4 planes[6];
+        extractFrustumPlanes(viewProj * model, planes);
+        glm::vec3 camera = glm::vec3(glm::inverse(model) * eye);
+
+        meshletDrawOffsets[i] = meshletDraws.size();
+        meshletsVisible += meshletCuller.cull(planes, camera, meshletDraws);
+        meshletsTested += meshletCuller.size();
+    }
+    meshletDrawOffsets[drawList.size()] = meshletDraws.size();
+}
+
+void TriangleVulkan::loadMeshFile()
+{
+    meshFile = std::make_unique<MeshFile>(options.meshPath);
+    const VMeshHeader& header = meshFile->header();
+
+    if (header.vertexFormat != VMESH_VERTEX_POSITION_COLOR || header.vertexStride != sizeof(Vertex))
+    {
+        throw std::runtime_error("unsupported vertex format in mesh file: " + options.meshPath);
+    }
+    if (header.indexCount > UINT32_MAX || header.indexCount % 3 != 0)
+    {
+        throw std::runtime_error("invalid index count in mesh file: " + options.meshPath);
+    }
+
+    meshIndexCount = static_cast<uint32_t>(header.indexCount);
+    indexType = header.indexSize == 2 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+    meshBounds = glm::vec4(header.boundsCenter[0], header.boundsCenter[1], header.boundsCenter[2], header.boundsRadius);
+
+    // центр в начало координат, радиус как у встроенного квадрата (0.5 * sqrt(2))
+    float radius = std::max(header.boundsRadius, 1e-6f);
+    meshTransform = glm::scale(glm::mat4(1.0f), glm::vec3(0.70710678f / radius));
+    meshTransform = glm::translate(meshTransform, -glm::vec3(meshBounds));
+
+    std::clog << "mesh " << options.meshPath << ": " << header.vertexCount << " vertices, " << meshIndexCount / 3
+              << " triangles, " << (meshFile->vertexBytes() + meshFile->indexBytes()) / 1024 << " KiB" << std::endl;
+}
+
+void TriangleVulkan::createVertexBuffer()
+{
+    const void* data = vertices.data();
+    VkDeviceSize bufferSize = vertexBufferSize;
+    if (!vertexData.empty())
+    {
+        data = vertexData.data();
+    }
+    else if (meshFile != nullptr)
+    {
+        data = meshFile->vertexData();
+    }
+
+    //VK_BUFFER_USAGE_TRANSFER_DST_BIT - пункт назначения при операции передачи памяти.
+    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
+
+    // данные уходят через staging кольцо; копирование попадет в очередь батчем, без ожидания GPU здесь
+    // данные больше staging кольца уходят кусками: кольцо освобождается по мере завершения батчей,
+    // а страницы файла подгружаются по ходу копирования
+    geometryUpload = uploadManager.upload(vertexBuffer, 0, data, bufferSize);
+    vertexStreamBuffers.assign(vertexLayout.bindings.size(), vertexBuffer);
+}
+
+void TriangleVulkan::createIndexBuffer()
+{
+    const void* data = indices.data();
+    VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
+    if (meshFile != nullptr)
+    {
+        data = meshFile->indexData();
+        bufferSize = meshFile->indexBytes();
+    }
+
+    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory);
+    geometryUpload = uploadManager.upload(indexBuffer, 0, data, bufferSize);
+}
+
+void TriangleVulkan::createUniformBuffer() {
+    VkDeviceSize bufferSize = sizeof (UniformBufferObject);
+
+    uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
+    uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+
+    for(size_t i = 0; i< MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        createBuffer(bufferSize,VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,uniformBuffers[i],uniformBuffersMemory[i]);
+        uniformBuffersMapped[i] = uniformBuffersMemory[i].mapped;
+    }
+}
+
+// Данные объектов - в кольцо uniform буферов: по записи на каждый отдельный draw за кадр
+void TriangleVulkan::createObjectUniformRing()
+{
+    const VkPhysicalDeviceProperties& properties = deviceCaps.properties;
+
+    // при instancing и push constants данные объектов идут мимо кольца, в нем одна запись на весь кадр
+    VkDeviceSize alignment = properties.limits.minUniformBufferOffsetAlignment;
+    VkDeviceSize entrySize = (sizeof(ObjectUniforms) + alignment - 1) / alignment * alignment;
+    VkDeviceSize entries = (options.instanced || options.pushConstants) ? 1 : drawList.size();
+
+    uniformRing.init(device, allocator, alignment, MAX_FRAMES_IN_FLIGHT, entrySize * entries);
+}
+
+// Вызывается после fence кадра: прошлое содержимое кольца этого кадра GPU уже прочитал
+void TriangleVulkan::updateObjectUniforms(uint32_t currentImage)
+{
+    uniformRing.beginFrame(currentImage);
+
+    if (options.cpuCulling)
+    {
+        cullObjects();
+    }
+
+    if (options.instanced || options.pushConstants)
+    {
+        // instanced.vert берет отсюда вращение сцены; push.vert запись не читает, но смещение нужно при каждой привязке
+        objectUniformOffsets.assign(1, uniformRing.push(ObjectUniforms{sceneTransform, glm::vec4(1.0f)}));
+        return;
+    }
+
+    // смещения идут в порядке visibleDraws: k-й записанный draw читает k-ю запись
+    objectUniformOffsets.resize(visibleDrawCount);
+    for (size_t k = 0; k < visibleDrawCount; k++)
+    {
+        const InstanceData& instance = instances[drawList[visibleDraws[k]].objectIndex];
+        glm::mat4 model = options.cpuCulling ? visibleWorlds[k] : sceneTransform * instance.transform;
+        objectUniformOffsets[k] = uniformRing.push(ObjectUniforms{model, instance.color});
+    }
+}
+
+// Объекты раскладываются сеткой в квадрате [-1, 1], которую дальше крутит model матрица из UBO
+void TriangleVulkan::gridPlacement(uint32_t index, glm::vec3& position, float& scale) const
+{
+    uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(options.objectCount))));
+    float cell = 2.0f / static_cast<float>(side);
+
+    position = glm::vec3(-1.0f + cell * (static_cast<float>(index % side) + 0.5f),
+                         -1.0f + cell * (static_cast<float>(index / side) + 0.5f), 0.0f);
+    scale = cell * 0.8f;
+}
+
+InstanceData TriangleVulkan::makeInstance(uint32_t index, float time) const
+{
+    glm::vec3 position;
+    float scale;
+    gridPlacement(index, position, scale);
+
+    InstanceData instance{};
+    instance.transform = glm::translate(glm::mat4(1.0f), position);
+    instance.transform = glm::rotate(instance.transform, time + static_cast<float>(index) * 0.01f, glm::vec3(0.0f, 0.0f, 1.0f));
+    instance.transform = glm::scale(instance.transform, glm::vec3(scale));
+    instance.transform = instance.transform * meshTransform;
+
+    // цвет по номеру, чтобы соседние копии различались
+    float hue = static_cast<float>(index % 7) / 7.0f;
+    instance.color = glm::vec4(0.5f + 0.5f * hue, 1.0f - 0.5f * hue, 0.75f, 1.0f);
+    return instance;
+}
+
+// Сетка как иерархия: узел-группа на строку, объекты строки - его дети. Узлы добавляются в прямом порядке
+// обхода, поэтому поддерево строки - непрерывный диапазон, и сдвиг строки пересчитывает только ее объекты
+void TriangleVulkan::buildScene()
+{
+    uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(options.objectCount))));
+
+    objectNodes.resize(options.objectCount);
+    for (uint32_t i = 0; i < options.objectCount; i++)
+    {
+        if (i % side == 0)
+        {
+            rowNodes.push_back(scene.addNode(SCENE_NO_PARENT, rowLocal(i / side, 0.0f)));
+            nodeObjects.push_back(UINT32_MAX);
+        }
+        objectNodes[i] = scene.addNode(rowNodes.back(), objectLocal(i, 0.0f));
+        nodeObjects.push_back(i);
+
+        // row * object - то же, что собрал makeInstance(), но уже через граф
+        instances[i].transform = scene.world(objectNodes[i]);
+    }
+}
+
+// смещение строки row: по y на ее место в сетке, по z - покачивание при --animate-rows
+glm::mat4 TriangleVulkan::rowLocal(uint32_t row, float time) const
+{
+    uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(options.objectCount))));
+    glm::vec3 position;
+    float scale;
+    gridPlacement(row * side, position, scale);
+
+    float offset = options.animateRows > 0 ? 0.1f * std::sin(time * 2.0f + static_cast<float>(row)) : 0.0f;
+    return glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, position.y, offset));
+}
+
+// объект внутри своей строки: makeInstance() без смещения по y
+glm::mat4 TriangleVulkan::objectLocal(uint32_t index, float time) const
+{
+    glm::vec3 position;
+    float scale;
+    gridPlacement(index, position, scale);
+
+    glm::mat4 local = glm::translate(glm::mat4(1.0f), glm::vec3(position.x, 0.0f, 0.0f));
+    local = glm::rotate(local, time + static_cast<float>(index) * 0.01f, glm::vec3(0.0f, 0.0f, 1.0f));
+    local = glm::scale(local, glm::vec3(scale));
+    return local * meshTransform;
+}
+
+float TriangleVulkan::animationTime() const
+{
+    if (options.staticScene)
+    {
+        return 0.0f;
+    }
+    return std::chrono::duration<float>(std::chrono::steady_clock::now() - animationStart).count();
+}
+
+// Помечает анимированные узлы и пересчитывает только их поддеревья. Новые матрицы объектов попадают в instances
+// и в очередь копирования каждого буфера кадра: буфер получает все изменения с его прошлой записи
+void TriangleVulkan::updateScene()
+{
+    // --cpu-culling строит матрицы из своей SoA копии, граф ему не нужен
+    if (options.cpuCulling)
+    {
+        return;
+    }
+
+    float time = animationTime();
+    if (options.animateInstances)
+    {
+        for (uint32_t i = 0; i < options.objectCount; i++)
+        {
+            scene.setLocal(objectNodes[i], objectLocal(i, time));
+        }
+    }
+    if (options.animateRows > 0 && !rowNodes.empty())
+    {
+        // строки по кругу: за кадр двигаются animateRows следующих
+        uint32_t rowCount = static_cast<uint32_t>(rowNodes.size());
+        for (uint32_t j = 0; j < std::min(options.animateRows, rowCount); j++)
+        {
+            uint32_t row = (animatedRowCursor + j) % rowCount;
+            scene.setLocal(rowNodes[row], rowLocal(row, time));
+        }
+        animatedRowCursor = (animatedRowCursor + options.animateRows) % rowCount;
+    }
+
+    size_t dirtyCount = scene.update();
+    sceneFrames++;
+    sceneDirtyNodes += dirtyCount;
+    if (dirtyCount == 0)
+    {
+        return;
+    }
+
+    size_t changedObjects = 0;
+    for (uint32_t node : scene.changedNodes())
+    {
+        uint32_t object = nodeObjects[node];
+        if (object != UINT32_MAX)
         {
-            throw std::runtime_error("failed to create image views!");
+            instances[object].transform = scene.world(node);
+            changedObjects++;
         }
     }
-}
 
-// ????
-void TriangleVulkan::createFramebuffers()
-{
-    swapChainFramebuffers.resize(swapChainImageViews.size());
-    for (size_t i = 0; i < swapChainImageViews.size(); i++)
+    if (!options.instanced)
     {
-        VkImageView attachments[] = {
-                swapChainImageViews[i]
-        };
-
-        VkFramebufferCreateInfo framebufferInfo{};
-        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        framebufferInfo.renderPass = renderPass;
-        framebufferInfo.attachmentCount = 1;
-        framebufferInfo.pAttachments = attachments;
-        framebufferInfo.width = swapChainExtent.width;
-        framebufferInfo.height = swapChainExtent.height;
-        framebufferInfo.layers = 1;
+        return;
+    }
 
-        if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &swapChainFramebuffers[i]) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create framebuffer!");
+    // изменилось все - поштучные очереди не нужны, буферы копируются целиком
+    if (changedObjects == instances.size())
+    {
+        for (size_t slot = 0; slot < instanceUploads.size(); slot++)
+        {
+            for (uint32_t object : instanceUploads[slot])
+            {
+                instanceUploadQueued[slot][object] = 0;
+            }
+            instanceUploads[slot].clear();
+            instanceFullUpload[slot] = true;
         }
+        return;
     }
-}
 
-// ????
-void TriangleVulkan::createCommandPool()
-{
-    QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
-
-    VkCommandPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-    poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
-
-    if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create command pool!");
+    for (size_t slot = 0; slot < instanceUploads.size(); slot++)
+    {
+        if (instanceFullUpload[slot])
+        {
+            continue;
+        }
+        for (uint32_t node : scene.changedNodes())
+        {
+            uint32_t object = nodeObjects[node];
+            if (object != UINT32_MAX && !instanceUploadQueued[slot][object])
+            {
+                instanceUploadQueued[slot][object] = 1;
+                instanceUploads[slot].push_back(object);
+            }
+        }
     }
 }
 
-// ????
-void TriangleVulkan::createCommandBuffers()
+void TriangleVulkan::createInstanceBuffers()
 {
-    commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    VkDeviceSize bufferSize = sizeof(InstanceData) * instances.size();
 
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.commandPool = commandPool;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandBufferCount = (uint32_t) commandBuffers.size();
+    instanceBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    instanceBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
+    instanceUploads.assign(MAX_FRAMES_IN_FLIGHT, {});
+    instanceUploadQueued.assign(MAX_FRAMES_IN_FLIGHT, std::vector<uint8_t>(instances.size(), 0));
+    instanceFullUpload.assign(MAX_FRAMES_IN_FLIGHT, true);
 
-    if (vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate command buffers!");
+    // HOST_VISIBLE: буфер переписывается с CPU без staging копии, читается GPU один раз на instance
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        // в GPU-driven режиме этот же буфер читает compute шейдер отсечения
+        createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     instanceBuffers[i], instanceBuffersMemory[i], options.gpuDriven); // читает и async compute отсечение
     }
 }
 
-// ????
-void TriangleVulkan::drawFrame()
+// Вызывается после fence кадра: GPU этот буфер уже не читает
+void TriangleVulkan::updateInstanceBuffer(uint32_t currentImage)
 {
-    // убедиться, что предыдущий кадр завершился.
-    vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
-
-    uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
-
-    if (result == VK_ERROR_OUT_OF_DATE_KHR)
+    if (!options.instanced)
     {
-        recreateSwapChain();
         return;
     }
-    else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-        throw std::runtime_error("failed to acquire swap chain image!");
-    }
-
-    updateUniformBuffer(currentFrame);
-
-    vkResetFences(device, 1, &inFlightFences[currentFrame]);
-    vkResetCommandBuffer(commandBuffers[currentFrame], /*VkCommandBufferResetFlagBits*/ 0);
-    recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
-
-    VkSemaphore waitSemaphores[] = { imageAvailableSemaphores[currentFrame] };
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = waitSemaphores;
-    submitInfo.pWaitDstStageMask = waitStages;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
-
-    VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = signalSemaphores;
-
-    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
-        throw std::runtime_error("failed to submit draw command buffer!");
-    }
-
-    VkPresentInfoKHR presentInfo{};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
 
-    VkSwapchainKHR swapChains[] = {swapChain};
-    presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = swapChains;
-    presentInfo.pImageIndices = &imageIndex;
+    InstanceData* mapped = static_cast<InstanceData*>(instanceBuffersMemory[currentImage].mapped);
 
-    result = vkQueuePresentKHR(presentQueue, &presentInfo);
-
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized)
+    if (instanceFullUpload[currentImage])
     {
-        framebufferResized = false;
-        recreateSwapChain();
+        memcpy(mapped, instances.data(), sizeof(InstanceData) * instances.size());
+        instanceUploadBytes += sizeof(InstanceData) * instances.size();
+        instanceFullUpload[currentImage] = false;
+        return;
     }
-    else if (result != VK_SUCCESS)
+
+    // только матрицы, изменившиеся после прошлой записи в этот буфер; статичная сцена не копирует ничего
+    std::vector<uint32_t>& uploads = instanceUploads[currentImage];
+    for (uint32_t object : uploads)
     {
-        throw std::runtime_error("failed to present swap chain image!");
+        mapped[object].transform = instances[object].transform;
+        instanceUploadQueued[currentImage][object] = 0;
     }
-
-    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    instanceUploadBytes += sizeof(glm::mat4) * uploads.size();
+    uploads.clear();
 }
 
-void TriangleVulkan::framebufferResizeCallback(GLFWwindow *window, int width, int height) {
-    auto app = reinterpret_cast<TriangleVulkan*>(glfwGetWindowUserPointer(window));
-    app->framebufferResized = true;
+// Требования к памяти
+uint32_t TriangleVulkan::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
+{
+    // свойства памяти аллокатор запросил один раз при инициализации
+    return allocator.findMemoryType(typeFilter, properties);
 }
 
-// ????
-void TriangleVulkan::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+// Буферы и compute pipeline для GPU-driven режима.
+// Объекты (границы и параметры draw) не меняются - загружаются один раз, команды и счетчик свои на каждый кадр в полете
+void TriangleVulkan::createCullingResources()
 {
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-
-    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
-        throw std::runtime_error("failed to begin recording command buffer!");
+    // сфера вокруг меша в его собственном пространстве (loadMesh)
+    std::vector<CullObject> objects(drawList.size());
+    for (size_t i = 0; i < drawList.size(); i++)
+    {
+        objects[i].boundingSphere = meshBounds;
+        objects[i].indexCount = drawList[i].indexCount;
+        objects[i].firstIndex = drawList[i].firstIndex;
+        objects[i].vertexOffset = drawList[i].vertexOffset;
     }
 
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = renderPass;
-    renderPassInfo.framebuffer = swapChainFramebuffers[imageIndex];
-    renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = swapChainExtent;
+    VkDeviceSize objectsSize = sizeof(CullObject) * objects.size();
+    createBuffer(objectsSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, cullObjectBuffer, cullObjectBufferMemory, true);
+    geometryUpload = uploadManager.upload(cullObjectBuffer, 0, objects.data(), objectsSize, true);
 
-    VkClearValue clearColor = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
-    renderPassInfo.clearValueCount = 1;
-    renderPassInfo.pClearValues = &clearColor;
+    // с кластерами поток отсечения - пара (кластер, объект), команда на каждый видимый кластер
+    size_t drawsPerObject = 1;
+    if (!meshlets.empty())
+    {
+        if (drawList.size() > deviceCaps.properties.limits.maxComputeWorkGroupCount[1])
+        {
+            throw std::runtime_error("too many objects for meshlet culling (one workgroup row per object)");
+        }
+        VkDeviceSize meshletsSize = sizeof(Meshlet) * meshlets.size();
+        createBuffer(meshletsSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, meshletBuffer, meshletBufferMemory, true);
+        geometryUpload = uploadManager.upload(meshletBuffer, 0, meshlets.data(), meshletsSize, true);
+        drawsPerObject = meshlets.size();
+    }
+    uploadManager.flush();
 
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    VkDeviceSize commandsSize = sizeof(VkDrawIndexedIndirectCommand) * drawList.size() * drawsPerObject;
+    drawCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    drawCommandBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
+    drawCountBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    drawCountBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        createBuffer(commandsSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, drawCommandBuffers[i], drawCommandBuffersMemory[i], true);
+        // счетчик обнуляется vkCmdFillBuffer перед каждым отсечением
+        createBuffer(sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, drawCountBuffers[i], drawCountBuffersMemory[i], true);
+    }
 
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (float)swapChainExtent.width;
-    viewport.height = (float)swapChainExtent.height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    // 0 - instances, 1 - объекты, 2 - команды, 3 - счетчик, 4 - кластеры
+    std::array<VkDescriptorSetLayoutBinding, 5> bindings{};
+    for (uint32_t i = 0; i < bindings.size(); i++)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
 
-    VkRect2D scissor{};
-    scissor.offset = {0, 0};
-    scissor.extent = swapChainExtent;
-    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
 
-    // Привязка вершинного буфера
-    VkBuffer vertexBuffers[] = {vertexBuffer};
-    VkDeviceSize offsets[] = {0};
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-    vkCmdBindIndexBuffer(commandBuffer,indexBuffer,0,VK_INDEX_TYPE_UINT16);
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &cullDescriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling descriptor set layout!");
+    }
 
-    // Отрисовка
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
-    vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
-    vkCmdEndRenderPass(commandBuffer);
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT * bindings.size());
 
-    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
-        throw std::runtime_error("failed to record command buffer!");
-    }
-}
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
 
-// ????
-void TriangleVulkan::createSyncObjects()
-{
-    imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &cullDescriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling descriptor pool!");
+    }
 
-    VkSemaphoreCreateInfo semaphoreInfo{};
-    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, cullDescriptorSetLayout);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = cullDescriptorPool;
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    allocInfo.pSetLayouts = layouts.data();
 
-    VkFenceCreateInfo fenceInfo{};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+    cullDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+    if (vkAllocateDescriptorSets(device, &allocInfo, cullDescriptorSets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate culling descriptor sets!");
+    }
 
-    // как я понял для каждого кадра создается отдельные объекты синхронизации
-    for(size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
-        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-            vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-            vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS)
+        std::array<VkDescriptorBufferInfo, 5> bufferInfos{};
+        bufferInfos[0] = {instanceBuffers[i], 0, VK_WHOLE_SIZE};
+        bufferInfos[1] = {cullObjectBuffer, 0, VK_WHOLE_SIZE};
+        bufferInfos[2] = {drawCommandBuffers[i], 0, VK_WHOLE_SIZE};
+        bufferInfos[3] = {drawCountBuffers[i], 0, VK_WHOLE_SIZE};
+        // без кластеров шейдер binding 4 не читает, но дескриптор должен быть валидным
+        bufferInfos[4] = {meshletBuffer != VK_NULL_HANDLE ? meshletBuffer : cullObjectBuffer, 0, VK_WHOLE_SIZE};
+
+        std::array<VkWriteDescriptorSet, 5> writes{};
+        for (uint32_t binding = 0; binding < writes.size(); binding++)
         {
-            throw std::runtime_error("failed to create synchronization objects for a frame!");
+            writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[binding].dstSet = cullDescriptorSets[i];
+            writes[binding].dstBinding = binding;
+            writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[binding].descriptorCount = 1;
+            writes[binding].pBufferInfo = &bufferInfos[binding];
         }
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
     }
-}
 
-void TriangleVulkan::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
-                                  VkBuffer &buffer, VkDeviceMemory &bufferMemory)
-{
-    VkBufferCreateInfo bufferInfo{};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = size; // Размер буфера
-    bufferInfo.usage = usage;    // Тип использования
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;      // Только одна очередь
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(CullPushConstants);
 
-    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create vertex buffer!");
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &cullDescriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &cullPipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling pipeline layout!");
     }
 
-    // Запрос памяти для буфера
-    VkMemoryRequirements memRequirements{};
-    vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits,properties);
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderLibrary.getModule("cull.comp.spv");
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = cullPipelineLayout;
 
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate vertex buffer memory!");
+    if (pipelineCache.createComputePipeline(pipelineInfo, cullPipeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling pipeline!");
     }
 
-    // Связываем буфер с памятью
-    vkBindBufferMemory(device, buffer, bufferMemory, 0);
-}
-
-// Создание буфера
-void TriangleVulkan::createVertexBuffer()
-{
-    VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
+    // есть отдельное compute семейство - отсечение уходит туда и идет параллельно с графикой прошлого кадра
+    asyncCulling = options.timelineSync && queueScheduler.isDedicated(QueueKind::Compute);
+    if (asyncCulling)
+    {
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        poolInfo.queueFamilyIndex = queueScheduler.family(QueueKind::Compute);
 
-    //VK_BUFFER_USAGE_TRANSFER_SRC_BIT - источник при операции переноса в память
-    createBuffer(bufferSize,VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,stagingBuffer,stagingBufferMemory);
+        if (vkCreateCommandPool(device, &poolInfo, nullptr, &computeCommandPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create compute command pool!");
+        }
 
-    // Копируем данные в память буфера
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, vertices.data(), (size_t)bufferSize);
-    vkUnmapMemory(device, stagingBufferMemory);
+        computeCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
 
-    //VK_BUFFER_USAGE_TRANSFER_DST_BIT - пункт назначения при операции передачи памяти.
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
-    copyBuffer(stagingBuffer, vertexBuffer, bufferSize);
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = computeCommandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = static_cast<uint32_t>(computeCommandBuffers.size());
 
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
+        if (vkAllocateCommandBuffers(device, &allocInfo, computeCommandBuffers.data()) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate compute command buffers!");
+        }
+    }
 }
 
-void TriangleVulkan::createIndexBuffer()
+void TriangleVulkan::destroyCullingResources()
 {
-    VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
-
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    createBuffer(bufferSize,VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,stagingBuffer,stagingBufferMemory);
+    if (cullPipeline == VK_NULL_HANDLE)
+    {
+        return;
+    }
 
-    void* data;
-    vkMapMemory(device,stagingBufferMemory,0,bufferSize,0,&data);
-    memcpy(data,indices.data(),(size_t)bufferSize);
-    vkUnmapMemory(device,stagingBufferMemory);
+    vkDestroyPipeline(device, cullPipeline, nullptr);
+    vkDestroyPipelineLayout(device, cullPipelineLayout, nullptr);
+    vkDestroyDescriptorPool(device, cullDescriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, cullDescriptorSetLayout, nullptr);
+    cullPipeline = VK_NULL_HANDLE;
 
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory);
-    copyBuffer(stagingBuffer,indexBuffer,bufferSize);
+    for (size_t i = 0; i < drawCommandBuffers.size(); i++)
+    {
+        destroyBuffer(drawCommandBuffers[i], drawCommandBuffersMemory[i]);
+        destroyBuffer(drawCountBuffers[i], drawCountBuffersMemory[i]);
+    }
+    drawCommandBuffers.clear();
+    drawCountBuffers.clear();
+    destroyBuffer(cullObjectBuffer, cullObjectBufferMemory);
+    if (meshletBuffer != VK_NULL_HANDLE)
+    {
+        destroyBuffer(meshletBuffer, meshletBufferMemory);
+        meshletBuffer = VK_NULL_HANDLE;
+    }
 
-    vkDestroyBuffer(device,stagingBuffer,nullptr);
-    vkFreeMemory(device,stagingBufferMemory, nullptr);
+    if (computeCommandPool != VK_NULL_HANDLE)
+    {
+        vkDestroyCommandPool(device, computeCommandPool, nullptr);
+        computeCommandPool = VK_NULL_HANDLE;
+        computeCommandBuffers.clear();
+    }
+    asyncCulling = false;
 }
 
-void TriangleVulkan::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+// Обнулить счетчик -> compute отсечение. Барьер до чтения команд стадией DRAW_INDIRECT ставит граф кадра,
+// в async compute очереди его заменяет ожидание семафора на этой стадии
+void TriangleVulkan::recordCulling(VkCommandBuffer commandBuffer)
 {
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = commandPool;
-    allocInfo.commandBufferCount = 1;
+    VkBuffer countBuffer = drawCountBuffers[currentFrame];
+    vkCmdFillBuffer(commandBuffer, countBuffer, 0, sizeof(uint32_t), 0);
+
+    VkBufferMemoryBarrier resetBarrier{};
+    resetBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    resetBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    resetBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    resetBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    resetBarrier.buffer = countBuffer;
+    resetBarrier.offset = 0;
+    resetBarrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                         0, nullptr, 1, &resetBarrier, 0, nullptr);
+
+    // плоскости в пространстве сетки instances: model матрица общая для всех, поэтому входит в матрицу frustum
+    CullPushConstants pushConstants{};
+    extractFrustumPlanes(lastUbo.proj * lastUbo.view * sceneTransform, pushConstants.frustumPlanes);
+    pushConstants.objectCount = static_cast<uint32_t>(drawList.size());
+    pushConstants.compact = drawIndirectCountSupported ? 1 : 0;
+    pushConstants.meshletCount = static_cast<uint32_t>(meshlets.size());
+    // камера в том же пространстве, что и плоскости
+    pushConstants.camera = glm::inverse(sceneTransform) * glm::inverse(lastUbo.view)[3];
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipelineLayout, 0, 1, &cullDescriptorSets[currentFrame], 0, nullptr);
+    vkCmdPushConstants(commandBuffer, cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+
+    const uint32_t groupSize = 64; // local_size_x в cull.comp
+    if (pushConstants.meshletCount > 0)
+    {
+        // x - кластеры, y - объекты
+        vkCmdDispatch(commandBuffer, (pushConstants.meshletCount + groupSize - 1) / groupSize, pushConstants.objectCount, 1);
+    }
+    else
+    {
+        vkCmdDispatch(commandBuffer, (pushConstants.objectCount + groupSize - 1) / groupSize, 1, 1);
+    }
+}
 
-    VkCommandBuffer commandBuffer;
-    vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
+// Отсечение кадра в async compute очереди; возвращает значение ее timeline, которое ждет graphics submit.
+// Слот кадра свободен (его graphics значение дождались), а значит и прошлое отсечение этого слота завершено
+uint64_t TriangleVulkan::submitAsyncCulling()
+{
+    VkCommandBuffer commandBuffer = computeCommandBuffers[currentFrame];
+    vkResetCommandBuffer(commandBuffer, 0);
 
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording compute command buffer!");
+    }
+    recordCulling(commandBuffer);
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record compute command buffer!");
+    }
 
-    vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-    VkBufferCopy copyRegion{};
-    copyRegion.size = size;
-
-    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-    vkEndCommandBuffer(commandBuffer);
-
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
-
-    vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphicsQueue);
-    vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+    // буферы отсечения CONCURRENT: владение не передается, видимость дают семафоры
+    QueueSubmit batch;
+    batch.commandBuffers.push_back(commandBuffer);
+    batch.timelineWaits.push_back({QueueKind::Transfer, uploadManager.pendingTimelineValue(), VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT});
+    return queueScheduler.submit(QueueKind::Compute, batch);
 }
 
-void TriangleVulkan::createUniformBuffer() {
-    VkDeviceSize bufferSize = sizeof (UniformBufferObject);
-
-    uniformBuffers.resize(bufferSize);
-    uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-    uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+// pipeline, вершинные и instance буферы уже привязаны recordDrawRange
+void TriangleVulkan::recordIndirectDraws(VkCommandBuffer commandBuffer)
+{
+    uint32_t maxDraws = static_cast<uint32_t>(drawList.size() * std::max<size_t>(1, meshlets.size()));
+    uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+    VkBuffer commands = drawCommandBuffers[currentFrame];
 
-    for(size_t i = 0; i< MAX_FRAMES_IN_FLIGHT; i++)
+    gpuProfiler.beginDraw(commandBuffer, currentFrame);
+    if (drawIndirectCountSupported)
     {
-        createBuffer(bufferSize,VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,uniformBuffers[i],uniformBuffersMemory[i]);
-        vkMapMemory(device,uniformBuffersMemory[i],0,bufferSize,0,&uniformBuffersMapped[i]);
+        // сколько команд читать, GPU берет из счетчика, который записал compute
+        cmdDrawIndexedIndirectCount(commandBuffer, commands, 0, drawCountBuffers[currentFrame], 0, maxDraws, stride);
+    }
+    else if (multiDrawIndirectSupported)
+    {
+        // команда на каждый объект, невидимые с instanceCount = 0
+        vkCmdDrawIndexedIndirect(commandBuffer, commands, 0, maxDraws, stride);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < maxDraws; i++)
+        {
+            vkCmdDrawIndexedIndirect(commandBuffer, commands, i * stride, 1, stride);
+        }
     }
+    gpuProfiler.endDraw(commandBuffer, currentFrame);
 }
 
-// Требования к памяти
-uint32_t TriangleVulkan::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
+// Плоскости frustum из матрицы clip = matrix * p (Gribb/Hartmann), глубина Vulkan в [0, w].
+// Нормали смотрят внутрь и нормированы, так что dot(plane.xyz, p) + plane.w - расстояние до плоскости
+void TriangleVulkan::extractFrustumPlanes(const glm::mat4& matrix, glm::vec4 planes[6])
 {
-    VkPhysicalDeviceMemoryProperties memProperties{};
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice,&memProperties);
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
+    glm::vec4 row0(matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]);
+    glm::vec4 row1(matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]);
+    glm::vec4 row2(matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]);
+    glm::vec4 row3(matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3]);
+
+    planes[0] = row3 + row0; // left
+    planes[1] = row3 - row0; // right
+    planes[2] = row3 + row1; // bottom
+    planes[3] = row3 - row1; // top
+    planes[4] = row2;        // near
+    planes[5] = row3 - row2; // far
+
+    for (int i = 0; i < 6; i++)
     {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
-        {
-            return i;
-        }
+        planes[i] /= glm::length(glm::vec3(planes[i]));
     }
-    throw std::runtime_error("failed to find suitable memory type!");
 }
 
 void TriangleVulkan::cleanSyncObjects()
@@ -1106,9 +3177,10 @@ void TriangleVulkan::cleanSyncObjects()
 
 void TriangleVulkan::cleanupSwapChain()
 {
-    for (auto framebuffer : swapChainFramebuffers)
+    if (options.headless)
     {
-        vkDestroyFramebuffer(device, framebuffer, nullptr);
+        cleanupOffscreenTargets();
+        return;
     }
 
     for (auto imageView : swapChainImageViews)
@@ -1119,30 +3191,50 @@ void TriangleVulkan::cleanupSwapChain()
 }
 
 void TriangleVulkan::cleanup() {
+    deletionQueue.flush(); // mainLoop/бенчмарк уже дождались устройства
+    frameGraph.destroy();  // framebuffers ссылаются на image views swap chain
     cleanupSwapChain();
 
-    vkDestroyPipeline(device, graphicsPipeline, nullptr);
+    pipelineCompiler.printStats(std::clog);
+    if (fallbackFrames > 0 || skippedDrawFrames > 0)
+    {
+        std::clog << "frames waiting for pipelines: " << fallbackFrames << " drawn with the fallback pipeline, "
+                  << skippedDrawFrames << " without draws" << std::endl;
+    }
+    pipelineCache.printStats(std::clog);
+    pipelineCompiler.destroy(); // дожидается компиляций, которые еще идут
     vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
-    vkDestroyRenderPass(device, renderPass, nullptr);
+
+    // сохранить кэш, пока устройство живо: следующий запуск не будет заново компилировать шейдеры
+    pipelineCache.save();
+    pipelineCache.destroy();
+    shaderLibrary.destroy();
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        vkDestroyBuffer(device, uniformBuffers[i], nullptr);
-        vkFreeMemory(device, uniformBuffersMemory[i], nullptr);
+        destroyBuffer(uniformBuffers[i], uniformBuffersMemory[i]);
+    }
+    uniformRing.destroy();
+    for (size_t i = 0; i < instanceBuffers.size(); i++) {
+        destroyBuffer(instanceBuffers[i], instanceBuffersMemory[i]);
     }
 
     vkDestroyDescriptorPool(device, descriptorPool, nullptr);
     vkDestroyDescriptorSetLayout(device,descriptorSetLayout, nullptr);
 
-    vkDestroyBuffer(device, indexBuffer, nullptr);
-    vkFreeMemory(device, indexBufferMemory, nullptr);
-
-    vkDestroyBuffer(device, vertexBuffer, nullptr);
-    vkFreeMemory(device, vertexBufferMemory, nullptr);
+    destroyBuffer(indexBuffer, indexBufferMemory);
+    destroyBuffer(vertexBuffer, vertexBufferMemory);
 
     cleanSyncObjects();
+    gpuProfiler.destroy();
 
+    destroyParallelRecording();
+    destroyCullingResources();
     vkDestroyCommandPool(device, commandPool, nullptr);
 
+    uploadManager.destroy();
+    queueScheduler.destroy();
+    allocator.destroy();
+
     vkDestroyDevice(device, nullptr);
 
     if (enableValidationLayers)
@@ -1150,11 +3242,17 @@ void TriangleVulkan::cleanup() {
         DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
     }
 
-    vkDestroySurfaceKHR(instance, surface, nullptr);
+    if (!options.headless)
+    {
+        vkDestroySurfaceKHR(instance, surface, nullptr);
+    }
     vkDestroyInstance(instance, nullptr);
 
-    glfwDestroyWindow(window);
-    glfwTerminate();
+    if (!options.headless)
+    {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
 }
 
 VkResult TriangleVulkan::CreateDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT *pCreateInfo,const VkAllocationCallbacks *pAllocator,VkDebugUtilsMessengerEXT *pDebugMessenger)
@@ -1241,10 +3339,20 @@ void TriangleVulkan::createDescriptorSetLayout() {
     uboLayoutBinding.pImmutableSamplers = nullptr;
     uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
+    // данные объекта: один и тот же буфер кадра, смещение задается при vkCmdBindDescriptorSets
+    VkDescriptorSetLayoutBinding objectLayoutBinding{};
+    objectLayoutBinding.binding = 1;
+    objectLayoutBinding.descriptorCount = 1;
+    objectLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    objectLayoutBinding.pImmutableSamplers = nullptr;
+    objectLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings = {uboLayoutBinding, objectLayoutBinding};
+
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = 1;
-    layoutInfo.pBindings = &uboLayoutBinding;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
 
     if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create descriptor set layout!");
@@ -1252,29 +3360,31 @@ void TriangleVulkan::createDescriptorSetLayout() {
 }
 
 void TriangleVulkan::updateUniformBuffer(uint32_t currentImage) {
-    static auto startTime = std::chrono::high_resolution_clock::now();
+    float time = animationTime();
 
-    auto currentTime = std::chrono::high_resolution_clock::now();
-    float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+    // вращение сцены не в UBO: оно входит в model каждого объекта (кольцо или push constants)
+    sceneTransform = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
 
     UniformBufferObject ubo{};
-    ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     ubo.proj = glm::perspective(glm::radians(45.0f), swapChainExtent.width / (float) swapChainExtent.height, 0.1f, 10.0f);
     ubo.proj[1][1] *= -1;
 
     memcpy(uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
+    lastUbo = ubo;
 }
 
 void TriangleVulkan::createDescriptorPool() {
-    VkDescriptorPoolSize poolSize{};
-    poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSize.descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = 1;
-    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
     poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
 
     if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
@@ -1303,15 +3413,29 @@ void TriangleVulkan::createDescriptorSets() {
         bufferInfo.offset = 0;
         bufferInfo.range = sizeof(UniformBufferObject);
 
-        VkWriteDescriptorSet descriptorWrite{};
-        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrite.dstSet = descriptorSets[i];
-        descriptorWrite.dstBinding = 0;
-        descriptorWrite.dstArrayElement = 0;
-        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        descriptorWrite.descriptorCount = 1;
-        descriptorWrite.pBufferInfo = &bufferInfo;
-
-        vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+        // range - одна запись, начало окна сдвигается dynamic offset
+        VkDescriptorBufferInfo objectBufferInfo{};
+        objectBufferInfo.buffer = uniformRing.buffer(i);
+        objectBufferInfo.offset = 0;
+        objectBufferInfo.range = sizeof(ObjectUniforms);
+
+        std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+        descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[0].dstSet = descriptorSets[i];
+        descriptorWrites[0].dstBinding = 0;
+        descriptorWrites[0].dstArrayElement = 0;
+        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        descriptorWrites[0].descriptorCount = 1;
+        descriptorWrites[0].pBufferInfo = &bufferInfo;
+
+        descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[1].dstSet = descriptorSets[i];
+        descriptorWrites[1].dstBinding = 1;
+        descriptorWrites[1].dstArrayElement = 0;
+        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        descriptorWrites[1].descriptorCount = 1;
+        descriptorWrites[1].pBufferInfo = &objectBufferInfo;
+
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
     }
 }
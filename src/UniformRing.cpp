@@ -0,0 +1,69 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "UniformRing.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+void UniformRing::init(VkDevice device, DeviceAllocator& allocator, VkDeviceSize minAlignment,
+                       uint32_t framesInFlight, VkDeviceSize frameCapacity)
+{
+    this->device = device;
+    this->allocator = &allocator;
+    align = std::max<VkDeviceSize>(minAlignment, 1);
+    this->frameCapacity = (frameCapacity + align - 1) / align * align;
+
+    frames.resize(framesInFlight);
+    for (auto& frame : frames)
+    {
+        VkBufferCreateInfo bufferInfo{};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = this->frameCapacity;
+        bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(device, &bufferInfo, nullptr, &frame.buffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create uniform ring buffer!");
+        }
+
+        // HOST_COHERENT: записанное видно GPU после vkQueueSubmit без vkFlushMappedMemoryRanges
+        VkMemoryRequirements memRequirements{};
+        vkGetBufferMemoryRequirements(device, frame.buffer, &memRequirements);
+        frame.memory = allocator.allocate(memRequirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                          ResourceKind::Linear);
+        vkBindBufferMemory(device, frame.buffer, frame.memory.memory, frame.memory.offset);
+    }
+}
+
+void UniformRing::destroy()
+{
+    for (auto& frame : frames)
+    {
+        vkDestroyBuffer(device, frame.buffer, nullptr);
+        allocator->free(frame.memory);
+    }
+    frames.clear();
+}
+
+void UniformRing::beginFrame(uint32_t frame)
+{
+    currentFrame = frame;
+    head = 0;
+}
+
+uint32_t UniformRing::allocate(VkDeviceSize size, void*& data)
+{
+    VkDeviceSize offset = head;
+    VkDeviceSize alignedSize = (size + align - 1) / align * align;
+    if (offset + alignedSize > frameCapacity)
+    {
+        throw std::runtime_error("uniform ring overflow: increase the per-frame capacity");
+    }
+
+    head += alignedSize;
+    data = static_cast<char*>(frames[currentFrame].memory.mapped) + offset;
+    return static_cast<uint32_t>(offset);
+}
@@ -0,0 +1,403 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "UploadManager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// смещение источника в vkCmdCopyBuffer произвольное, но выровненные копии быстрее на большинстве GPU
+const VkDeviceSize STAGING_ALIGNMENT = 16;
+
+} // namespace
+
+void UploadManager::init(VkDevice device, DeviceAllocator& allocator, VkQueue queue, uint32_t queueFamilyIndex,
+                         TimelineSemaphore* timeline, uint32_t consumerFamily, VkDeviceSize stagingSize)
+{
+    this->device = device;
+    this->allocator = &allocator;
+    this->queue = queue;
+    this->timeline = timeline;
+    queueFamily = queueFamilyIndex;
+    // то же семейство - владение передавать не нужно, хватает барьера в конце батча
+    this->consumerFamily = consumerFamily == queueFamilyIndex ? VK_QUEUE_FAMILY_IGNORED : consumerFamily;
+    ringSize = stagingSize;
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = queueFamilyIndex;
+
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create upload command pool!");
+    }
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = ringSize;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &stagingBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create staging ring buffer!");
+    }
+
+    VkMemoryRequirements memRequirements{};
+    vkGetBufferMemoryRequirements(device, stagingBuffer, &memRequirements);
+    stagingMemory = allocator.allocate(memRequirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                       ResourceKind::Linear);
+    vkBindBufferMemory(device, stagingBuffer, stagingMemory.memory, stagingMemory.offset);
+}
+
+void UploadManager::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    if (recording)
+    {
+        flush();
+    }
+    waitIdle();
+
+    for (auto& batch : freeBatches)
+    {
+        vkDestroyFence(device, batch.fence, nullptr);
+    }
+    freeBatches.clear();
+
+    vkDestroyCommandPool(device, commandPool, nullptr);
+    vkDestroyBuffer(device, stagingBuffer, nullptr);
+    allocator->free(stagingMemory);
+    device = VK_NULL_HANDLE;
+}
+
+UploadTicket UploadManager::upload(VkBuffer dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size, bool concurrent)
+{
+    retireCompleted(false);
+
+    if (!concurrent && consumerFamily != VK_QUEUE_FAMILY_IGNORED &&
+        std::find(unreleasedBuffers.begin(), unreleasedBuffers.end(), dst) == unreleasedBuffers.end())
+    {
+        unreleasedBuffers.push_back(dst);
+    }
+
+    // кусок не больше половины кольца - тогда после освобождения старых батчей место всегда найдется
+    const VkDeviceSize maxChunk = ringSize / 2;
+    const char* source = static_cast<const char*>(data);
+
+    VkDeviceSize done = 0;
+    while (done < size)
+    {
+        VkDeviceSize chunk = std::min(maxChunk, size - done);
+
+        VkDeviceSize stagingOffset = 0;
+        while (!allocateStaging(chunk, stagingOffset))
+        {
+            // кольцо заполнено: отправляем то, что накопили, и ждем самый старый батч.
+            // Владение пока не передаем - в буфер может еще писать следующий батч
+            if (recording)
+            {
+                submitBatch(false);
+            }
+            counters.stagingStalls++;
+            retireCompleted(true);
+        }
+
+        memcpy(static_cast<char*>(stagingMemory.mapped) + stagingOffset, source + done, static_cast<size_t>(chunk));
+
+        VkBufferCopy copyRegion{};
+        copyRegion.srcOffset = stagingOffset;
+        copyRegion.dstOffset = dstOffset + done;
+        copyRegion.size = chunk;
+        vkCmdCopyBuffer(currentBatch().commandBuffer, stagingBuffer, dst, 1, &copyRegion);
+
+        done += chunk;
+    }
+
+    counters.bytesUploaded += size;
+    return recording ? recordingBatch.ticket : lastSubmittedTicket;
+}
+
+UploadTicket UploadManager::flush()
+{
+    if (!recording)
+    {
+        return lastSubmittedTicket;
+    }
+    return submitBatch(true);
+}
+
+std::vector<VkBufferMemoryBarrier> UploadManager::takeAcquireBarriers()
+{
+    std::vector<VkBufferMemoryBarrier> barriers;
+    barriers.swap(pendingAcquires);
+    return barriers;
+}
+
+UploadTicket UploadManager::submitBatch(bool releaseOwnership)
+{
+    Batch batch = recordingBatch;
+    recording = false;
+
+    if (consumerFamily == VK_QUEUE_FAMILY_IGNORED)
+    {
+        // копирования должны быть видны всему, что отправлено в очередь позже: вершинам, индексам, uniform/storage чтению
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+                             1, &barrier, 0, nullptr, 0, nullptr);
+    }
+    else if (releaseOwnership && !unreleasedBuffers.empty())
+    {
+        // release: половина передачи владения, вторую (acquire с теми же параметрами) запишет потребитель.
+        // dstAccessMask у release игнорируется; видимость потребителю дает семафор + acquire
+        std::vector<VkBufferMemoryBarrier> releases;
+        for (VkBuffer buffer : unreleasedBuffers)
+        {
+            VkBufferMemoryBarrier release{};
+            release.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            release.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            release.dstAccessMask = 0;
+            release.srcQueueFamilyIndex = queueFamily;
+            release.dstQueueFamilyIndex = consumerFamily;
+            release.buffer = buffer;
+            release.offset = 0;
+            release.size = VK_WHOLE_SIZE;
+            releases.push_back(release);
+
+            VkBufferMemoryBarrier acquire = release;
+            acquire.srcAccessMask = 0;
+            acquire.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+            pendingAcquires.push_back(acquire);
+        }
+        unreleasedBuffers.clear();
+
+        vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                             0, nullptr, static_cast<uint32_t>(releases.size()), releases.data(), 0, nullptr);
+    }
+
+    if (vkEndCommandBuffer(batch.commandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to record upload command buffer!");
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.commandBuffer;
+
+    // батч сигналит следующее значение счетчика; binary семафоров здесь нет, значение одно
+    VkTimelineSemaphoreSubmitInfoKHR timelineInfo{};
+    VkSemaphore timelineSemaphore = VK_NULL_HANDLE;
+    if (timeline != nullptr)
+    {
+        batch.timelineValue = timeline->next();
+        timelineSemaphore = timeline->handle();
+
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &batch.timelineValue;
+
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &timelineSemaphore;
+    }
+
+    if (vkQueueSubmit(queue, 1, &submitInfo, batch.fence) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to submit upload batch!");
+    }
+
+    submitted.push_back(batch);
+    lastSubmittedTicket = batch.ticket;
+    counters.batchesSubmitted++;
+    return batch.ticket;
+}
+
+bool UploadManager::isComplete(UploadTicket ticket)
+{
+    retireCompleted(false);
+    return ticket <= completedTicket;
+}
+
+void UploadManager::wait(UploadTicket ticket)
+{
+    if (recording && ticket >= recordingBatch.ticket)
+    {
+        flush();
+    }
+
+    // fence батча покрывает и все, что отправлено в очередь раньше, поэтому старые батчи завершены тоже
+    while (ticket > completedTicket && !submitted.empty())
+    {
+        retireCompleted(true);
+    }
+}
+
+void UploadManager::waitIdle()
+{
+    if (recording)
+    {
+        flush();
+    }
+    wait(lastSubmittedTicket);
+}
+
+UploadStats UploadManager::stats() const
+{
+    return counters;
+}
+
+void UploadManager::printStats(std::ostream& out) const
+{
+    out << "uploads: " << counters.bytesUploaded / 1024 << " KiB in " << counters.batchesSubmitted
+        << " batches, staging stalls " << counters.stagingStalls << std::endl;
+}
+
+UploadManager::Batch& UploadManager::currentBatch()
+{
+    if (!recording)
+    {
+        recordingBatch = acquireBatchObjects();
+        recordingBatch.ticket = nextTicket++;
+        recordingBatch.ringBytes = 0;
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        if (vkBeginCommandBuffer(recordingBatch.commandBuffer, &beginInfo) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to begin upload command buffer!");
+        }
+        recording = true;
+    }
+    return recordingBatch;
+}
+
+bool UploadManager::allocateStaging(VkDeviceSize size, VkDeviceSize& offset)
+{
+    VkDeviceSize aligned = (ringHead + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+    VkDeviceSize skipped = aligned - ringHead;
+
+    // не помещается до конца кольца - хвост пропускаем и начинаем с нуля
+    if (aligned + size > ringSize)
+    {
+        skipped = ringSize - ringHead;
+        aligned = 0;
+    }
+
+    if (ringUsed + skipped + size > ringSize)
+    {
+        return false;
+    }
+
+    // байты засчитываются батчу, который будет их читать; открываем его, если еще не открыт
+    Batch& batch = currentBatch();
+    batch.ringBytes += skipped + size;
+    ringUsed += skipped + size;
+    ringHead = aligned + size;
+    offset = aligned;
+    return true;
+}
+
+uint64_t UploadManager::pendingTimelineValue() const
+{
+    return submitted.empty() ? 0 : submitted.back().timelineValue;
+}
+
+bool UploadManager::isBatchComplete(const Batch& batch)
+{
+    if (timeline != nullptr)
+    {
+        return timeline->isComplete(batch.timelineValue);
+    }
+    return vkGetFenceStatus(device, batch.fence) == VK_SUCCESS;
+}
+
+void UploadManager::retireCompleted(bool waitOldest)
+{
+    if (waitOldest && !submitted.empty())
+    {
+        if (timeline != nullptr)
+        {
+            timeline->wait(submitted.front().timelineValue);
+        }
+        else
+        {
+            vkWaitForFences(device, 1, &submitted.front().fence, VK_TRUE, UINT64_MAX);
+        }
+    }
+
+    while (!submitted.empty() && isBatchComplete(submitted.front()))
+    {
+        Batch batch = submitted.front();
+        submitted.pop_front();
+
+        ringUsed -= batch.ringBytes;
+        completedTicket = batch.ticket;
+
+        if (batch.fence != VK_NULL_HANDLE)
+        {
+            vkResetFences(device, 1, &batch.fence);
+        }
+        batch.timelineValue = 0;
+        vkResetCommandBuffer(batch.commandBuffer, 0);
+        freeBatches.push_back(batch);
+    }
+
+    // все отправленное завершено - кольцо пустое, можно начинать с начала (если ничего не пишется сейчас)
+    if (submitted.empty() && !recording)
+    {
+        ringHead = 0;
+        ringUsed = 0;
+    }
+}
+
+UploadManager::Batch UploadManager::acquireBatchObjects()
+{
+    if (!freeBatches.empty())
+    {
+        Batch batch = freeBatches.back();
+        freeBatches.pop_back();
+        return batch;
+    }
+
+    Batch batch;
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(device, &allocInfo, &batch.commandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate upload command buffer!");
+    }
+
+    if (timeline != nullptr)
+    {
+        return batch;
+    }
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    if (vkCreateFence(device, &fenceInfo, nullptr, &batch.fence) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create upload fence!");
+    }
+    return batch;
+}
@@ -0,0 +1,382 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+#include "VertexFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <glm/gtc/matrix_transform.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VERTEX_FORMAT_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const float SNORM16_MAX = 32767.0f;
+
+// Кодируются только значения из [-1, 1] (после QuantizationBounds), поэтому переполнения и inf не бывает,
+// а все, что меньше минимального нормального half (2^-14), уходит в ноль - денормали на такой шкале не нужны.
+// Округление к ближайшему четному, как у аппаратного преобразования
+uint16_t floatToHalf(float value)
+{
+    value = std::clamp(value, -1.0f, 1.0f);
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t magnitude = bits & 0x7FFFFFFFu;
+    if (magnitude < 0x38800000u)
+    {
+        return static_cast<uint16_t>(sign);
+    }
+    magnitude += 0x0FFFu + ((magnitude >> 13) & 1u);
+    return static_cast<uint16_t>(sign | ((magnitude - 0x38000000u) >> 13)); // экспонента 127 -> 15
+}
+
+int16_t floatToSnorm16(float value)
+{
+    return static_cast<int16_t>(std::lrintf(std::clamp(value, -1.0f, 1.0f) * SNORM16_MAX));
+}
+
+uint32_t colorToUnorm8(const glm::vec3& color)
+{
+    auto channel = [](float value) { return static_cast<uint32_t>(std::lrintf(std::clamp(value, 0.0f, 1.0f) * 255.0f)); };
+    return channel(color.x) | channel(color.y) << 8 | channel(color.z) << 16 | 255u << 24;
+}
+
+void encodeScalar(const Vertex* src, size_t count, VertexFormat format, const QuantizationBounds& bounds, PackedVertex* dst)
+{
+    float scale = 1.0f / bounds.extent;
+    for (size_t i = 0; i < count; i++)
+    {
+        glm::vec3 pos = (src[i].pos - bounds.center) * scale;
+        for (int c = 0; c < 3; c++)
+        {
+            dst[i].pos[c] = format == VertexFormat::Half ? floatToHalf(pos[c]) : static_cast<uint16_t>(floatToSnorm16(pos[c]));
+        }
+        dst[i].pos[3] = 0;
+        dst[i].color = colorToUnorm8(src[i].color);
+    }
+}
+
+uint32_t encodeOct16(glm::vec3 n)
+{
+    n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    float x = n.x;
+    float y = n.y;
+    if (n.z < 0.0f)
+    {
+        // нижняя полусфера заворачивается в углы квадрата
+        x = std::copysign(1.0f - std::abs(n.y), n.x);
+        y = std::copysign(1.0f - std::abs(n.x), n.y);
+    }
+    return static_cast<uint16_t>(floatToSnorm16(x)) | static_cast<uint32_t>(static_cast<uint16_t>(floatToSnorm16(y))) << 16;
+}
+
+#ifdef VERTEX_FORMAT_SSE2
+
+// 4 x int32 -> 4 x int16 без насыщения: packs_epi32 насыщает, поэтому сначала расширяем знак младших 16 бит
+__m128i truncatePack16(__m128i value)
+{
+    value = _mm_srai_epi32(_mm_slli_epi32(value, 16), 16);
+    return _mm_packs_epi32(value, value);
+}
+
+__m128 clampSigned(__m128 value)
+{
+    return _mm_min_ps(_mm_max_ps(value, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+}
+
+// floatToHalf() сразу для 4 компонент
+__m128i floatToHalf4(__m128 value)
+{
+    __m128i bits = _mm_castps_si128(clampSigned(value));
+    __m128i sign = _mm_and_si128(_mm_srli_epi32(bits, 16), _mm_set1_epi32(0x8000));
+    __m128i magnitude = _mm_and_si128(bits, _mm_set1_epi32(0x7FFFFFFF));
+    __m128i tiny = _mm_cmplt_epi32(magnitude, _mm_set1_epi32(0x38800000));
+
+    __m128i odd = _mm_and_si128(_mm_srli_epi32(magnitude, 13), _mm_set1_epi32(1));
+    __m128i rounded = _mm_add_epi32(_mm_add_epi32(magnitude, _mm_set1_epi32(0x0FFF)), odd);
+    __m128i half = _mm_srli_epi32(_mm_sub_epi32(rounded, _mm_set1_epi32(0x38000000)), 13);
+
+    return _mm_or_si128(_mm_andnot_si128(tiny, half), sign);
+}
+
+// round(clamp(x) * 32767): cvtps_epi32 округляет к ближайшему четному, как lrintf
+__m128i floatToSnorm16x4(__m128 value)
+{
+    return _mm_cvtps_epi32(_mm_mul_ps(clampSigned(value), _mm_set1_ps(SNORM16_MAX)));
+}
+
+void encodeSse2(const Vertex* src, size_t count, VertexFormat format, const QuantizationBounds& bounds, PackedVertex* dst)
+{
+    float scale = 1.0f / bounds.extent;
+    const __m128 center = _mm_setr_ps(bounds.center.x, bounds.center.y, bounds.center.z, 0.0f);
+    const __m128 scale4 = _mm_set1_ps(scale);
+    // четвертая компонента загрузки - color.r, в выравнивание должен попасть +0
+    const __m128 xyzMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 unorm8 = _mm_set1_ps(255.0f);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        // 16 байт с начала вершины: pos.xyz и color.r - в пределах 24-байтной Vertex
+        __m128 pos = _mm_and_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&src[i].pos.x), center), scale4), xyzMask);
+        __m128i packedPos = format == VertexFormat::Half ? truncatePack16(floatToHalf4(pos))
+                                                         : _mm_packs_epi32(floatToSnorm16x4(pos), floatToSnorm16x4(pos));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst[i].pos), packedPos);
+
+        // pos.z, r, g, b -> 1, r, g, b: альфа в нулевой компоненте, потом поворот на байт
+        __m128 color = _mm_move_ss(_mm_loadu_ps(&src[i].pos.z), one);
+        color = _mm_mul_ps(_mm_min_ps(_mm_max_ps(color, zero), one), unorm8);
+        __m128i bytes = _mm_cvtps_epi32(color);
+        bytes = _mm_packs_epi32(bytes, bytes);
+        bytes = _mm_packus_epi16(bytes, bytes);
+        uint32_t argb = static_cast<uint32_t>(_mm_cvtsi128_si32(bytes));
+        dst[i].color = argb >> 8 | argb << 24;
+    }
+}
+
+// 4 нормали за проход: AoS vec3 раскладываются по компонентам, дальше та же арифметика, что в encodeOct16()
+void encodeOct16Sse2(const glm::vec3* normals, size_t count, uint32_t* dst)
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const glm::vec3* n = normals + i;
+        __m128 x = _mm_setr_ps(n[0].x, n[1].x, n[2].x, n[3].x);
+        __m128 y = _mm_setr_ps(n[0].y, n[1].y, n[2].y, n[3].y);
+        __m128 z = _mm_setr_ps(n[0].z, n[1].z, n[2].z, n[3].z);
+
+        __m128 sum = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(signMask, x), _mm_andnot_ps(signMask, y)), _mm_andnot_ps(signMask, z));
+        x = _mm_div_ps(x, sum);
+        y = _mm_div_ps(y, sum);
+        z = _mm_div_ps(z, sum);
+
+        // 1 - |v| >= 0, поэтому copysign - это просто OR знакового бита
+        __m128 foldedX = _mm_or_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, y)), _mm_and_ps(x, signMask));
+        __m128 foldedY = _mm_or_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, x)), _mm_and_ps(y, signMask));
+        __m128 lower = _mm_cmplt_ps(z, _mm_setzero_ps());
+        x = _mm_or_ps(_mm_and_ps(lower, foldedX), _mm_andnot_ps(lower, x));
+        y = _mm_or_ps(_mm_and_ps(lower, foldedY), _mm_andnot_ps(lower, y));
+
+        __m128i qx = _mm_and_si128(floatToSnorm16x4(x), _mm_set1_epi32(0xFFFF));
+        __m128i qy = _mm_slli_epi32(floatToSnorm16x4(y), 16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(qx, qy));
+    }
+    for (; i < count; i++)
+    {
+        dst[i] = encodeOct16(normals[i]);
+    }
+}
+
+#endif
+
+} // namespace
+
+const char* vertexFormatName(VertexFormat format)
+{
+    switch (format)
+    {
+        case VertexFormat::Float32: return "float32";
+        case VertexFormat::Half:    return "half";
+        case VertexFormat::Snorm16: return "snorm16";
+    }
+    return "unknown";
+}
+
+VertexFormat parseVertexFormat(const std::string& name)
+{
+    for (VertexFormat format : {VertexFormat::Float32, VertexFormat::Half, VertexFormat::Snorm16})
+    {
+        if (name == vertexFormatName(format))
+        {
+            return format;
+        }
+    }
+    throw std::runtime_error("unknown vertex format: " + name);
+}
+
+QuantizationBounds QuantizationBounds::compute(const Vertex* vertices, size_t count)
+{
+    QuantizationBounds bounds;
+    if (count == 0)
+    {
+        return bounds;
+    }
+
+    glm::vec3 lo = vertices[0].pos;
+    glm::vec3 hi = vertices[0].pos;
+    for (size_t i = 1; i < count; i++)
+    {
+        lo = glm::min(lo, vertices[i].pos);
+        hi = glm::max(hi, vertices[i].pos);
+    }
+
+    glm::vec3 halfSize = (hi - lo) * 0.5f;
+    bounds.center = (lo + hi) * 0.5f;
+    bounds.extent = std::max({halfSize.x, halfSize.y, halfSize.z, 1e-6f});
+    return bounds;
+}
+
+glm::mat4 QuantizationBounds::dequantizeTransform() const
+{
+    return glm::scale(glm::translate(glm::mat4(1.0f), center), glm::vec3(extent));
+}
+
+VertexLayout VertexLayout::get(VertexFormat format, bool split)
+{
+    // все форматы ниже обязаны поддерживаться как вершинные (VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT)
+    switch (format)
+    {
+        case VertexFormat::Float32:
+            return split ? from<SplitVertexInput<VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT>>(format, split)
+                         : from<Float32VertexInput>(format, split);
+        case VertexFormat::Half:
+            return split ? from<SplitVertexInput<VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_R8G8B8A8_UNORM>>(format, split)
+                         : from<PackedVertexInput<VK_FORMAT_R16G16B16A16_SFLOAT>>(format, split);
+        case VertexFormat::Snorm16:
+            return split ? from<SplitVertexInput<VK_FORMAT_R16G16B16A16_SNORM, VK_FORMAT_R8G8B8A8_UNORM>>(format, split)
+                         : from<PackedVertexInput<VK_FORMAT_R16G16B16A16_SNORM>>(format, split);
+    }
+    throw std::runtime_error("unknown vertex format");
+}
+
+uint32_t VertexLayout::stride() const
+{
+    uint32_t total = 0;
+    for (const auto& binding : bindings)
+    {
+        total += binding.stride;
+    }
+    return total;
+}
+
+VkDeviceSize VertexLayout::streamOffset(size_t binding, size_t vertexCount) const
+{
+    VkDeviceSize offset = 0;
+    for (size_t i = 0; i < binding; i++)
+    {
+        offset += static_cast<VkDeviceSize>(bindings[i].stride) * vertexCount;
+    }
+    return offset;
+}
+
+void deinterleaveVertices(const void* src, size_t count, const VertexLayout& interleaved, const VertexLayout& split, void* dst)
+{
+    if (interleaved.bindings.size() != 1)
+    {
+        throw std::runtime_error("deinterleaveVertices: source layout must have a single binding");
+    }
+
+    const auto* source = static_cast<const uint8_t*>(src);
+    auto* target = static_cast<uint8_t*>(dst);
+    uint32_t sourceStride = interleaved.bindings[0].stride;
+
+    for (const auto& attribute : split.attributes)
+    {
+        auto match = std::find_if(interleaved.attributes.begin(), interleaved.attributes.end(),
+                                  [&](const VkVertexInputAttributeDescription& a) { return a.location == attribute.location; });
+        if (match == interleaved.attributes.end() || match->format != attribute.format)
+        {
+            throw std::runtime_error("deinterleaveVertices: layouts do not describe the same attributes");
+        }
+
+        uint32_t size = vertexFormatSize(attribute.format);
+        uint32_t targetStride = split.bindings[attribute.binding].stride;
+        uint8_t* stream = target + split.streamOffset(attribute.binding, count) + attribute.offset;
+        const uint8_t* from = source + match->offset;
+        for (size_t i = 0; i < count; i++)
+        {
+            std::memcpy(stream + i * targetStride, from + i * sourceStride, size);
+        }
+    }
+}
+
+void encodeVertices(const Vertex* src, size_t count, VertexFormat format, const QuantizationBounds& bounds,
+                    PackedVertex* dst, bool allowSimd)
+{
+    if (format == VertexFormat::Float32)
+    {
+        throw std::runtime_error("float32 vertices are not packed");
+    }
+#ifdef VERTEX_FORMAT_SSE2
+    if (allowSimd)
+    {
+        encodeSse2(src, count, format, bounds, dst);
+        return;
+    }
+#endif
+    encodeScalar(src, count, format, bounds, dst);
+}
+
+void encodeNormalsOct16(const glm::vec3* normals, size_t count, uint32_t* dst, bool allowSimd)
+{
+#ifdef VERTEX_FORMAT_SSE2
+    if (allowSimd)
+    {
+        encodeOct16Sse2(normals, count, dst);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = encodeOct16(normals[i]);
+    }
+}
+
+glm::vec3 decodeNormalOct16(uint32_t encoded)
+{
+    float x = std::max(static_cast<int16_t>(encoded & 0xFFFFu) / SNORM16_MAX, -1.0f);
+    float y = std::max(static_cast<int16_t>(encoded >> 16) / SNORM16_MAX, -1.0f);
+    glm::vec3 n(x, y, 1.0f - std::abs(x) - std::abs(y));
+    if (n.z < 0.0f)
+    {
+        n.x = std::copysign(1.0f - std::abs(y), x);
+        n.y = std::copysign(1.0f - std::abs(x), y);
+    }
+    return glm::normalize(n);
+}
+
+float halfToFloat(uint16_t value)
+{
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1Fu;
+    uint32_t mantissa = value & 0x3FFu;
+
+    float result;
+    if (exponent == 0)
+    {
+        result = std::ldexp(static_cast<float>(mantissa), -24); // денормаль
+    }
+    else if (exponent == 31)
+    {
+        result = mantissa == 0 ? INFINITY : NAN;
+    }
+    else
+    {
+        uint32_t bits = (exponent + 112) << 23 | mantissa << 13;
+        std::memcpy(&result, &bits, sizeof(result));
+    }
+    return sign != 0 ? -result : result;
+}
+
+glm::vec3 decodePosition(const PackedVertex& vertex, VertexFormat format, const QuantizationBounds& bounds)
+{
+    glm::vec3 pos;
+    for (int c = 0; c < 3; c++)
+    {
+        pos[c] = format == VertexFormat::Half ? halfToFloat(vertex.pos[c])
+                                              : std::max(static_cast<int16_t>(vertex.pos[c]) / SNORM16_MAX, -1.0f);
+    }
+    return bounds.center + pos * bounds.extent;
+}
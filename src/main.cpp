@@ -1,10 +1,18 @@
 #include "TriangleVulkan.h"
+#include "AppOptions.h"
 
-int main()
+int main(int argc, char** argv)
 {
-    TriangleVulkan triangle;
     try
     {
+        AppOptions options = parseAppOptions(argc, argv);
+        if (options.showHelp)
+        {
+            printUsage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+
+        TriangleVulkan triangle(options);
         triangle.run();
     }
     catch(const std::exception& exp)
@@ -0,0 +1,329 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+// Офлайн конвертер OBJ -> .vmesh (см. inc/MeshFile.h).
+// Весь разбор текста, триангуляция и объединение одинаковых вершин - здесь, один раз;
+// приложение только отображает готовый файл и копирует диапазоны в staging.
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "MappedFile.h"
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+
+namespace {
+
+// совпадает с Vertex в VertexFormat.h (VMESH_VERTEX_POSITION_COLOR)
+struct MeshVertex {
+    float position[3];
+    float color[3];
+};
+
+struct ObjData {
+    std::vector<float> positions; // xyz
+    std::vector<float> colors;    // rgb, только если у всех v есть цвет (расширение "v x y z r g b")
+    std::vector<float> normals;   // xyz
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::unordered_map<uint64_t, uint32_t> vertexMap; // (позиция, нормаль) -> индекс вершины
+};
+
+std::string_view nextToken(std::string_view& line)
+{
+    size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string_view::npos)
+    {
+        line = {};
+        return {};
+    }
+    size_t end = line.find_first_of(" \t\r", start);
+    std::string_view token = line.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+    line = end == std::string_view::npos ? std::string_view() : line.substr(end);
+    return token;
+}
+
+float parseFloat(std::string_view token, size_t lineNumber)
+{
+    float value = 0.0f;
+    auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+    if (result.ec != std::errc())
+    {
+        throw std::runtime_error("line " + std::to_string(lineNumber) + ": invalid number '" + std::string(token) + "'");
+    }
+    return value;
+}
+
+// индексы OBJ с 1, отрицательные - от конца уже прочитанного списка; 0 - индекса нет
+uint32_t resolveIndex(std::string_view token, size_t count, size_t lineNumber)
+{
+    if (token.empty())
+    {
+        return 0;
+    }
+    long long value = 0;
+    auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+    if (result.ec != std::errc() || value == 0)
+    {
+        throw std::runtime_error("line " + std::to_string(lineNumber) + ": invalid index '" + std::string(token) + "'");
+    }
+    long long resolved = value > 0 ? value : static_cast<long long>(count) + value + 1;
+    if (resolved < 1 || resolved > static_cast<long long>(count))
+    {
+        throw std::runtime_error("line " + std::to_string(lineNumber) + ": index out of range");
+    }
+    return static_cast<uint32_t>(resolved);
+}
+
+uint32_t addVertex(ObjData& obj, std::string_view token, size_t lineNumber)
+{
+    // v, v/vt, v//vn, v/vt/vn - текстурные координаты формату не нужны
+    size_t firstSlash = token.find('/');
+    std::string_view positionToken = token.substr(0, firstSlash);
+    std::string_view normalToken;
+    if (firstSlash != std::string_view::npos)
+    {
+        size_t secondSlash = token.find('/', firstSlash + 1);
+        if (secondSlash != std::string_view::npos)
+        {
+            normalToken = token.substr(secondSlash + 1);
+        }
+    }
+
+    uint32_t position = resolveIndex(positionToken, obj.positions.size() / 3, lineNumber);
+    uint32_t normal = resolveIndex(normalToken, obj.normals.size() / 3, lineNumber);
+    if (position == 0)
+    {
+        throw std::runtime_error("line " + std::to_string(lineNumber) + ": face vertex without position");
+    }
+
+    uint64_t key = (static_cast<uint64_t>(position) << 32) | normal;
+    auto found = obj.vertexMap.find(key);
+    if (found != obj.vertexMap.end())
+    {
+        return found->second;
+    }
+
+    MeshVertex vertex{};
+    std::memcpy(vertex.position, &obj.positions[(position - 1) * 3], sizeof(vertex.position));
+    if (obj.colors.size() == obj.positions.size())
+    {
+        std::memcpy(vertex.color, &obj.colors[(position - 1) * 3], sizeof(vertex.color));
+    }
+    else if (normal != 0)
+    {
+        // цвета нет - нормаль в [0, 1], чтобы форма была видна без освещения
+        for (int i = 0; i < 3; i++)
+        {
+            vertex.color[i] = obj.normals[(normal - 1) * 3 + i] * 0.5f + 0.5f;
+        }
+    }
+    else
+    {
+        vertex.color[0] = vertex.color[1] = vertex.color[2] = 1.0f;
+    }
+
+    uint32_t index = static_cast<uint32_t>(obj.vertices.size());
+    obj.vertices.push_back(vertex);
+    obj.vertexMap.emplace(key, index);
+    return index;
+}
+
+void parseObj(const std::string& path, ObjData& obj)
+{
+    MappedFile file(path);
+    std::string_view text(static_cast<const char*>(file.data()), file.size());
+
+    size_t lineNumber = 0;
+    std::vector<uint32_t> polygon;
+    while (!text.empty())
+    {
+        size_t end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+        lineNumber++;
+
+        std::string_view keyword = nextToken(line);
+        if (keyword == "v")
+        {
+            float values[6];
+            int count = 0;
+            for (std::string_view token = nextToken(line); !token.empty() && count < 6; token = nextToken(line))
+            {
+                values[count++] = parseFloat(token, lineNumber);
+            }
+            if (count < 3)
+            {
+                throw std::runtime_error("line " + std::to_string(lineNumber) + ": vertex needs 3 coordinates");
+            }
+            obj.positions.insert(obj.positions.end(), values, values + 3);
+            if (count == 6)
+            {
+                obj.colors.insert(obj.colors.end(), values + 3, values + 6);
+            }
+        }
+        else if (keyword == "vn")
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                obj.normals.push_back(parseFloat(nextToken(line), lineNumber));
+            }
+        }
+        else if (keyword == "f")
+        {
+            polygon.clear();
+            for (std::string_view token = nextToken(line); !token.empty(); token = nextToken(line))
+            {
+                polygon.push_back(addVertex(obj, token, lineNumber));
+            }
+            if (polygon.size() < 3)
+            {
+                throw std::runtime_error("line " + std::to_string(lineNumber) + ": face needs at least 3 vertices");
+            }
+            // многоугольник - веером треугольников
+            for (size_t i = 1; i + 1 < polygon.size(); i++)
+            {
+                obj.indices.insert(obj.indices.end(), {polygon[0], polygon[i], polygon[i + 1]});
+            }
+        }
+        // vt, o, g, s, usemtl, mtllib и комментарии формату не нужны
+    }
+}
+
+void computeBounds(const std::vector<MeshVertex>& vertices, VMeshHeader& header)
+{
+    float minimum[3] = {vertices[0].position[0], vertices[0].position[1], vertices[0].position[2]};
+    float maximum[3] = {minimum[0], minimum[1], minimum[2]};
+    for (const auto& vertex : vertices)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            minimum[i] = std::min(minimum[i], vertex.position[i]);
+            maximum[i] = std::max(maximum[i], vertex.position[i]);
+        }
+    }
+
+    float radiusSquared = 0.0f;
+    for (int i = 0; i < 3; i++)
+    {
+        header.boundsCenter[i] = (minimum[i] + maximum[i]) * 0.5f;
+    }
+    for (const auto& vertex : vertices)
+    {
+        float distanceSquared = 0.0f;
+        for (int i = 0; i < 3; i++)
+        {
+            float d = vertex.position[i] - header.boundsCenter[i];
+            distanceSquared += d * d;
+        }
+        radiusSquared = std::max(radiusSquared, distanceSquared);
+    }
+    header.boundsRadius = std::sqrt(radiusSquared);
+}
+
+void printUsage(const char* programName)
+{
+    std::cout << "Usage: " << programName << " input.obj output.vmesh [--index32] [--no-optimize]\n"
+              << "  --index32      always write 32-bit indices (default: 16-bit when the mesh has at most 65536 vertices)\n"
+              << "  --no-optimize  keep triangle and vertex order as in the OBJ file\n";
+}
+
+void printCacheStats(const char* label, const ObjData& obj)
+{
+    VertexCacheStats stats = analyzeVertexCache(obj.indices.data(), obj.indices.size(), obj.vertices.size());
+    std::cout << "  " << label << ": ACMR " << stats.acmr << ", ATVR " << stats.atvr
+              << " (FIFO " << stats.cacheSize << ")" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        std::vector<std::string> paths;
+        bool forceIndex32 = false;
+        bool optimize = true;
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--index32")
+            {
+                forceIndex32 = true;
+            }
+            else if (arg == "--no-optimize")
+            {
+                optimize = false;
+            }
+            else if (arg == "--help" || arg == "-h")
+            {
+                printUsage(argv[0]);
+                return EXIT_SUCCESS;
+            }
+            else
+            {
+                paths.push_back(arg);
+            }
+        }
+        if (paths.size() != 2)
+        {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        ObjData obj;
+        parseObj(paths[0], obj);
+        if (obj.indices.empty())
+        {
+            throw std::runtime_error("no faces in " + paths[0]);
+        }
+
+        // порядок треугольников под кэш вершин, затем вершины в порядке первого использования
+        if (optimize)
+        {
+            printCacheStats("before", obj);
+            optimizeVertexCache(obj.indices.data(), obj.indices.size(), obj.vertices.size());
+            size_t used = optimizeVertexFetch(obj.vertices.data(), obj.vertices.size(), sizeof(MeshVertex),
+                                              obj.indices.data(), obj.indices.size());
+            obj.vertices.resize(used);
+            printCacheStats("after", obj);
+        }
+
+        VMeshHeader header{};
+        header.vertexFormat = VMESH_VERTEX_POSITION_COLOR;
+        header.vertexStride = sizeof(MeshVertex);
+        header.vertexCount = obj.vertices.size();
+        header.indexCount = obj.indices.size();
+        header.indexSize = forceIndex32 ? 4 : chooseIndexSize(obj.vertices.size());
+        computeBounds(obj.vertices, header);
+
+        if (header.indexSize == 2)
+        {
+            std::vector<uint16_t> indices16(obj.indices.begin(), obj.indices.end());
+            writeMeshFile(paths[1], header, obj.vertices.data(), indices16.data());
+        }
+        else
+        {
+            writeMeshFile(paths[1], header, obj.vertices.data(), obj.indices.data());
+        }
+
+        std::cout << paths[1] << ": " << header.vertexCount << " vertices, " << header.indexCount / 3 << " triangles, "
+                  << header.indexSize * 8 << "-bit indices, bounds radius " << header.boundsRadius << std::endl;
+    }
+    catch (const std::exception& exp)
+    {
+        std::cerr << exp.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,78 @@
+//
+// Created by winlogon on 18.10.2026.
+//
+
+// Метрики кэша вершин для готового .vmesh: ACMR/ATVR для нескольких размеров FIFO, как есть
+// и после оптимизации порядка (в памяти, файл не меняется). Так видно, сколько вызовов вершинного
+// шейдера уходит впустую у файлов, записанных без оптимизации (meshconv --no-optimize или чужие)
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+
+namespace {
+
+void printUsage(const char* programName)
+{
+    std::cout << "Usage: " << programName << " mesh.vmesh\n"
+              << "  prints ACMR (vertex shader runs per triangle) and ATVR (runs per vertex) for FIFO caches\n"
+              << "  of 8, 16 and 32 vertices, for the file as stored and after optimizeVertexCache()\n";
+}
+
+void printStats(const char* label, const std::vector<uint32_t>& indices, size_t vertexCount)
+{
+    std::cout << label << ":";
+    for (uint32_t cacheSize : {8u, 16u, 32u})
+    {
+        VertexCacheStats stats = analyzeVertexCache(indices.data(), indices.size(), vertexCount, cacheSize);
+        std::cout << "  FIFO " << cacheSize << ": ACMR " << stats.acmr << ", ATVR " << stats.atvr;
+    }
+    std::cout << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc != 2 || std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h")
+        {
+            printUsage(argv[0]);
+            return argc == 2 ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        MeshFile mesh(argv[1]);
+        const VMeshHeader& header = mesh.header();
+
+        std::vector<uint32_t> indices(header.indexCount);
+        if (header.indexSize == 2)
+        {
+            const auto* source = static_cast<const uint16_t*>(mesh.indexData());
+            indices.assign(source, source + header.indexCount);
+        }
+        else
+        {
+            const auto* source = static_cast<const uint32_t*>(mesh.indexData());
+            indices.assign(source, source + header.indexCount);
+        }
+
+        std::cout << argv[1] << ": " << header.vertexCount << " vertices, " << header.indexCount / 3 << " triangles, "
+                  << header.indexSize * 8 << "-bit indices" << std::endl;
+        printStats("stored", indices, header.vertexCount);
+
+        optimizeVertexCache(indices.data(), indices.size(), header.vertexCount);
+        printStats("optimized", indices, header.vertexCount);
+    }
+    catch (const std::exception& exp)
+    {
+        std::cerr << exp.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}